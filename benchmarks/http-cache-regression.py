@@ -0,0 +1,205 @@
+#!/usr/bin/env python3
+"""Scenario and component benchmark harness for the http-cache module.
+
+Runs a fixed set of scenario configurations plus the component
+micro-benchmarks (http-cache-microbench), and records wall time, events/s,
+peak RSS and the micro-benchmark ns/op figures. The results are compared with
+a baseline JSON file, and any metric that got worse by more than the threshold
+is reported.
+
+    # record a baseline on this machine
+    benchmarks/http-cache-regression.py --ns3 ~/ns-3-dev --update
+    # later: compare against it (exit status 1 on regression)
+    benchmarks/http-cache-regression.py --ns3 ~/ns-3-dev
+
+Baselines are only comparable on the same machine and build profile; the
+machine fingerprint stored in the baseline is checked and a mismatch is
+reported. Build ns-3 in the optimized profile first
+(./ns3 configure --build-profile=optimized --enable-examples).
+"""
+
+import argparse
+import json
+import os
+import platform
+import re
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+# name -> (program, arguments). Keep these fixed: changing one invalidates its baseline.
+SCENARIOS = {
+    "scenario-1k": ("http-cache-scenario",
+                    "--numClients=1000 --nReq=20 --numContent=50 --zipf=true --stopTime=30"),
+    "streaming-500": ("http-cache-video-streaming",
+                      "--numClients=500 --numServices=20 --numSegments=50 --zipf=true --totalTime=60"),
+    "sessions-500": ("http-cache-video-streaming",
+                     "--workload=sessions --numClients=500 --numServices=50 --numLiveServices=5 "
+                     "--zipf=true --sessionRate=20 --totalTime=120"),
+    "policy-sim-100k": ("http-cache-policy-sim",
+                        "--numClients=100000 --numServices=50 --numSegments=300 --capacity=20000 "
+                        "--ttl=30 --totalTime=600"),
+}
+MICROBENCH = ("http-cache-microbench", "--ops=1000000 --repeat=5")
+
+# Metrics where a larger value is better; all others are better when smaller
+HIGHER_IS_BETTER = {"events_per_s", "requests_per_s"}
+# Output-derived values that should not change between runs of the same build
+FINGERPRINTS = {"events", "requests", "hits"}
+
+PATTERNS = {
+    # http-cache-scenario / http-cache-video-streaming
+    "events": (re.compile(r"^Events: (\d+) in ([\d.]+)s wall clock \((\d+) events/s", re.M), 1, int),
+    "run_wall_s": (re.compile(r"^Events: \d+ in ([\d.]+)s wall clock", re.M), 1, float),
+    "events_per_s": (re.compile(r"^Events: \d+ in [\d.]+s wall clock \((\d+) events/s", re.M), 1, float),
+    # http-cache-policy-sim
+    "requests": (re.compile(r"^\s+Requests: (\d+)", re.M), 1, int),
+    "hits": (re.compile(r"^\s+Hits: (\d+)", re.M), 1, int),
+    "run_wall_s_policy": (re.compile(r"^\s+Wall time: ([\d.]+)s \(([\d.]+) M requests/s\)", re.M), 1, float),
+    "requests_per_s": (re.compile(r"^\s+Wall time: [\d.]+s \(([\d.]+) M requests/s\)", re.M), 1,
+                       lambda v: float(v) * 1e6),
+}
+
+
+def machine_fingerprint():
+    cpu = platform.processor()
+    try:
+        with open("/proc/cpuinfo") as f:
+            for line in f:
+                if line.startswith("model name"):
+                    cpu = line.split(":", 1)[1].strip()
+                    break
+    except OSError:
+        pass
+    return {"host": platform.node(), "cpu": cpu, "cpus": os.cpu_count(), "kernel": platform.release()}
+
+
+def run(ns3_dir, program, args, cpu):
+    """Run one program through ./ns3; returns (stdout, wall seconds, peak RSS in MB)."""
+    cmd = [os.path.join(ns3_dir, "ns3"), "run", "--no-build", f"{program} {args}"]
+    if cpu is not None:
+        cmd = ["taskset", "-c", str(cpu)] + cmd
+    start = time.monotonic()
+    proc = subprocess.Popen(cmd, cwd=ns3_dir, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+    out = proc.stdout.read()
+    # wait4 gives this child's resource usage, including the simulation it waited for
+    _, status, usage = os.wait4(proc.pid, 0)
+    wall = time.monotonic() - start
+    proc.returncode = os.waitstatus_to_exitcode(status)
+    if proc.returncode != 0:
+        sys.exit(f"{program} failed with status {proc.returncode}:\n{out[-2000:]}")
+    return out, wall, usage.ru_maxrss / 1024.0
+
+
+def parse(output):
+    metrics = {}
+    for name, (pattern, group, conv) in PATTERNS.items():
+        m = pattern.search(output)
+        if m:
+            metrics[name.replace("_policy", "")] = conv(m.group(group))
+    return metrics
+
+
+def measure(ns3_dir, repeat, cpu, only):
+    results = {}
+    for name, (program, args) in SCENARIOS.items():
+        if only and name not in only:
+            continue
+        runs = []
+        for _ in range(repeat):
+            out, wall, rss = run(ns3_dir, program, args, cpu)
+            m = parse(out)
+            m["wall_s"] = wall
+            m["peak_rss_mb"] = rss
+            runs.append(m)
+        # Medians damp scheduling noise; fingerprints must agree across repeats anyway
+        results[name] = {k: statistics.median(r[k] for r in runs) for k in runs[0]}
+        print(f"{name:18s} " + "  ".join(f"{k}={v:.4g}" for k, v in sorted(results[name].items())))
+
+    if not only or "microbench" in only:
+        with tempfile.NamedTemporaryFile(suffix=".json", delete=False) as tmp:
+            path = tmp.name
+        try:
+            program, args = MICROBENCH
+            run(ns3_dir, program, f"{args} --json={path}", cpu)
+            with open(path) as f:
+                bench = json.load(f)["benchmarks"]
+        finally:
+            os.unlink(path)
+        results["microbench"] = {f"{k}_ns": v for k, v in bench.items()}
+        print(f"{'microbench':18s} " + "  ".join(f"{k}={v:.4g}" for k, v in sorted(results["microbench"].items())))
+    return results
+
+
+def compare(baseline, current, threshold):
+    regressions = []
+    for name, metrics in current.items():
+        base = baseline.get(name)
+        if base is None:
+            print(f"{name}: no baseline")
+            continue
+        for key, value in metrics.items():
+            if key not in base:
+                continue
+            ref = base[key]
+            if key in FINGERPRINTS:
+                if value != ref:
+                    print(f"{name}.{key}: {ref} -> {value} (output changed; results may not be comparable)")
+                continue
+            if ref == 0:
+                continue
+            change = (value - ref) / ref
+            worse = -change if key in HIGHER_IS_BETTER else change
+            flag = "REGRESSION" if worse > threshold else ("improved" if worse < -threshold else "")
+            print(f"{name}.{key}: {ref:.4g} -> {value:.4g} ({100 * change:+.1f}%) {flag}")
+            if flag == "REGRESSION":
+                regressions.append(f"{name}.{key}")
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--ns3", default=".", help="ns-3 source tree containing the ./ns3 script")
+    parser.add_argument("--baseline", default=os.path.join(os.path.dirname(__file__), "baseline.json"),
+                        help="baseline file (default: benchmarks/baseline.json)")
+    parser.add_argument("--update", action="store_true", help="write the measurements as the new baseline")
+    parser.add_argument("--threshold", type=float, default=0.10, help="relative change flagged as regression")
+    parser.add_argument("--repeat", type=int, default=3, help="runs per scenario (median is kept)")
+    parser.add_argument("--cpu", type=int, help="pin runs to this CPU with taskset")
+    parser.add_argument("--only", nargs="*", help="subset of scenarios (and/or 'microbench')")
+    opts = parser.parse_args()
+
+    current = measure(os.path.abspath(opts.ns3), max(1, opts.repeat), opts.cpu, opts.only)
+    machine = machine_fingerprint()
+
+    if opts.update:
+        doc = {"machine": machine, "threshold": opts.threshold, "results": current}
+        if os.path.exists(opts.baseline) and opts.only:
+            # Partial update: keep the other entries
+            with open(opts.baseline) as f:
+                old = json.load(f)
+            old["results"].update(current)
+            doc["results"] = old["results"]
+        with open(opts.baseline, "w") as f:
+            json.dump(doc, f, indent=2, sort_keys=True)
+        print(f"Baseline written to {opts.baseline}")
+        return 0
+
+    if not os.path.exists(opts.baseline):
+        sys.exit(f"No baseline at {opts.baseline}; run with --update first")
+    with open(opts.baseline) as f:
+        baseline = json.load(f)
+    if baseline.get("machine") != machine:
+        print(f"warning: baseline recorded on {baseline.get('machine')}, running on {machine}")
+    regressions = compare(baseline["results"], current, opts.threshold)
+    if regressions:
+        print(f"{len(regressions)} regression(s) beyond {100 * opts.threshold:.0f}%: {', '.join(regressions)}")
+        return 1
+    print("No regressions")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,172 @@
+// Component micro-benchmarks: times the per-request hot paths of the module
+// (header serialization, cache lookup/insert/evict, service extraction, Zipf
+// sampling and dynamic-TTL evaluation) in isolation and reports the median
+// nanoseconds per operation over several repetitions. With --json the results
+// are written in the format read by benchmarks/http-cache-regression.py.
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/http-cache-engine.h"
+#include "ns3/http-header.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace ns3;
+
+namespace {
+
+volatile uint64_t g_sink = 0; // keeps results observable so loops are not optimized away
+uint32_t g_repeat = 5;
+
+/// Median ns per operation of \p body(ops) over g_repeat runs
+double NsPerOp(uint64_t ops, const std::function<void(uint64_t)>& body) {
+  std::vector<double> samples;
+  for (uint32_t r = 0; r < g_repeat; ++r) {
+    auto start = std::chrono::steady_clock::now();
+    body(ops);
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    samples.push_back(ns / ops);
+  }
+  std::sort(samples.begin(), samples.end());
+  return samples[samples.size() / 2];
+}
+
+std::string SegmentKey(uint32_t service, uint32_t segment) {
+  return "/service-" + std::to_string(service) + "/seg-" + std::to_string(segment);
+}
+
+std::vector<double> BuildZipfCdf(uint32_t n, double s) {
+  std::vector<double> cdf(n);
+  double sum = 0.0;
+  for (uint32_t k = 1; k <= n; ++k) sum += 1.0 / std::pow((double)k, s);
+  double run = 0.0;
+  for (uint32_t k = 1; k <= n; ++k) {
+    run += (1.0 / std::pow((double)k, s)) / sum;
+    cdf[k - 1] = run;
+  }
+  return cdf;
+}
+
+} // namespace
+
+int main(int argc, char** argv){
+  uint64_t ops = 1000000;
+  uint32_t capacity = 100000;
+  uint32_t catalog = 10000;
+  double zipfS = 1.0;
+  uint32_t services = 50;
+  uint32_t seed = 1;
+  std::string json = "";
+
+  CommandLine cmd;
+  cmd.AddValue("ops", "Operations per repetition", ops);
+  cmd.AddValue("repeat", "Repetitions per benchmark (the median is reported)", g_repeat);
+  cmd.AddValue("capacity", "Cache capacity in objects for the engine benchmarks", capacity);
+  cmd.AddValue("catalog", "Catalog size for the Zipf sampling benchmarks", catalog);
+  cmd.AddValue("zipfS", "Zipf exponent", zipfS);
+  cmd.AddValue("services", "Services for the dynamic-TTL benchmark", services);
+  cmd.AddValue("seed", "Random seed", seed);
+  cmd.AddValue("json", "Write results to this JSON file", json);
+  cmd.Parse(argc, argv);
+  g_repeat = std::max(1u, g_repeat);
+  capacity = std::max(1u, capacity);
+
+  std::mt19937_64 rng(seed);
+  std::vector<std::pair<std::string, double>> results;
+  auto report = [&results](const std::string& name, double ns) {
+    results.emplace_back(name, ns);
+    std::cout << std::setw(28) << std::left << name << std::right << std::setw(12) << std::fixed
+              << std::setprecision(1) << ns << " ns/op" << std::endl;
+  };
+
+  // Keys shaped like the streaming workload's, built once outside the timed loops
+  std::vector<std::string> keys(2 * static_cast<size_t>(capacity));
+  for (size_t i = 0; i < keys.size(); ++i) keys[i] = SegmentKey(1 + i % services, 1 + i / services);
+
+  report("header_add_remove", NsPerOp(ops, [&](uint64_t n) {
+    for (uint64_t i = 0; i < n; ++i) {
+      Ptr<Packet> p = Create<Packet>(0);
+      p->AddHeader(HttpHeader(static_cast<uint32_t>(i), keys[i % keys.size()], 1024));
+      HttpHeader hdr;
+      p->RemoveHeader(hdr);
+      g_sink += hdr.GetRequestId();
+    }
+  }));
+
+  report("extract_service", NsPerOp(ops, [&](uint64_t n) {
+    for (uint64_t i = 0; i < n; ++i) g_sink += HttpCacheEngine::ExtractService(keys[i % keys.size()]).size();
+  }));
+
+  {
+    HttpCacheEngine engine;
+    engine.SetCapacity(capacity);
+    engine.SetTtl(Seconds(1e6));
+    for (uint32_t i = 0; i < capacity; ++i) engine.Insert(keys[i], 1024, Seconds(0));
+    report("engine_access_hit", NsPerOp(ops, [&](uint64_t n) {
+      for (uint64_t i = 0; i < n; ++i) g_sink += engine.Access(keys[(i * 7919) % capacity], Seconds(1));
+    }));
+    report("engine_access_miss", NsPerOp(ops, [&](uint64_t n) {
+      for (uint64_t i = 0; i < n; ++i) g_sink += engine.Access(keys[capacity + i % capacity], Seconds(1));
+    }));
+    // Alternate between the two key halves so every insert evicts the LRU entry
+    uint64_t next = capacity;
+    report("engine_insert_evict", NsPerOp(ops, [&](uint64_t n) {
+      for (uint64_t i = 0; i < n; ++i, ++next) engine.Insert(keys[next % keys.size()], 1024, Seconds(1));
+    }));
+  }
+
+  std::vector<double> cdf = BuildZipfCdf(catalog, zipfS);
+  std::uniform_real_distribution<double> uni(0.0, 1.0);
+  // Linear CDF scan, as in HttpClientApp::PickResource()
+  report("zipf_sample_linear", NsPerOp(ops, [&](uint64_t n) {
+    for (uint64_t i = 0; i < n; ++i) {
+      double r = uni(rng);
+      uint32_t idx = 0;
+      for (uint32_t k = 0; k < cdf.size(); ++k) { if (cdf[k] >= r) { idx = k; break; } }
+      g_sink += idx;
+    }
+  }));
+  // Binary search, as in HttpVideoWorkload
+  report("zipf_sample_bsearch", NsPerOp(ops, [&](uint64_t n) {
+    for (uint64_t i = 0; i < n; ++i) {
+      g_sink += std::lower_bound(cdf.begin(), cdf.end(), uni(rng)) - cdf.begin();
+    }
+  }));
+
+  {
+    // One simulated minute of requests spread over the TTL window, then repeated evaluations
+    HttpCacheEngine engine;
+    engine.SetCapacity(capacity);
+    engine.SetDynamicTtlEnabled(true);
+    engine.SetTtlWindow(Seconds(60));
+    for (uint64_t i = 0; i < ops; ++i) {
+      engine.Access(keys[i % keys.size()], Seconds(60.0 * i / ops));
+    }
+    uint64_t evals = std::max<uint64_t>(1, ops / 1000);
+    report("dynamic_ttl_evaluate", NsPerOp(evals, [&](uint64_t n) {
+      for (uint64_t i = 0; i < n; ++i) engine.EvaluatePolicy(Seconds(60));
+    }));
+    report("engine_access_dynamic_ttl", NsPerOp(ops, [&](uint64_t n) {
+      for (uint64_t i = 0; i < n; ++i) g_sink += engine.Access(keys[(i * 7919) % keys.size()], Seconds(60));
+    }));
+  }
+
+  if (!json.empty()) {
+    std::ofstream out(json);
+    out << "{\n  \"unit\": \"ns/op\",\n  \"benchmarks\": {\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+      out << "    \"" << results[i].first << "\": " << std::setprecision(2) << results[i].second
+          << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  }\n}\n";
+  }
+  return 0;
+}
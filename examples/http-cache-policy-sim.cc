@@ -0,0 +1,394 @@
+// Standalone cache-policy simulator: drives HttpCacheEngine directly from a
+// workload loop, without nodes, sockets or packets. Use it for capacity, TTL
+// and eviction questions that do not depend on the network; hit/miss decisions
+// are made by the same engine HttpCacheApp uses.
+
+#include "ns3/core-module.h"
+#include "ns3/http-admission-filter.h"
+#include "ns3/http-cache-engine.h"
+#include "ns3/http-trace-reader.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <queue>
+#include <random>
+#include <string>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+using namespace ns3;
+
+namespace {
+
+struct ClientState {
+  uint32_t service = 0;     ///< current service (1-based) in streaming mode
+  uint32_t nextSegment = 1;
+  bool inSequence = false;
+};
+
+/// (time in ns, client index); smallest time first
+using Arrival = std::pair<int64_t, uint32_t>;
+/// (fill time in ns, key, size) for misses whose origin response is still in flight
+using Fill = std::tuple<int64_t, std::string, uint32_t>;
+
+std::vector<double> BuildZipfCdf(uint32_t n, double s) {
+  std::vector<double> cdf(n);
+  double sum = 0.0;
+  for (uint32_t k = 1; k <= n; ++k) sum += 1.0 / std::pow((double)k, s);
+  double run = 0.0;
+  for (uint32_t k = 1; k <= n; ++k) {
+    run += (1.0 / std::pow((double)k, s)) / sum;
+    cdf[k - 1] = run;
+  }
+  return cdf;
+}
+
+} // namespace
+
+int main(int argc, char** argv){
+  uint32_t numClients = 1000;
+  double totalTime = 100.0;
+  std::string mode = "streaming"; // streaming | content
+  uint32_t numServices = 10;
+  uint32_t numSegments = 100;
+  double segmentInterval = 1.0;
+  uint32_t numContent = 1000;
+  double interval = 0.5;
+  bool zipf = true; double zipfS = 1.0;
+  std::string trace = "";
+  uint32_t capacity = 1000;
+  double ttl = 5.0;
+  double fillDelay = 0.0; // ms
+  uint32_t objectSize = 1024;
+  bool dynamicTtl = false;
+  double ttlWindow = 300.0;
+  double ttlThreshold = 0.5;
+  double ttlReduction = 0.5;
+  double ttlEvalInterval = 30.0;
+  bool tiered = false;
+  double ramMB = 64.0;
+  double ssdGB = 1.0;
+  double ramLatencyUs = 1.0;
+  double ssdLatencyUs = 100.0;
+  double ramBwGBps = 10.0;
+  double ssdBwMBps = 2000.0;
+  uint32_t promoteHits = 1;
+  bool demote = true;
+  bool ssdInsert = false;
+  double ssdOverProvision = 0.28;
+  std::string admission = "none";
+  uint32_t admissionItems = 0;
+  std::string partition = "none";
+  std::string partitionShares = "";
+  uint32_t partitionStep = 0;
+  bool serviceStats = false;
+  std::string partitionCsv = "";
+  bool mrc = false;
+  double mrcRate = 0.01;
+  uint32_t mrcMaxKeys = 8192;
+  uint32_t mrcMaxObjects = 0;
+  uint32_t mrcPoints = 20;
+  std::string mrcCsv = "";
+  uint32_t seed = 1;
+  std::string snapshotSave = "";
+  std::string snapshotLoad = "";
+  std::string csv = "";
+
+  CommandLine cmd;
+  cmd.AddValue("numClients", "Number of synthetic clients", numClients);
+  cmd.AddValue("totalTime", "Simulated workload duration (seconds)", totalTime);
+  cmd.AddValue("mode", "Synthetic workload: streaming or content", mode);
+  cmd.AddValue("numServices", "Streaming services (Zipf pick among these)", numServices);
+  cmd.AddValue("numSegments", "Sequential segments per service selection", numSegments);
+  cmd.AddValue("segmentInterval", "Seconds between sequential segments", segmentInterval);
+  cmd.AddValue("numContent", "Distinct content items in content mode", numContent);
+  cmd.AddValue("interval", "Seconds between requests in content mode", interval);
+  cmd.AddValue("zipf", "Use Zipf popularity", zipf);
+  cmd.AddValue("zipfS", "Zipf exponent s (>0)", zipfS);
+  cmd.AddValue("trace", "Replay an access log instead of a synthetic workload", trace);
+  cmd.AddValue("capacity", "Cache capacity (objects)", capacity);
+  cmd.AddValue("ttl", "TTL seconds", ttl);
+  cmd.AddValue("fillDelay", "Miss-to-fill delay (ms); requests in between coalesce as misses", fillDelay);
+  cmd.AddValue("objectSize", "Object size in bytes for synthetic workloads", objectSize);
+  cmd.AddValue("dynamicTtl", "Enable dynamic TTL policy", dynamicTtl);
+  cmd.AddValue("ttlWindow", "Dynamic TTL sliding window (seconds)", ttlWindow);
+  cmd.AddValue("ttlThreshold", "Request share threshold for TTL reduction (0.0-1.0)", ttlThreshold);
+  cmd.AddValue("ttlReduction", "TTL reduction factor when penalized (0.0-1.0)", ttlReduction);
+  cmd.AddValue("ttlEvalInterval", "Policy evaluation interval (seconds)", ttlEvalInterval);
+  cmd.AddValue("tiered", "Use byte-bounded RAM + SSD tiers instead of the object-count LRU", tiered);
+  cmd.AddValue("ramMB", "RAM tier capacity (MB)", ramMB);
+  cmd.AddValue("ssdGB", "SSD tier capacity (GB)", ssdGB);
+  cmd.AddValue("ramLatencyUs", "RAM tier access latency (us)", ramLatencyUs);
+  cmd.AddValue("ssdLatencyUs", "SSD tier access latency (us)", ssdLatencyUs);
+  cmd.AddValue("ramBwGBps", "RAM tier bandwidth (GB/s)", ramBwGBps);
+  cmd.AddValue("ssdBwMBps", "SSD tier bandwidth (MB/s), shared by reads and writes", ssdBwMBps);
+  cmd.AddValue("promoteHits", "Promote SSD objects to RAM on their Nth SSD hit (0 = never)", promoteHits);
+  cmd.AddValue("demote", "Demote RAM victims to SSD instead of dropping them", demote);
+  cmd.AddValue("ssdInsert", "Insert new objects into SSD instead of RAM", ssdInsert);
+  cmd.AddValue("ssdOverProvision", "SSD spare-area fraction for write-amplification accounting", ssdOverProvision);
+  cmd.AddValue("admission", "Admission filter: none, second-hit or frequency", admission);
+  cmd.AddValue("admissionItems", "Distinct keys the admission sketch is sized for (0 = cache capacity in objects)", admissionItems);
+  cmd.AddValue("partition", "Split cache capacity by service: none, static, weighted or dynamic", partition);
+  cmd.AddValue("partitionShares", "service:value,... quotas in objects (static) or weights (weighted)", partitionShares);
+  cmd.AddValue("partitionStep", "Objects of quota moved per ghost hit (dynamic, 0 = capacity / 1000)", partitionStep);
+  cmd.AddValue("serviceStats", "Report per-service occupancy and hit ratio even without partitioning", serviceStats);
+  cmd.AddValue("partitionCsv", "Write per-service cache statistics to this CSV (optional)", partitionCsv);
+  cmd.AddValue("mrc", "Estimate the LRU hit-ratio-vs-capacity curve during the run (SHARDS)", mrc);
+  cmd.AddValue("mrcRate", "Initial MRC key sampling rate (0-1]", mrcRate);
+  cmd.AddValue("mrcMaxKeys", "Maximum keys tracked by the MRC estimator", mrcMaxKeys);
+  cmd.AddValue("mrcMaxObjects", "Largest capacity on the curve, in objects (0 = 4x cache capacity)", mrcMaxObjects);
+  cmd.AddValue("mrcPoints", "Number of capacities on the curve", mrcPoints);
+  cmd.AddValue("mrcCsv", "Write the curve to this CSV (optional)", mrcCsv);
+  cmd.AddValue("snapshotSave", "Save the cache contents to this binary snapshot at the end of the run", snapshotSave);
+  cmd.AddValue("snapshotLoad", "Warm-start the cache from this snapshot", snapshotLoad);
+  cmd.AddValue("seed", "Random seed for synthetic workloads", seed);
+  cmd.AddValue("csv", "Append a one-line result to this CSV (optional)", csv);
+  cmd.Parse(argc, argv);
+
+  HttpCacheEngine engine;
+  engine.SetTtl(Seconds(ttl));
+  engine.SetCapacity(capacity);
+  engine.SetDynamicTtlEnabled(dynamicTtl);
+  engine.SetTtlWindow(Seconds(ttlWindow));
+  engine.SetTtlThreshold(ttlThreshold);
+  engine.SetTtlReduction(ttlReduction);
+  engine.SetTtlEvalInterval(Seconds(ttlEvalInterval));
+  if (tiered) {
+    engine.SetTieredEnabled(true);
+    engine.SetTierModel(HttpCacheEngine::RAM, static_cast<uint64_t>(ramMB * 1024 * 1024),
+                        NanoSeconds(static_cast<int64_t>(ramLatencyUs * 1000)), ramBwGBps * 1e9);
+    engine.SetTierModel(HttpCacheEngine::SSD, static_cast<uint64_t>(ssdGB * 1024 * 1024 * 1024),
+                        NanoSeconds(static_cast<int64_t>(ssdLatencyUs * 1000)), ssdBwMBps * 1e6);
+    engine.SetPromotionHits(promoteHits);
+    engine.SetDemotionEnabled(demote);
+    engine.SetInsertTier(ssdInsert ? HttpCacheEngine::SSD : HttpCacheEngine::RAM);
+    engine.SetSsdOverProvisioning(ssdOverProvision);
+  }
+
+  HttpAdmissionFilter::Mode admissionMode;
+  if (!HttpAdmissionFilter::ParseMode(admission, &admissionMode)) {
+    std::cerr << "Unknown admission mode " << admission << std::endl;
+    return 1;
+  }
+  uint64_t cachedObjects = tiered ? static_cast<uint64_t>((ramMB * 1024 * 1024 + ssdGB * 1024 * 1024 * 1024) / objectSize)
+                                  : capacity;
+  engine.SetAdmission(admissionMode, admissionItems > 0 ? admissionItems : cachedObjects);
+
+  uint64_t mrcRange = mrcMaxObjects > 0 ? mrcMaxObjects : 4 * std::max<uint64_t>(1, cachedObjects);
+  if (mrc) engine.SetMrcEstimation(mrcRate, mrcMaxKeys, static_cast<uint32_t>(std::max<uint64_t>(1, mrcRange / 1000)));
+
+  HttpCacheEngine::PartitionMode partitionMode;
+  if (!HttpCacheEngine::ParsePartitionMode(partition, &partitionMode)) {
+    std::cerr << "Unknown partition mode " << partition << std::endl;
+    return 1;
+  }
+  if (partitionMode != HttpCacheEngine::SHARED && tiered) {
+    std::cerr << "--partition applies to the object-count LRU and cannot be combined with --tiered" << std::endl;
+    return 1;
+  }
+  engine.SetPartitioning(partitionMode, partitionStep);
+  engine.SetServiceStatsEnabled(serviceStats || !partitionCsv.empty());
+  if (!engine.SetPartitionShares(partitionShares)) {
+    std::cerr << "Malformed --partitionShares " << partitionShares << std::endl;
+    return 1;
+  }
+
+  if (!snapshotLoad.empty()) {
+    int64_t loaded = engine.LoadSnapshot(snapshotLoad, Seconds(0));
+    if (loaded < 0) {
+      std::cerr << "Cannot load snapshot " << snapshotLoad << std::endl;
+      return 1;
+    }
+    std::cout << "Warm start: " << loaded << " entries from " << snapshotLoad << std::endl;
+  }
+
+  const int64_t fillNs = static_cast<int64_t>(fillDelay * 1e6);
+  const int64_t evalNs = Seconds(ttlEvalInterval).GetNanoSeconds();
+  int64_t nextEval = evalNs;
+  std::priority_queue<Fill, std::vector<Fill>, std::greater<Fill>> fills;
+  std::unordered_set<std::string> inFlight;
+  uint64_t coalesced = 0;
+
+  // Process one request at time t (ns)
+  auto handle = [&](int64_t t, const std::string& key, uint32_t size) {
+    while (!fills.empty() && std::get<0>(fills.top()) <= t) {
+      const Fill& f = fills.top();
+      engine.Insert(std::get<1>(f), std::get<2>(f), NanoSeconds(std::get<0>(f)));
+      inFlight.erase(std::get<1>(f));
+      fills.pop();
+    }
+    if (dynamicTtl) {
+      while (nextEval <= t) { engine.EvaluatePolicy(NanoSeconds(nextEval)); nextEval += evalNs; }
+    }
+    Time now = NanoSeconds(t);
+    uint32_t hitSize = 0;
+    HttpCacheEngine::Tier tier;
+    if (engine.Access(key, now, &hitSize, &tier) == HttpCacheEngine::HIT) {
+      if (tiered) engine.ReadTime(tier, hitSize, now);
+      return;
+    }
+    if (fillNs == 0) {
+      engine.Insert(key, size, now);
+    } else if (inFlight.insert(key).second) {
+      fills.emplace(t + fillNs, key, size);
+    } else {
+      coalesced++;
+    }
+  };
+
+  auto wallStart = std::chrono::steady_clock::now();
+
+  if (!trace.empty()) {
+    HttpTraceReader reader;
+    if (!reader.Open(trace)) {
+      std::cerr << "Cannot open trace " << trace << std::endl;
+      return 1;
+    }
+    HttpTraceRecord rec;
+    bool first = true; double t0 = 0.0;
+    while (reader.Next(rec)) {
+      if (first) { t0 = rec.timestamp; first = false; }
+      double offset = rec.timestamp - t0;
+      if (offset > totalTime) break;
+      handle(static_cast<int64_t>(offset * 1e9), rec.resource, rec.size > 0 ? rec.size : objectSize);
+    }
+  } else {
+    bool streaming = (mode == "streaming");
+    uint32_t population = streaming ? std::max(1u, numServices) : std::max(1u, numContent);
+    std::vector<double> cdf;
+    if (zipf && population > 1) cdf = BuildZipfCdf(population, zipfS);
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+    auto pick = [&]() -> uint32_t {
+      if (!cdf.empty()) {
+        return static_cast<uint32_t>(std::lower_bound(cdf.begin(), cdf.end(), uni(rng)) - cdf.begin());
+      }
+      return static_cast<uint32_t>(uni(rng) * population) % population;
+    };
+
+    const int64_t step = Seconds(streaming ? segmentInterval : interval).GetNanoSeconds();
+    const int64_t end = Seconds(totalTime).GetNanoSeconds();
+    std::vector<ClientState> clients(numClients);
+    std::priority_queue<Arrival, std::vector<Arrival>, std::greater<Arrival>> arrivals;
+    for (uint32_t i = 0; i < numClients; ++i) arrivals.emplace(step, i);
+
+    // Pre-build resource names so the loop does not format strings per request
+    auto makeKey = [&](uint32_t item, uint32_t segment) {
+      return streaming ? "/service-" + std::to_string(item + 1) + "/seg-" + std::to_string(segment)
+                       : "/file-" + std::to_string(item + 1);
+    };
+    const uint32_t segs = streaming ? std::max(1u, numSegments) : 1;
+    const bool prebuilt = static_cast<uint64_t>(population) * segs <= (1u << 22);
+    std::vector<std::string> keys;
+    if (prebuilt) {
+      keys.reserve(static_cast<size_t>(population) * segs);
+      for (uint32_t i = 0; i < population; ++i) {
+        for (uint32_t g = 1; g <= segs; ++g) keys.push_back(makeKey(i, g));
+      }
+    }
+
+    std::string key;
+    while (!arrivals.empty() && arrivals.top().first <= end) {
+      Arrival a = arrivals.top();
+      arrivals.pop();
+      ClientState& c = clients[a.second];
+      uint32_t item = 0, segment = 1;
+      if (streaming) {
+        if (!c.inSequence) {
+          c.service = pick() + 1;
+          c.nextSegment = 1;
+          c.inSequence = true;
+        }
+        item = c.service - 1;
+        segment = c.nextSegment;
+        if (++c.nextSegment > segs) c.inSequence = false;
+      } else {
+        item = pick();
+      }
+      if (prebuilt) {
+        handle(a.first, keys[static_cast<size_t>(item) * segs + segment - 1], objectSize);
+      } else {
+        key = makeKey(item, segment);
+        handle(a.first, key, objectSize);
+      }
+      arrivals.emplace(a.first + step, a.second);
+    }
+  }
+
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  if (!snapshotSave.empty() && !engine.SaveSnapshot(snapshotSave, Seconds(totalTime))) {
+    std::cerr << "Cannot write snapshot " << snapshotSave << std::endl;
+  }
+  uint64_t reqs = engine.GetTotalRequests();
+  uint64_t hits = engine.GetTotalHits();
+  double hitRate = reqs > 0 ? 100.0 * hits / reqs : 0.0;
+  double rate = wall > 0 ? reqs / wall : 0.0;
+
+  std::cout << "Policy simulation completed" << std::endl;
+  std::cout << "  Requests: " << reqs << std::endl;
+  std::cout << "  Hits: " << hits << " (" << std::fixed << std::setprecision(2) << hitRate << "%)" << std::endl;
+  std::cout << "  Coalesced misses: " << coalesced << std::endl;
+  std::cout << "  Evictions: " << engine.GetEvictions() << std::endl;
+  std::cout << "  Wall time: " << std::setprecision(3) << wall << "s ("
+            << std::setprecision(2) << rate / 1e6 << " M requests/s)" << std::endl;
+  if (engine.GetAdmissionFilter().GetMode() != HttpAdmissionFilter::NONE) {
+    std::cout << "  Admission (" << admission << "): " << engine.GetAdmissionRejects() << " fills rejected, sketch "
+              << engine.GetAdmissionFilter().GetMemoryBytes() / 1024 << " KiB, "
+              << engine.GetAdmissionFilter().GetAgings() << " agings" << std::endl;
+  }
+  if (engine.IsTieredEnabled()) {
+    const char* names[] = {"RAM", "SSD"};
+    for (auto t : {HttpCacheEngine::RAM, HttpCacheEngine::SSD}) {
+      const auto& ts = engine.GetTierStats(t);
+      std::cout << "  " << names[t] << " tier: " << ts.hits << " hits ("
+                << std::fixed << std::setprecision(2) << (reqs > 0 ? 100.0 * ts.hits / reqs : 0.0)
+                << "% of requests), mean read " << std::setprecision(1)
+                << (ts.hits > 0 ? 1e6 * ts.readSeconds / ts.hits : 0.0) << " us, "
+                << ts.objects << " objects / " << ts.bytesUsed / (1024 * 1024) << " MB, "
+                << ts.evictions << " evictions" << std::endl;
+    }
+    const auto& fs = engine.GetFlashStats();
+    std::cout << "  Promotions: " << fs.promotions << ", demotions: " << fs.demotions << std::endl;
+    std::cout << "  Flash writes: " << fs.logicalBytesWritten / (1024 * 1024) << " MB logical, "
+              << fs.physicalBytesWritten / (1024 * 1024) << " MB physical (WA "
+              << std::setprecision(2) << engine.GetWriteAmplification() << ")" << std::endl;
+  }
+
+  if (partitionMode != HttpCacheEngine::SHARED || serviceStats || !partitionCsv.empty()) {
+    engine.PrintServiceStats(std::cout, "  ");
+    if (!partitionCsv.empty()) {
+      std::ofstream out(partitionCsv);
+      engine.WriteServiceStats(out);
+    }
+  }
+
+  if (mrc) {
+    const HttpMrcEstimator& est = engine.GetMrcEstimator();
+    std::cout << "  MRC: " << est.GetSampledReferences() << " sampled references at rate "
+              << std::setprecision(4) << est.GetSamplingRate() << ", " << est.GetTrackedKeys() << " keys, "
+              << est.GetMemoryBytes() / 1024 << " KiB" << std::endl;
+    std::cout << "  Estimated LRU hit ratio by capacity (objects):" << std::endl;
+    for (const auto& pt : est.GetCurve(mrcRange, mrcPoints)) {
+      std::cout << "    " << std::setw(10) << pt.first << "  " << std::setprecision(2) << 100.0 * pt.second << "%" << std::endl;
+    }
+    if (!mrcCsv.empty()) {
+      std::ofstream out(mrcCsv);
+      out << "capacity_objects,capacity_bytes,hit_ratio\n";
+      for (const auto& pt : est.GetCurve(mrcRange, mrcPoints)) {
+        out << pt.first << "," << pt.first * objectSize << "," << pt.second << "\n";
+      }
+    }
+  }
+
+  if (!csv.empty()) {
+    bool header = !std::ifstream(csv).good();
+    std::ofstream out(csv, std::ios::app);
+    if (header) out << "capacity,ttl_s,dynamic_ttl,admission,requests,hits,hit_rate_percent,evictions,wall_s\n";
+    out << capacity << "," << ttl << "," << (dynamicTtl ? 1 : 0) << "," << admission << "," << reqs << "," << hits << ","
+        << hitRate << "," << engine.GetEvictions() << "," << wall << "\n";
+  }
+  return 0;
+}
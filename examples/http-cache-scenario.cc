@@ -4,8 +4,14 @@
 #include "ns3/point-to-point-module.h"
 #include "ns3/applications-module.h"
 #include "ns3/http-client-app.h"
+#include "ns3/http-convergence-monitor.h"
 #include "ns3/http-cache-app.h"
 #include "ns3/http-origin-app.h"
+#include "ns3/http-progress-monitor.h"
+#include "ns3/http-trace-replayer.h"
+#include "ns3/timing-wheel-scheduler.h"
+#include <chrono>
+#include <iomanip>
 #include <sstream>
 #include <vector>
 
@@ -23,6 +29,42 @@ int main(int argc, char** argv){
   uint32_t objectSize = 1024;  // Default 1 KB
   uint32_t clientCacheBw = 1000000;  // Client-Cache link bandwidth (Mbps)
   uint32_t cacheOriginBw = 1000000;   // Cache-Origin link bandwidth (Mbps)
+  double stopTime = 100.0;
+  double progressInterval = 0.0; // percentage of stopTime, 0 = off
+  bool progressJson = false;
+  bool converge = false;
+  double convergePrecision = 0.02;
+  double convergeConfidence = 0.95;
+  double convergeInterval = 1.0;
+  uint32_t convergeBatches = 20;
+  std::string trace = "";
+  double traceSpeedup = 1.0;
+  std::string scheduler = "";
+  uint32_t originWorkers = 0;
+  uint32_t originQueueLimit = 0;
+  std::string originQueue = "fifo";
+  std::string originServiceModel = "fixed";
+  double originServiceCv = 1.0;
+  double originPerKiB = 0.0; // us
+  uint32_t cacheWorkers = 0;
+  uint32_t cacheQueueLimit = 0;
+  double cacheMissCostUs = 0.0;
+  double cachePerKiBUs = 0.0;
+  std::string cacheServiceModel = "fixed";
+  double cacheServiceCv = 1.0;
+  std::string cacheOverflow = "reject";
+  double batchWindowMs = 0.0;
+  uint32_t batchMaxKeys = 32;
+  std::string snapshotSave = "";
+  double snapshotAt = 0.0; // 0 = when the cache stops
+  std::string snapshotLoad = "";
+  double fastForward = 0.0; // seconds
+  double updateRate = 0.0;   // updates per object per second
+  std::string updateRates = "";
+  bool adaptiveTtl = false;
+  double staleTarget = 0.1;
+  double minTtl = 1.0;
+  double maxTtl = 3600.0;
   CommandLine cmd;
   cmd.AddValue("nReq", "Total client requests", nReq);
   cmd.AddValue("interval", "Seconds between requests", interval);
@@ -43,7 +85,49 @@ int main(int argc, char** argv){
   cmd.AddValue("objectSize", "Object size in bytes (default 1024)", objectSize);
   cmd.AddValue("clientCacheBw", "Client-Cache link bandwidth (Mbps)", clientCacheBw);
   cmd.AddValue("cacheOriginBw", "Cache-Origin link bandwidth (Mbps)", cacheOriginBw);
+  cmd.AddValue("stopTime", "Simulation stop time (seconds)", stopTime);
+  cmd.AddValue("progressInterval", "Progress update interval (percentage of stopTime, 0 = off)", progressInterval);
+  cmd.AddValue("progressJson", "Also print each progress report as a PROGRESS {json} line", progressJson);
+  cmd.AddValue("converge", "Stop once steady-state hit ratio and mean/p99 latency are estimated precisely", converge);
+  cmd.AddValue("convergePrecision", "Target confidence half-width relative to each estimate", convergePrecision);
+  cmd.AddValue("convergeConfidence", "Confidence level of the intervals", convergeConfidence);
+  cmd.AddValue("convergeInterval", "Observation interval for warm-up detection and batching (seconds)", convergeInterval);
+  cmd.AddValue("convergeBatches", "Number of batches for the batch-means intervals", convergeBatches);
+  cmd.AddValue("trace", "Replay an access log (timestamp,client_id,resource,size) instead of synthetic requests", trace);
+  cmd.AddValue("traceSpeedup", "Trace replay speed factor (2 = twice as fast)", traceSpeedup);
+  cmd.AddValue("originWorkers", "Origin worker slots (0 = unlimited parallelism)", originWorkers);
+  cmd.AddValue("originQueueLimit", "Origin queue length before shedding (0 = unbounded)", originQueueLimit);
+  cmd.AddValue("originQueue", "Origin queue discipline: fifo or sjf (smallest object first)", originQueue);
+  cmd.AddValue("originServiceModel", "Origin service time distribution: fixed, exp or lognormal", originServiceModel);
+  cmd.AddValue("originServiceCv", "Coefficient of variation for lognormal service times", originServiceCv);
+  cmd.AddValue("originPerKiB", "Additional origin service time per KiB of object (us)", originPerKiB);
+  cmd.AddValue("cacheWorkers", "Cache worker cores serving requests (0 = unlimited parallelism)", cacheWorkers);
+  cmd.AddValue("cacheQueueLimit", "Cache request queue length before overflow (0 = unbounded)", cacheQueueLimit);
+  cmd.AddValue("cacheMissCostUs", "Cache CPU time to process a miss (us); a hit costs cacheDelay", cacheMissCostUs);
+  cmd.AddValue("cachePerKiBUs", "Additional cache CPU time per KiB of object (us)", cachePerKiBUs);
+  cmd.AddValue("cacheServiceModel", "Cache CPU time distribution: fixed, exp or lognormal", cacheServiceModel);
+  cmd.AddValue("cacheServiceCv", "Coefficient of variation for lognormal cache CPU times", cacheServiceCv);
+  cmd.AddValue("cacheOverflow", "Requests beyond the cache queue limit: reject (UNAVAILABLE) or drop", cacheOverflow);
+  cmd.AddValue("batchWindowMs", "Batch cache misses to the origin within this window (ms, 0 = off)", batchWindowMs);
+  cmd.AddValue("batchMaxKeys", "Maximum keys per batched origin request", batchMaxKeys);
+  cmd.AddValue("snapshotSave", "Save the cache contents to this binary snapshot (optional)", snapshotSave);
+  cmd.AddValue("snapshotAt", "Simulation time of the snapshot save (seconds, 0 = when the cache stops)", snapshotAt);
+  cmd.AddValue("snapshotLoad", "Warm-start the cache from this snapshot (optional)", snapshotLoad);
+  cmd.AddValue("fastForward", "Warm the cache without packets for this many seconds, then simulate normally", fastForward);
+  cmd.AddValue("updateRate", "Mean origin updates per object per second (0 = immutable content)", updateRate);
+  cmd.AddValue("updateRates", "Per-service update rates overriding updateRate, e.g. service-1:0.1,service-2:0.001", updateRates);
+  cmd.AddValue("adaptiveTtl", "Learn a TTL per object from its observed update rate", adaptiveTtl);
+  cmd.AddValue("staleTarget", "Adaptive TTL: accepted probability that a copy is stale when it expires", staleTarget);
+  cmd.AddValue("minTtl", "Adaptive TTL lower bound (seconds)", minTtl);
+  cmd.AddValue("maxTtl", "Adaptive TTL upper bound (seconds)", maxTtl);
+  cmd.AddValue("scheduler", "Event scheduler: heap, map, list, calendar or wheel (default: simulator default)", scheduler);
   cmd.Parse(argc, argv);
+  // Wrapped so that progress reports can show the event-queue length with any scheduler
+  Ptr<EventQueueProbe> queueProbe = SetCountingScheduler(scheduler);
+  if (!queueProbe) {
+    std::cerr << "Unknown scheduler " << scheduler << std::endl;
+    return 1;
+  }
 
   // Create nodes: numClients client nodes + 1 cache node + 1 origin node
   NodeContainer clientNodes;
@@ -97,15 +181,40 @@ int main(int argc, char** argv){
 
   uint16_t clientToCachePort = 8080;
   uint16_t cacheToOriginPort = 8081;
+  uint16_t originBatchPort = 8082;
 
   // Setup origin server
   Ptr<HttpOriginApp> origin = CreateObject<HttpOriginApp>();
   origin->SetListenPort(cacheToOriginPort);
+  origin->SetBatchPort(originBatchPort);
   origin->SetServiceDelay(MilliSeconds(originDelay));
   origin->SetObjectSize(objectSize);
+  HttpServerQueue& originQ = origin->GetServerQueue();
+  HttpServerQueue::Discipline discipline;
+  HttpServerQueue::ServiceModel serviceModel;
+  if (!HttpServerQueue::ParseDiscipline(originQueue, &discipline)
+      || !HttpServerQueue::ParseServiceModel(originServiceModel, &serviceModel)) {
+    std::cerr << "Unknown originQueue or originServiceModel" << std::endl;
+    return 1;
+  }
+  originQ.SetWorkers(originWorkers);
+  originQ.SetQueueLimit(originQueueLimit);
+  originQ.SetDiscipline(discipline);
+  originQ.SetServiceModel(serviceModel, originServiceCv);
+  originQ.SetServiceTimePerKiB(MicroSeconds(static_cast<uint64_t>(originPerKiB)));
+  bool versioned = updateRate > 0 || !updateRates.empty();
+  if (updateRate > 0) origin->SetUpdateRate(updateRate);
+  if (!updateRates.empty() && !origin->SetServiceUpdateRates(updateRates)) {
+    std::cerr << "Malformed updateRates " << updateRates << std::endl;
+    return 1;
+  }
+  if (adaptiveTtl && (staleTarget <= 0 || staleTarget >= 1 || minTtl <= 0 || maxTtl < minTtl)) {
+    std::cerr << "adaptiveTtl requires 0 < staleTarget < 1 and 0 < minTtl <= maxTtl" << std::endl;
+    return 1;
+  }
   originNode->AddApplication(origin);
   origin->SetStartTime(Seconds(0.1));
-  origin->SetStopTime(Seconds(100));
+  origin->SetStopTime(Seconds(stopTime));
 
   // Calculate max objects from cache capacity: either user-specified objects or GB
   uint64_t capacityBytes = 0;
@@ -131,13 +240,31 @@ int main(int argc, char** argv){
   Ptr<HttpCacheApp> cache = CreateObject<HttpCacheApp>();
   cache->SetListenPort(clientToCachePort);
   cache->SetOrigin(Address(cacheOriginInterfaces.GetAddress(1)), cacheToOriginPort);
+  cache->SetOriginBatchPort(originBatchPort);
+  cache->SetBatching(MicroSeconds(static_cast<int64_t>(batchWindowMs * 1000)), batchMaxKeys);
   cache->SetTtl(Seconds(ttl));
   cache->SetCapacity(maxObjects);
   cache->SetCacheDelay(MilliSeconds(cacheDelay));
+  HttpServerQueue::ServiceModel cacheModel;
+  if (!HttpServerQueue::ParseServiceModel(cacheServiceModel, &cacheModel)
+      || (cacheOverflow != "reject" && cacheOverflow != "drop")) {
+    std::cerr << "Unknown cacheServiceModel or cacheOverflow" << std::endl;
+    return 1;
+  }
+  cache->SetMissCost(NanoSeconds(static_cast<int64_t>(cacheMissCostUs * 1000)));
+  cache->SetOverflowReject(cacheOverflow == "reject");
+  cache->GetCpu().SetWorkers(cacheWorkers);
+  cache->GetCpu().SetQueueLimit(cacheQueueLimit);
+  cache->GetCpu().SetServiceModel(cacheModel, cacheServiceCv);
+  cache->GetCpu().SetServiceTimePerKiB(NanoSeconds(static_cast<int64_t>(cachePerKiBUs * 1000)));
   cache->SetObjectSize(objectSize);
+  if (versioned) cache->SetVersionOracle(MakeCallback(&HttpOriginApp::PeekVersion, origin));
+  if (adaptiveTtl) cache->GetEngine().SetAdaptiveTtl(true, staleTarget, Seconds(minTtl), Seconds(maxTtl));
+  if (!snapshotLoad.empty()) cache->SetSnapshotLoad(snapshotLoad);
+  if (!snapshotSave.empty()) cache->SetSnapshotSave(snapshotSave, Seconds(snapshotAt > 0 ? snapshotAt : stopTime));
   cacheNode->AddApplication(cache);
   cache->SetStartTime(Seconds(0.2));
-  cache->SetStopTime(Seconds(100));
+  cache->SetStopTime(Seconds(stopTime));
 
   // Setup client applications
   std::vector<Ptr<HttpClientApp>> clientApps;  // Store for global summary
@@ -150,7 +277,7 @@ int main(int argc, char** argv){
     client->SetZipf(zipf);
     client->SetZipfS(zipfS);
     client->SetTotalRequests(nReq);
-    client->SetObjectSize(objectSize);
+    client->SetExternallyDriven(!trace.empty());
 
     // Set CSV paths with client index if multiple clients
     if (!csv.empty()) {
@@ -182,16 +309,133 @@ int main(int argc, char** argv){
 
     clientNodes.Get(i)->AddApplication(client);
     client->SetStartTime(Seconds(0.3));
-    client->SetStopTime(Seconds(99.9));
+    client->SetStopTime(Seconds(stopTime - 0.1));
 
     clientApps.push_back(client);  // Store for global summary
   }
 
+  // Trace replay: dispatch recorded requests to the clients once they are up
+  Ptr<HttpTraceReplayer> replayer;
+  if (!trace.empty()) {
+    replayer = CreateObject<HttpTraceReplayer>();
+    replayer->SetTracePath(trace);
+    replayer->SetSpeedup(traceSpeedup);
+    replayer->SetMaxDuration(Seconds(stopTime - 0.5));
+    for (const auto& client : clientApps) replayer->AddClient(client);
+    if (!replayer->Start(Seconds(0.4))) {
+      std::cerr << "Cannot replay trace " << trace << std::endl;
+      return 1;
+    }
+    std::cout << "Replaying trace " << trace << " (speedup " << traceSpeedup << "x)" << std::endl;
+  }
+
+  // Fast-forward warm-up: requests go straight into the cache as function calls until then
+  if (fastForward > 0) {
+    cache->SetFastForward(Seconds(fastForward));
+    for (const auto& client : clientApps) {
+      client->SetDirectPath(MakeCallback(&HttpCacheApp::ServeDirect, cache), Seconds(fastForward));
+    }
+    std::cout << "Fast-forward warm-up: first " << fastForward << "s without packets" << std::endl;
+  }
+
   std::cout << "Starting simulation with " << numClients << " client(s)..." << std::endl;
 
-  Simulator::Stop(Seconds(100));
+  Ptr<HttpConvergenceMonitor> convergence;
+  if (converge) {
+    convergence = CreateObject<HttpConvergenceMonitor>();
+    convergence->SetObservationInterval(Seconds(convergeInterval));
+    convergence->SetRelativePrecision(convergePrecision);
+    convergence->SetConfidence(convergeConfidence);
+    convergence->SetBatches(convergeBatches);
+    for (auto& c : clientApps) convergence->Attach(c);
+    convergence->Start(Seconds(std::max(0.3, fastForward)));
+  }
+
+  Ptr<HttpProgressMonitor> progress = CreateObject<HttpProgressMonitor>();
+  progress->SetCache(cache);
+  progress->SetQueueProbe(queueProbe);
+  progress->SetMachineReadable(progressJson);
+  progress->Start(Seconds((progressInterval / 100.0) * stopTime), Seconds(stopTime));
+
+  Simulator::Stop(Seconds(stopTime));
+  auto wallStart = std::chrono::steady_clock::now();
   Simulator::Run();
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
   std::cout << "Simulation completed successfully!" << std::endl;
+  if (convergence) convergence->PrintSummary(std::cout);
+  std::cout << "Events: " << Simulator::GetEventCount() << " in " << std::fixed << std::setprecision(2) << wall
+            << "s wall clock (" << std::setprecision(0) << (wall > 0 ? Simulator::GetEventCount() / wall : 0.0)
+            << " events/s" << (scheduler.empty() ? "" : ", " + scheduler + " scheduler") << ")" << std::endl;
+  {
+    const auto& os = origin->GetServerQueue().GetStats();
+    std::cout << "Origin: " << os.served << " served, " << os.shed << " shed, utilization "
+              << std::fixed << std::setprecision(1) << 100.0 * origin->GetServerQueue().GetUtilization()
+              << "%, mean queue " << std::setprecision(2) << origin->GetServerQueue().GetMeanQueueDepth()
+              << " (max " << os.maxQueueDepth << "), mean wait "
+              << std::setprecision(3) << (os.served > 0 ? 1000.0 * os.waitSeconds / os.served : 0.0) << " ms"
+              << std::endl;
+    uint64_t keys = cache->GetOriginKeys();
+    uint64_t requests = cache->GetOriginRequests();
+    std::cout << "Origin fetches: " << keys << " keys in " << requests << " requests ("
+              << std::setprecision(1) << (keys > 0 ? 100.0 * (1.0 - static_cast<double>(requests) / keys) : 0.0)
+              << "% fewer), mean batching delay " << std::setprecision(3) << 1000.0 * cache->GetMeanBatchDelay()
+              << " ms" << std::endl;
+    const HttpServerQueue& cpu = cache->GetCpu();
+    std::cout << "Cache CPU: " << cpu.GetStats().served << " served, " << cpu.GetStats().shed << " shed, "
+              << std::setprecision(1);
+    if (cpu.GetWorkers() > 0) {
+      std::cout << "utilization " << 100.0 * cpu.GetUtilization() << "% of " << cpu.GetWorkers() << " workers";
+    } else {
+      std::cout << "mean concurrency " << cpu.GetUtilization();
+    }
+    std::cout << ", mean queue " << std::setprecision(2) << cpu.GetMeanQueueDepth() << " (max "
+              << cpu.GetStats().maxQueueDepth << "), mean wait " << std::setprecision(3)
+              << (cpu.GetStats().served > 0 ? 1000.0 * cpu.GetStats().waitSeconds / cpu.GetStats().served : 0.0)
+              << " ms" << std::endl;
+  }
+  if (versioned) {
+    const HttpCacheApp::StalenessStats& st = cache->GetStalenessStats();
+    const HttpCacheEngine::FreshnessStats& fs = cache->GetEngine().GetFreshnessStats();
+    std::cout << "Freshness: " << origin->GetUpdates() << " origin updates, " << st.staleHits << " of "
+              << st.checkedHits << " hits stale (" << std::setprecision(2)
+              << (st.checkedHits > 0 ? 100.0 * st.staleHits / st.checkedHits : 0.0) << "%, "
+              << (st.staleHits > 0 ? static_cast<double>(st.versionsBehind) / st.staleHits : 0.0)
+              << " versions behind on average)" << std::endl;
+    std::cout << "Refetches: " << fs.refetches << ", " << fs.unchanged << " unchanged (" << std::setprecision(1)
+              << (fs.refetches > 0 ? 100.0 * fs.unchanged / fs.refetches : 0.0)
+              << "% could have been saved by a longer TTL)";
+    if (adaptiveTtl) {
+      std::cout << ", mean learned TTL " << std::setprecision(2)
+                << (fs.adaptiveTtls > 0 ? fs.adaptiveTtlSeconds / fs.adaptiveTtls : 0.0) << "s";
+    }
+    std::cout << std::endl;
+  }
+  if (!snapshotLoad.empty()) {
+    if (cache->GetSnapshotEntriesLoaded() < 0) {
+      std::cout << "Snapshot: could not load " << snapshotLoad << ", cache started cold" << std::endl;
+    } else {
+      std::cout << "Snapshot: warm start with " << cache->GetSnapshotEntriesLoaded() << " entries from "
+                << snapshotLoad << std::endl;
+    }
+  }
+  if (fastForward > 0) {
+    std::cout << "Fast-forward: " << cache->GetDirectRequests() << " requests served without packets before "
+              << fastForward << "s; statistics cover the rest of the run" << std::endl;
+  }
+  {
+    uint64_t lost = 0;
+    uint64_t late = 0;
+    for (const auto& client : clientApps) {
+      lost += client->GetLostRequests();
+      late += client->GetLateResponses();
+    }
+    std::cout << "Timeouts: " << lost << " client requests lost (" << late << " late responses), "
+              << cache->GetOriginTimeouts() << " origin fetches timed out" << std::endl;
+  }
+  if (replayer) {
+    std::cout << "Trace requests dispatched: " << replayer->GetDispatched()
+              << " (malformed lines: " << replayer->GetMalformedLines() << ")" << std::endl;
+  }
 
   // Write global summary CSV if requested
   if (!globalSummaryCsv.empty()) {
@@ -201,48 +445,13 @@ int main(int argc, char** argv){
     std::unordered_map<std::string, HttpClientApp::ContentStats> globalStats;
 
     for (const auto& client : clientApps) {
-      const auto& clientStats = client->GetContentStats();
-      for (const auto& pair : clientStats) {
-        const std::string& content = pair.first;
-        const HttpClientApp::ContentStats& stats = pair.second;
-
-        auto& global = globalStats[content];
-        global.totalRequests += stats.totalRequests;
-        global.cacheHits += stats.cacheHits;
-        global.cacheMisses += stats.cacheMisses;
-        global.totalLatency += stats.totalLatency;
-        global.totalHitLatency += stats.totalHitLatency;
-        global.totalMissLatency += stats.totalMissLatency;
-        global.minLatency = std::min(global.minLatency, stats.minLatency);
-        global.maxLatency = std::max(global.maxLatency, stats.maxLatency);
-      }
+      for (const auto& pair : client->GetContentStats()) globalStats[pair.first].Merge(pair.second);
     }
 
     // Write global summary CSV
     std::ofstream globalSummary(globalSummaryCsv, std::ios::out);
-    globalSummary << "content,total_requests,cache_hits,cache_misses,hit_rate_percent,avg_latency_ms,min_latency_ms,max_latency_ms,avg_hit_latency_ms,avg_miss_latency_ms\n";
-
-    for (const auto& pair : globalStats) {
-      const std::string& content = pair.first;
-      const HttpClientApp::ContentStats& stats = pair.second;
-
-      double hitRate = (stats.totalRequests > 0) ? (100.0 * stats.cacheHits / stats.totalRequests) : 0.0;
-      double avgLatency = (stats.totalRequests > 0) ? (stats.totalLatency / stats.totalRequests) : 0.0;
-      double avgHitLatency = (stats.cacheHits > 0) ? (stats.totalHitLatency / stats.cacheHits) : 0.0;
-      double avgMissLatency = (stats.cacheMisses > 0) ? (stats.totalMissLatency / stats.cacheMisses) : 0.0;
-
-      globalSummary << content << ","
-                    << stats.totalRequests << ","
-                    << stats.cacheHits << ","
-                    << stats.cacheMisses << ","
-                    << hitRate << ","
-                    << avgLatency << ","
-                    << stats.minLatency << ","
-                    << stats.maxLatency << ","
-                    << avgHitLatency << ","
-                    << avgMissLatency << "\n";
-    }
-
+    HttpClientApp::WriteSummaryHeader(globalSummary, "content");
+    for (const auto& pair : globalStats) HttpClientApp::WriteSummaryRow(globalSummary, pair.first, pair.second);
     globalSummary.close();
     std::cout << "Global summary written to: " << globalSummaryCsv << std::endl;
     // Optionally write a service-level aggregated CSV
@@ -268,37 +477,12 @@ int main(int argc, char** argv){
           else serviceKey = content;
         }
 
-        auto& agg = serviceStats[serviceKey];
-        agg.totalRequests += stats.totalRequests;
-        agg.cacheHits += stats.cacheHits;
-        agg.cacheMisses += stats.cacheMisses;
-        agg.totalLatency += stats.totalLatency;
-        agg.totalHitLatency += stats.totalHitLatency;
-        agg.totalMissLatency += stats.totalMissLatency;
-        agg.minLatency = std::min(agg.minLatency, stats.minLatency);
-        agg.maxLatency = std::max(agg.maxLatency, stats.maxLatency);
+        serviceStats[serviceKey].Merge(stats);
       }
 
       std::ofstream serviceSummary(serviceSummaryCsv, std::ios::out);
-      serviceSummary << "service,total_requests,cache_hits,cache_misses,hit_rate_percent,avg_latency_ms,min_latency_ms,max_latency_ms,avg_hit_latency_ms,avg_miss_latency_ms\n";
-      for (const auto& pair : serviceStats) {
-        const std::string& service = pair.first;
-        const HttpClientApp::ContentStats& stats = pair.second;
-        double hitRate = (stats.totalRequests > 0) ? (100.0 * stats.cacheHits / stats.totalRequests) : 0.0;
-        double avgLatency = (stats.totalRequests > 0) ? (stats.totalLatency / stats.totalRequests) : 0.0;
-        double avgHitLatency = (stats.cacheHits > 0) ? (stats.totalHitLatency / stats.cacheHits) : 0.0;
-        double avgMissLatency = (stats.cacheMisses > 0) ? (stats.totalMissLatency / stats.cacheMisses) : 0.0;
-        serviceSummary << service << ","
-                       << stats.totalRequests << ","
-                       << stats.cacheHits << ","
-                       << stats.cacheMisses << ","
-                       << hitRate << ","
-                       << avgLatency << ","
-                       << stats.minLatency << ","
-                       << stats.maxLatency << ","
-                       << avgHitLatency << ","
-                       << avgMissLatency << "\n";
-      }
+      HttpClientApp::WriteSummaryHeader(serviceSummary, "service");
+      for (const auto& pair : serviceStats) HttpClientApp::WriteSummaryRow(serviceSummary, pair.first, pair.second);
       serviceSummary.close();
       std::cout << "Service-level summary written to: " << serviceSummaryCsv << std::endl;
     }
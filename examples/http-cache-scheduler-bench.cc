@@ -0,0 +1,99 @@
+// Event scheduler benchmark: keeps N periodic timers pending, like N clients
+// each waiting for their next request, plus short one-shot events standing in
+// for cache replies, and measures events processed per wall-clock second for
+// each scheduler implementation.
+
+#include "ns3/core-module.h"
+#include "ns3/timing-wheel-scheduler.h"
+#include <chrono>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+namespace {
+
+std::mt19937_64 g_rng;
+int64_t g_periodNs = 0;
+double g_jitter = 0.0;
+double g_replyProb = 0.0;
+
+void Reply() {}
+
+void Tick() {
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  double factor = 1.0 + g_jitter * (2.0 * u(g_rng) - 1.0);
+  Simulator::Schedule(NanoSeconds(static_cast<int64_t>(g_periodNs * factor)), &Tick);
+  if (u(g_rng) < g_replyProb) {
+    Simulator::Schedule(MicroSeconds(1000 + static_cast<int64_t>(4000 * u(g_rng))), &Reply);
+  }
+}
+
+std::vector<std::string> Split(const std::string& list) {
+  std::vector<std::string> out;
+  std::stringstream ss(list);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (!item.empty()) out.push_back(item);
+  }
+  return out;
+}
+
+} // namespace
+
+int main(int argc, char** argv){
+  std::string schedulers = "heap,map,calendar,wheel";
+  std::string pending = "10000,100000,1000000";
+  uint64_t events = 5000000;
+  double period = 1.0;
+  double jitter = 0.1;
+  double replyProb = 0.5;
+  uint32_t seed = 1;
+
+  CommandLine cmd;
+  cmd.AddValue("schedulers", "Comma-separated schedulers: heap, map, list, calendar, wheel", schedulers);
+  cmd.AddValue("pending", "Comma-separated numbers of periodic timers", pending);
+  cmd.AddValue("events", "Approximate events to process per measurement", events);
+  cmd.AddValue("period", "Mean timer period (seconds)", period);
+  cmd.AddValue("jitter", "Relative period jitter (uniform +/-)", jitter);
+  cmd.AddValue("replyProb", "Probability a tick also schedules a 1-5 ms one-shot event", replyProb);
+  cmd.AddValue("seed", "Random seed", seed);
+  cmd.Parse(argc, argv);
+
+  g_periodNs = Seconds(period).GetNanoSeconds();
+  g_jitter = jitter;
+  g_replyProb = replyProb;
+
+  std::cout << std::setw(10) << "scheduler" << std::setw(12) << "pending"
+            << std::setw(14) << "events" << std::setw(10) << "wall_s"
+            << std::setw(16) << "events/s" << std::endl;
+  for (const auto& p : Split(pending)) {
+    uint64_t n = std::stoull(p);
+    for (const auto& name : Split(schedulers)) {
+      if (!SetSimulatorScheduler(name)) {
+        std::cerr << "Unknown scheduler " << name << std::endl;
+        return 1;
+      }
+      g_rng.seed(seed);
+      std::uniform_int_distribution<int64_t> phase(0, g_periodNs - 1);
+      for (uint64_t i = 0; i < n; ++i) Simulator::Schedule(NanoSeconds(phase(g_rng)), &Tick);
+
+      // Each timer fires about once per period (plus replies)
+      double rounds = std::max(1.0, static_cast<double>(events) / (n * (1.0 + replyProb)));
+      Simulator::Stop(Seconds(rounds * period));
+      auto start = std::chrono::steady_clock::now();
+      Simulator::Run();
+      double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      uint64_t count = Simulator::GetEventCount();
+      Simulator::Destroy();
+
+      std::cout << std::setw(10) << name << std::setw(12) << n << std::setw(14) << count
+                << std::setw(10) << std::fixed << std::setprecision(2) << wall
+                << std::setw(16) << std::setprecision(0) << (wall > 0 ? count / wall : 0.0) << std::endl;
+    }
+  }
+  return 0;
+}
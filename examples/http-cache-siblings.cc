@@ -0,0 +1,222 @@
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/http-client-app.h"
+#include "ns3/http-cache-app.h"
+#include "ns3/http-origin-app.h"
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+// Edge caches cooperating through Bloom-filter digests: each cache has its own
+// clients and its own link to a shared origin, and every pair of caches is
+// connected by a sibling link. A miss goes to a sibling whose digest holds
+// the key before it goes to the origin.
+int main(int argc, char** argv){
+  Time::SetResolution(Time::NS);
+  uint32_t numCaches = 3;
+  uint32_t clientsPerCache = 2;
+  uint32_t nReq = 2000;
+  double interval = 0.01;
+  uint32_t numContent = 2000;
+  double zipfS = 0.8;
+  uint32_t cacheCapacityObjs = 500;
+  double ttl = 60.0;
+  uint32_t objectSize = 1024;
+  uint32_t cacheDelay = 1;       // ms
+  uint32_t originDelay = 5;      // ms
+  std::string siblingLinkDelay = "2ms";
+  std::string originLinkDelay = "20ms";
+  bool siblings = true;
+  double digestInterval = 2.0;   // s
+  uint32_t digestBits = 8;
+  uint32_t digestHashes = 4;
+  double siblingTimeoutMs = 50.0;
+  double stopTime = 30.0;
+  CommandLine cmd;
+  cmd.AddValue("numCaches", "Number of edge caches", numCaches);
+  cmd.AddValue("clientsPerCache", "Clients attached to each cache", clientsPerCache);
+  cmd.AddValue("nReq", "Requests per client", nReq);
+  cmd.AddValue("interval", "Seconds between requests of one client", interval);
+  cmd.AddValue("numContent", "Number of distinct content items", numContent);
+  cmd.AddValue("zipfS", "Zipf exponent of the popularity shared by all clients", zipfS);
+  cmd.AddValue("cacheCapacityObjs", "Capacity of each cache in objects", cacheCapacityObjs);
+  cmd.AddValue("ttl", "TTL seconds", ttl);
+  cmd.AddValue("objectSize", "Object size in bytes", objectSize);
+  cmd.AddValue("cacheDelay", "Cache processing delay for hits (ms)", cacheDelay);
+  cmd.AddValue("originDelay", "Origin processing delay (ms)", originDelay);
+  cmd.AddValue("siblingLinkDelay", "One-way delay of the links between caches", siblingLinkDelay);
+  cmd.AddValue("originLinkDelay", "One-way delay of each cache's link to the origin", originLinkDelay);
+  cmd.AddValue("siblings", "Cooperate through digests (false = independent caches)", siblings);
+  cmd.AddValue("digestInterval", "Seconds between digests sent to each sibling", digestInterval);
+  cmd.AddValue("digestBits", "Digest bits per cached object", digestBits);
+  cmd.AddValue("digestHashes", "Bloom probes per key in the digest", digestHashes);
+  cmd.AddValue("siblingTimeoutMs", "Fall back to the origin after this long without a sibling answer (ms)", siblingTimeoutMs);
+  cmd.AddValue("stopTime", "Simulation stop time (seconds)", stopTime);
+  cmd.Parse(argc, argv);
+  if (numCaches < 1 || numCaches > 250 || clientsPerCache < 1 || clientsPerCache > 250) {
+    std::cerr << "numCaches and clientsPerCache must be between 1 and 250" << std::endl;
+    return 1;
+  }
+
+  NodeContainer cacheNodes;
+  cacheNodes.Create(numCaches);
+  NodeContainer clientNodes;
+  clientNodes.Create(numCaches * clientsPerCache);
+  NodeContainer originNodes;
+  originNodes.Create(1);
+  Ptr<Node> originNode = originNodes.Get(0);
+
+  InternetStackHelper internet;
+  internet.Install(cacheNodes);
+  internet.Install(clientNodes);
+  internet.Install(originNodes);
+
+  PointToPointHelper p2pClient;
+  p2pClient.SetDeviceAttribute("DataRate", StringValue("1Gbps"));
+  p2pClient.SetChannelAttribute("Delay", StringValue("2ms"));
+  PointToPointHelper p2pOrigin;
+  p2pOrigin.SetDeviceAttribute("DataRate", StringValue("1Gbps"));
+  p2pOrigin.SetChannelAttribute("Delay", StringValue(originLinkDelay));
+  PointToPointHelper p2pSibling;
+  p2pSibling.SetDeviceAttribute("DataRate", StringValue("1Gbps"));
+  p2pSibling.SetChannelAttribute("Delay", StringValue(siblingLinkDelay));
+
+  Ipv4AddressHelper ip;
+  // Clients of cache c: 10.c.k.0/24
+  std::vector<Ipv4Address> clientSideCache(clientNodes.GetN());
+  for (uint32_t c = 0; c < numCaches; ++c) {
+    for (uint32_t k = 0; k < clientsPerCache; ++k) {
+      uint32_t i = c * clientsPerCache + k;
+      NetDeviceContainer dev = p2pClient.Install(clientNodes.Get(i), cacheNodes.Get(c));
+      std::ostringstream subnet;
+      subnet << "10." << c << "." << k << ".0";
+      ip.SetBase(subnet.str().c_str(), "255.255.255.0");
+      clientSideCache[i] = ip.Assign(dev).GetAddress(1);
+    }
+  }
+  // Cache c to the origin: 192.168.c.0/24
+  std::vector<Ipv4Address> originAddr(numCaches);
+  for (uint32_t c = 0; c < numCaches; ++c) {
+    NetDeviceContainer dev = p2pOrigin.Install(cacheNodes.Get(c), originNode);
+    std::ostringstream subnet;
+    subnet << "192.168." << c << ".0";
+    ip.SetBase(subnet.str().c_str(), "255.255.255.0");
+    originAddr[c] = ip.Assign(dev).GetAddress(1);
+  }
+  // Full mesh between caches: 172.16.n.0/24 per pair; siblingAddr[a][b] is b's address on the a-b link
+  std::vector<std::vector<Ipv4Address>> siblingAddr(numCaches, std::vector<Ipv4Address>(numCaches));
+  uint32_t link = 0;
+  for (uint32_t a = 0; a < numCaches; ++a) {
+    for (uint32_t b = a + 1; b < numCaches; ++b, ++link) {
+      NetDeviceContainer dev = p2pSibling.Install(cacheNodes.Get(a), cacheNodes.Get(b));
+      std::ostringstream subnet;
+      subnet << "172." << (16 + link / 256) << "." << (link % 256) << ".0";
+      ip.SetBase(subnet.str().c_str(), "255.255.255.0");
+      Ipv4InterfaceContainer ifs = ip.Assign(dev);
+      siblingAddr[a][b] = ifs.GetAddress(1);
+      siblingAddr[b][a] = ifs.GetAddress(0);
+    }
+  }
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+
+  uint16_t clientPort = 8080;
+  uint16_t originPort = 8081;
+
+  Ptr<HttpOriginApp> origin = CreateObject<HttpOriginApp>();
+  origin->SetListenPort(originPort);
+  origin->SetServiceDelay(MilliSeconds(originDelay));
+  origin->SetObjectSize(objectSize);
+  originNode->AddApplication(origin);
+  origin->SetStartTime(Seconds(0.1));
+  origin->SetStopTime(Seconds(stopTime));
+
+  std::vector<Ptr<HttpCacheApp>> caches;
+  for (uint32_t c = 0; c < numCaches; ++c) {
+    Ptr<HttpCacheApp> cache = CreateObject<HttpCacheApp>();
+    cache->SetListenPort(clientPort);
+    cache->SetOrigin(Address(originAddr[c]), originPort);
+    cache->SetTtl(Seconds(ttl));
+    cache->SetCapacity(cacheCapacityObjs);
+    cache->SetCacheDelay(MilliSeconds(cacheDelay));
+    cache->SetObjectSize(objectSize);
+    if (siblings) {
+      for (uint32_t s = 0; s < numCaches; ++s) {
+        if (s != c) cache->AddSibling(Address(siblingAddr[c][s]));
+      }
+      cache->SetDigest(Seconds(digestInterval), digestBits, digestHashes);
+      cache->SetSiblingTimeout(MicroSeconds(static_cast<int64_t>(siblingTimeoutMs * 1000)));
+    }
+    cacheNodes.Get(c)->AddApplication(cache);
+    cache->SetStartTime(Seconds(0.2));
+    cache->SetStopTime(Seconds(stopTime));
+    caches.push_back(cache);
+  }
+
+  for (uint32_t i = 0; i < clientNodes.GetN(); ++i) {
+    Ptr<HttpClientApp> client = CreateObject<HttpClientApp>();
+    client->SetRemote(Address(clientSideCache[i]), clientPort);
+    client->SetInterval(Seconds(interval));
+    client->SetNumContent(numContent);
+    client->SetZipf(true);
+    client->SetZipfS(zipfS);
+    client->SetTotalRequests(nReq);
+    clientNodes.Get(i)->AddApplication(client);
+    client->SetStartTime(Seconds(0.3));
+    client->SetStopTime(Seconds(stopTime - 0.1));
+  }
+
+  std::cout << "Starting simulation with " << numCaches << " caches x " << clientsPerCache << " clients"
+            << (siblings ? ", sibling digests every " : ", no cooperation");
+  if (siblings) std::cout << digestInterval << "s at " << digestBits << " bits/object";
+  std::cout << "..." << std::endl;
+  Simulator::Stop(Seconds(stopTime));
+  Simulator::Run();
+  std::cout << "Simulation completed successfully!" << std::endl;
+
+  uint64_t requests = 0, hits = 0, originKeys = 0;
+  HttpCacheApp::SiblingStats total;
+  std::cout << std::fixed;
+  for (uint32_t c = 0; c < numCaches; ++c) {
+    const Ptr<HttpCacheApp>& cache = caches[c];
+    const HttpCacheApp::SiblingStats& s = cache->GetSiblingStats();
+    uint64_t r = cache->GetTotalRequests();
+    std::cout << "Cache " << c << ": " << r << " requests, " << std::setprecision(1)
+              << (r > 0 ? 100.0 * cache->GetTotalHits() / r : 0.0) << "% local hits, " << s.siblingHits
+              << " sibling hits, " << s.falsePositives << " false positives, " << s.lookupTimeouts
+              << " lookup timeouts, " << cache->GetOriginKeys() << " origin fetches, digest "
+              << s.lastDigestBytes << " bytes" << std::endl;
+    requests += r;
+    hits += cache->GetTotalHits();
+    originKeys += cache->GetOriginKeys();
+    total.digestsSent += s.digestsSent;
+    total.digestBytesSent += s.digestBytesSent;
+    total.lookups += s.lookups;
+    total.siblingHits += s.siblingHits;
+    total.falsePositives += s.falsePositives;
+    total.lookupTimeouts += s.lookupTimeouts;
+  }
+  std::cout << "Total: " << requests << " requests, " << std::setprecision(1)
+            << (requests > 0 ? 100.0 * hits / requests : 0.0) << "% local hits, "
+            << (requests > 0 ? 100.0 * (hits + total.siblingHits) / requests : 0.0)
+            << "% served without the origin, " << originKeys << " origin fetches" << std::endl;
+  if (siblings) {
+    std::cout << "Siblings: " << total.lookups << " lookups, " << total.siblingHits << " hits, "
+              << total.falsePositives << " false positives (" << std::setprecision(1)
+              << (total.lookups > 0 ? 100.0 * total.falsePositives / total.lookups : 0.0) << "% of lookups), "
+              << total.lookupTimeouts << " timeouts" << std::endl;
+    std::cout << "Origin offload: " << (total.siblingHits + originKeys > 0
+                                           ? 100.0 * total.siblingHits / (total.siblingHits + originKeys) : 0.0)
+              << "% of local misses served by a sibling" << std::endl;
+    std::cout << "Digests: " << total.digestsSent << " sent, " << total.digestBytesSent << " bytes ("
+              << std::setprecision(2) << (stopTime > 0 ? 8.0 * total.digestBytesSent / stopTime / 1000.0 : 0.0)
+              << " kbit/s)" << std::endl;
+  }
+
+  Simulator::Destroy();
+  return 0;
+}
@@ -4,35 +4,49 @@
 #include "ns3/point-to-point-module.h"
 #include "ns3/applications-module.h"
 #include "ns3/http-client-app.h"
+#include "ns3/http-convergence-monitor.h"
+#include "ns3/http-link-monitor.h"
+#include "ns3/http-abr-client-app.h"
+#include "ns3/http-admission-filter.h"
 #include "ns3/http-cache-app.h"
 #include "ns3/http-origin-app.h"
+#include "ns3/http-progress-monitor.h"
+#include "ns3/http-stats-collector.h"
+#include "ns3/http-video-workload.h"
+#include "ns3/timing-wheel-scheduler.h"
+#include <algorithm>
+#include <fstream>
 #include <sstream>
 #include <vector>
+#include <chrono>
+#include <cstdlib>
 #include <iomanip>
 
 using namespace ns3;
 
-// Global variables for progress callback
+// Global state for the MRC report callback
 static Ptr<HttpCacheApp> g_cache;
 static double g_totalTime;
-static double g_progressInterval;
+static uint64_t g_mrcRange;
+static uint32_t g_mrcPoints;
+static uint32_t g_objectSize;
+static std::ofstream g_mrcCsv;
 
-void PrintProgress() {
+void ReportMrc(double interval) {
+  const HttpMrcEstimator& est = g_cache->GetEngine().GetMrcEstimator();
   double now = Simulator::Now().GetSeconds();
-  double pct = (now / g_totalTime) * 100.0;
-  uint64_t reqs = g_cache->GetTotalRequests();
-  uint64_t hits = g_cache->GetTotalHits();
-  double hitRate = (reqs > 0) ? (100.0 * hits / reqs) : 0.0;
-
-  std::cout << "[" << std::fixed << std::setprecision(0) << pct << "%] "
-            << std::setprecision(1) << now << "s/" << g_totalTime << "s | "
-            << reqs << " requests | "
-            << std::setprecision(1) << hitRate << "% hit rate"
-            << std::endl;
-
-  double nextTime = now + g_progressInterval;
-  if (nextTime <= g_totalTime) {
-    Simulator::Schedule(Seconds(g_progressInterval), &PrintProgress);
+  std::cout << "MRC at " << std::fixed << std::setprecision(1) << now << "s (" << est.GetTrackedKeys()
+            << " keys, rate " << std::setprecision(4) << est.GetSamplingRate() << ", "
+            << est.GetMemoryBytes() / 1024 << " KiB):";
+  for (const auto& pt : est.GetCurve(g_mrcRange, g_mrcPoints)) {
+    std::cout << " " << pt.first << ":" << std::setprecision(1) << 100.0 * pt.second << "%";
+    if (g_mrcCsv.is_open()) {
+      g_mrcCsv << now << "," << pt.first << "," << pt.first * g_objectSize << "," << pt.second << "\n";
+    }
+  }
+  std::cout << std::endl;
+  if (interval > 0 && now + interval <= g_totalTime) {
+    Simulator::Schedule(Seconds(interval), &ReportMrc, interval);
   }
 }
 
@@ -48,16 +62,102 @@ int main(int argc, char** argv){
   std::string csv = ""; std::string summaryCsv = "";
   std::string globalSummaryCsv = "";
   std::string serviceSummaryCsv = "";
+  uint32_t statsThreads = 0;
   bool zipf = false; double zipfS = 1.0;
   uint32_t originDelay = 1; uint32_t cacheDelay = 1;
   uint32_t objectSize = 1024;
   uint32_t clientCacheBw = 100; uint32_t cacheOriginBw = 50;
+  uint32_t requestHeaderBytes = 300;
+  uint32_t responseHeaderBytes = 0;
+  double linkStatsInterval = 0.0;
+  std::string linkStatsCsv = "";
   bool dynamicTtl = false;
   double ttlWindow = 300.0;
   double ttlThreshold = 0.5;
   double ttlReduction = 0.5;
   double ttlEvalInterval = 30.0;
   double progressInterval = 10.0; // percentage interval for progress updates
+  bool progressJson = false;
+  bool converge = false;
+  double convergePrecision = 0.02;
+  double convergeConfidence = 0.95;
+  double convergeInterval = 1.0;
+  uint32_t convergeBatches = 20;
+  bool abr = false;
+  std::string abrAlgorithm = "hybrid";
+  std::string renditions = "300,750,1500,3000";
+  double segmentDuration = 2.0;
+  double maxBuffer = 30.0;
+  double bytesScale = 0.05;
+  std::string workload = "classic";
+  double sessionRate = 1.0;
+  uint32_t numLiveServices = 0;
+  double liveWatchMean = 600.0;
+  double vodWatchMean = 900.0;
+  double seekProb = 0.0;
+  double abandonProb = 0.0;
+  double diurnalAmplitude = 0.0;
+  double diurnalPeriod = 86400.0;
+  std::string flashCrowds = "";
+  std::string scheduler = "";
+  bool mrc = false;
+  double mrcRate = 0.01;
+  uint32_t mrcMaxKeys = 8192;
+  uint32_t mrcMaxObjects = 0;
+  uint32_t mrcPoints = 20;
+  std::string mrcCsv = "";
+  double mrcInterval = 0.0;
+  std::string admission = "none";
+  uint32_t admissionItems = 0;
+  double serviceRateLimit = 0.0;
+  double serviceBurst = 0.0;
+  double clientRateLimit = 0.0;
+  double clientBurst = 0.0;
+  double originRateLimit = 0.0;
+  double originBurst = 0.0;
+  std::string limitAction = "reject";
+  double maxDeferMs = 500.0;
+  uint32_t chunkKiB = 0;
+  bool vodByteRanges = false;
+  std::string partition = "none";
+  std::string partitionShares = "";
+  uint32_t partitionStep = 0;
+  bool serviceStats = false;
+  std::string partitionCsv = "";
+  bool tiered = false;
+  double ramMB = 64.0;
+  double ssdGB = 1.0;
+  double ramLatencyUs = 1.0;
+  double ssdLatencyUs = 100.0;
+  double ramBwGBps = 10.0;
+  double ssdBwMBps = 2000.0;
+  uint32_t promoteHits = 1;
+  bool demote = true;
+  bool ssdInsert = false;
+  double ssdOverProvision = 0.28;
+  uint32_t originWorkers = 0;
+  uint32_t originQueueLimit = 0;
+  std::string originQueue = "fifo";
+  std::string originServiceModel = "fixed";
+  double originServiceCv = 1.0;
+  double originPerKiB = 0.0; // us
+  uint32_t cacheWorkers = 0;
+  uint32_t cacheQueueLimit = 0;
+  double cacheMissCostUs = 0.0;
+  double cachePerKiBUs = 0.0;
+  std::string cacheServiceModel = "fixed";
+  double cacheServiceCv = 1.0;
+  std::string cacheOverflow = "reject";
+  double batchWindowMs = 0.0;
+  uint32_t batchMaxKeys = 32;
+  std::string snapshotSave = "";
+  double snapshotAt = 0.0; // 0 = when the cache stops
+  std::string snapshotLoad = "";
+  double fastForward = 0.0; // seconds
+  std::string purges = "";
+  std::string purgeFrom = "origin";
+  bool purgeIndex = true;
+  double purgeStormWindow = 5.0;
 
   CommandLine cmd;
   cmd.AddValue("numClients", "Number of concurrent clients", numClients);
@@ -72,6 +172,7 @@ int main(int argc, char** argv){
   cmd.AddValue("summaryCsv", "Summary statistics CSV path (optional)", summaryCsv);
   cmd.AddValue("globalSummaryCsv", "Global aggregated summary CSV path (optional)", globalSummaryCsv);
   cmd.AddValue("serviceSummaryCsv", "Service-level aggregated summary CSV path (optional)", serviceSummaryCsv);
+  cmd.AddValue("statsThreads", "Threads for the post-run summaries (0 = one per hardware thread)", statsThreads);
   cmd.AddValue("zipf", "Use Zipf popularity over services", zipf);
   cmd.AddValue("zipfS", "Zipf exponent s (>0)", zipfS);
   cmd.AddValue("cacheDelay", "Cache processing delay for hits (ms)", cacheDelay);
@@ -80,13 +181,163 @@ int main(int argc, char** argv){
   cmd.AddValue("objectSize", "Object size in bytes (default 1024)", objectSize);
   cmd.AddValue("clientCacheBw", "Client-Cache link bandwidth (Mbps)", clientCacheBw);
   cmd.AddValue("cacheOriginBw", "Cache-Origin link bandwidth (Mbps)", cacheOriginBw);
+  cmd.AddValue("requestHeaderBytes", "Payload bytes of each request (HTTP request line and headers)", requestHeaderBytes);
+  cmd.AddValue("responseHeaderBytes", "Bytes added to each response for its headers", responseHeaderBytes);
+  cmd.AddValue("linkStatsInterval", "Sample link throughput, queues and drops every N seconds (0 = off)", linkStatsInterval);
+  cmd.AddValue("linkStatsCsv", "Write the link samples to this CSV (optional)", linkStatsCsv);
   cmd.AddValue("dynamicTtl", "Enable dynamic TTL policy", dynamicTtl);
   cmd.AddValue("ttlWindow", "Dynamic TTL sliding window (seconds)", ttlWindow);
   cmd.AddValue("ttlThreshold", "Request share threshold for TTL reduction (0.0-1.0)", ttlThreshold);
   cmd.AddValue("ttlReduction", "TTL reduction factor when penalized (0.0-1.0)", ttlReduction);
   cmd.AddValue("ttlEvalInterval", "Policy evaluation interval (seconds)", ttlEvalInterval);
   cmd.AddValue("progressInterval", "Progress update interval (percentage, default 10)", progressInterval);
+  cmd.AddValue("progressJson", "Also print each progress report as a PROGRESS {json} line", progressJson);
+  cmd.AddValue("converge", "Stop once steady-state hit ratio and mean/p99 latency are estimated precisely", converge);
+  cmd.AddValue("convergePrecision", "Target confidence half-width relative to each estimate", convergePrecision);
+  cmd.AddValue("convergeConfidence", "Confidence level of the intervals", convergeConfidence);
+  cmd.AddValue("convergeInterval", "Observation interval for warm-up detection and batching (seconds)", convergeInterval);
+  cmd.AddValue("convergeBatches", "Number of batches for the batch-means intervals", convergeBatches);
+  cmd.AddValue("abr", "Use adaptive-bitrate clients with a playback buffer", abr);
+  cmd.AddValue("abrAlgorithm", "ABR algorithm: throughput, buffer or hybrid", abrAlgorithm);
+  cmd.AddValue("renditions", "Comma-separated rendition bitrates (kbps)", renditions);
+  cmd.AddValue("segmentDuration", "Media seconds per segment (ABR)", segmentDuration);
+  cmd.AddValue("maxBuffer", "ABR playback buffer limit (seconds)", maxBuffer);
+  cmd.AddValue("bytesScale", "Wire bytes per media byte for ABR segments (keeps segments within UDP limits)", bytesScale);
+  cmd.AddValue("workload", "Request model: classic (per-client sequences) or sessions (live/VoD session arrivals)", workload);
+  cmd.AddValue("sessionRate", "Mean viewer session arrivals per second (sessions workload)", sessionRate);
+  cmd.AddValue("numLiveServices", "Services 1..N are live channels, the rest VoD (sessions workload)", numLiveServices);
+  cmd.AddValue("liveWatchMean", "Mean live viewing time (seconds)", liveWatchMean);
+  cmd.AddValue("vodWatchMean", "Mean VoD viewing time (seconds, log-normal)", vodWatchMean);
+  cmd.AddValue("seekProb", "Per-segment VoD seek probability", seekProb);
+  cmd.AddValue("abandonProb", "Probability a VoD viewer abandons within 30s", abandonProb);
+  cmd.AddValue("diurnalAmplitude", "Diurnal modulation of the session rate (0-1)", diurnalAmplitude);
+  cmd.AddValue("diurnalPeriod", "Diurnal period (seconds)", diurnalPeriod);
+  cmd.AddValue("flashCrowds", "Flash crowds as start:duration:multiplier:service, ';'-separated", flashCrowds);
+  cmd.AddValue("originWorkers", "Origin worker slots (0 = unlimited parallelism)", originWorkers);
+  cmd.AddValue("originQueueLimit", "Origin queue length before shedding (0 = unbounded)", originQueueLimit);
+  cmd.AddValue("originQueue", "Origin queue discipline: fifo or sjf (smallest object first)", originQueue);
+  cmd.AddValue("originServiceModel", "Origin service time distribution: fixed, exp or lognormal", originServiceModel);
+  cmd.AddValue("originServiceCv", "Coefficient of variation for lognormal service times", originServiceCv);
+  cmd.AddValue("originPerKiB", "Additional origin service time per KiB of object (us)", originPerKiB);
+  cmd.AddValue("cacheWorkers", "Cache worker cores serving requests (0 = unlimited parallelism)", cacheWorkers);
+  cmd.AddValue("cacheQueueLimit", "Cache request queue length before overflow (0 = unbounded)", cacheQueueLimit);
+  cmd.AddValue("cacheMissCostUs", "Cache CPU time to process a miss (us); a hit costs cacheDelay", cacheMissCostUs);
+  cmd.AddValue("cachePerKiBUs", "Additional cache CPU time per KiB of object (us)", cachePerKiBUs);
+  cmd.AddValue("cacheServiceModel", "Cache CPU time distribution: fixed, exp or lognormal", cacheServiceModel);
+  cmd.AddValue("cacheServiceCv", "Coefficient of variation for lognormal cache CPU times", cacheServiceCv);
+  cmd.AddValue("cacheOverflow", "Requests beyond the cache queue limit: reject (UNAVAILABLE) or drop", cacheOverflow);
+  cmd.AddValue("serviceRateLimit", "Client requests per second per service at the cache (0 = unlimited)", serviceRateLimit);
+  cmd.AddValue("serviceBurst", "Token-bucket depth of the per-service limit (0 = one second's worth)", serviceBurst);
+  cmd.AddValue("clientRateLimit", "Requests per second per client at the cache (0 = unlimited)", clientRateLimit);
+  cmd.AddValue("clientBurst", "Token-bucket depth of the per-client limit (0 = one second's worth)", clientBurst);
+  cmd.AddValue("originRateLimit", "Origin fetches per second per service (0 = unlimited)", originRateLimit);
+  cmd.AddValue("originBurst", "Token-bucket depth of the origin fetch limit (0 = one second's worth)", originBurst);
+  cmd.AddValue("limitAction", "Over-limit requests: reject (UNAVAILABLE), defer or stale", limitAction);
+  cmd.AddValue("maxDeferMs", "Longest a deferred request is held before it is rejected (ms)", maxDeferMs);
+  cmd.AddValue("chunkKiB", "Cache objects as chunks of this many KiB and serve byte ranges from them (0 = whole objects)", chunkKiB);
+  cmd.AddValue("vodByteRanges", "Sessions fetch each VoD asset as byte ranges of one file (numSegments x objectSize bytes)", vodByteRanges);
+  cmd.AddValue("purges", "Purges as at:scope:target, ';'-separated; scope is key, prefix or service", purges);
+  cmd.AddValue("purgeFrom", "Purge trigger: origin (pushed to the cache) or cache (scheduled locally)", purgeFrom);
+  cmd.AddValue("purgeIndex", "Index cached keys so prefix and service purges skip unaffected entries", purgeIndex);
+  cmd.AddValue("purgeStormWindow", "Seconds after each purge over which origin fetches are counted", purgeStormWindow);
+  cmd.AddValue("batchWindowMs", "Batch cache misses to the origin within this window (ms, 0 = off)", batchWindowMs);
+  cmd.AddValue("batchMaxKeys", "Maximum keys per batched origin request", batchMaxKeys);
+  cmd.AddValue("snapshotSave", "Save the cache contents to this binary snapshot (optional)", snapshotSave);
+  cmd.AddValue("snapshotAt", "Simulation time of the snapshot save (seconds, 0 = when the cache stops)", snapshotAt);
+  cmd.AddValue("snapshotLoad", "Warm-start the cache from this snapshot (optional)", snapshotLoad);
+  cmd.AddValue("fastForward", "Warm the cache without packets for this many seconds, then simulate normally", fastForward);
+  cmd.AddValue("tiered", "Use byte-bounded RAM + SSD tiers instead of the object-count LRU", tiered);
+  cmd.AddValue("ramMB", "RAM tier capacity (MB)", ramMB);
+  cmd.AddValue("ssdGB", "SSD tier capacity (GB)", ssdGB);
+  cmd.AddValue("ramLatencyUs", "RAM tier access latency (us)", ramLatencyUs);
+  cmd.AddValue("ssdLatencyUs", "SSD tier access latency (us)", ssdLatencyUs);
+  cmd.AddValue("ramBwGBps", "RAM tier bandwidth (GB/s)", ramBwGBps);
+  cmd.AddValue("ssdBwMBps", "SSD tier bandwidth (MB/s), shared by reads and writes", ssdBwMBps);
+  cmd.AddValue("promoteHits", "Promote SSD objects to RAM on their Nth SSD hit (0 = never)", promoteHits);
+  cmd.AddValue("demote", "Demote RAM victims to SSD instead of dropping them", demote);
+  cmd.AddValue("ssdInsert", "Insert new objects into SSD instead of RAM", ssdInsert);
+  cmd.AddValue("ssdOverProvision", "SSD spare-area fraction for write-amplification accounting", ssdOverProvision);
+  cmd.AddValue("admission", "Admission filter: none, second-hit or frequency", admission);
+  cmd.AddValue("admissionItems", "Distinct keys the admission sketch is sized for (0 = cache capacity in objects)", admissionItems);
+  cmd.AddValue("partition", "Split cache capacity by service: none, static, weighted or dynamic", partition);
+  cmd.AddValue("partitionShares", "service:value,... quotas in objects (static) or weights (weighted)", partitionShares);
+  cmd.AddValue("partitionStep", "Objects of quota moved per ghost hit (dynamic, 0 = capacity / 1000)", partitionStep);
+  cmd.AddValue("serviceStats", "Report per-service occupancy and hit ratio even without partitioning", serviceStats);
+  cmd.AddValue("partitionCsv", "Write per-service cache statistics to this CSV (optional)", partitionCsv);
+  cmd.AddValue("mrc", "Estimate the LRU hit-ratio-vs-capacity curve during the run (SHARDS)", mrc);
+  cmd.AddValue("mrcRate", "Initial MRC key sampling rate (0-1]", mrcRate);
+  cmd.AddValue("mrcMaxKeys", "Maximum keys tracked by the MRC estimator", mrcMaxKeys);
+  cmd.AddValue("mrcMaxObjects", "Largest capacity on the curve, in objects (0 = 4x cache capacity)", mrcMaxObjects);
+  cmd.AddValue("mrcPoints", "Number of capacities on the curve", mrcPoints);
+  cmd.AddValue("mrcCsv", "Write the curve to this CSV (optional)", mrcCsv);
+  cmd.AddValue("mrcInterval", "Also report the curve every N simulated seconds (0 = end of run only)", mrcInterval);
+  cmd.AddValue("scheduler", "Event scheduler: heap, map, list, calendar or wheel (default: simulator default)", scheduler);
   cmd.Parse(argc, argv);
+  // Wrapped so that progress reports can show the event-queue length with any scheduler
+  Ptr<EventQueueProbe> queueProbe = SetCountingScheduler(scheduler);
+  if (!queueProbe) {
+    std::cerr << "Unknown scheduler " << scheduler << std::endl;
+    return 1;
+  }
+  if (workload == "sessions" && abr) {
+    // ABR clients run their own sessions; the session workload would be silently unused
+    std::cerr << "--workload=sessions cannot be combined with --abr" << std::endl;
+    return 1;
+  }
+  if (vodByteRanges && workload != "sessions") {
+    std::cerr << "--vodByteRanges requires --workload=sessions" << std::endl;
+    return 1;
+  }
+  struct PurgeSpec {
+    double at;
+    HttpPurgeHeader::Scope scope;
+    std::string target;
+  };
+  std::vector<PurgeSpec> purgeSpecs;
+  {
+    std::stringstream ss(purges);
+    std::string item;
+    while (std::getline(ss, item, ';')) {
+      if (item.empty()) continue;
+      size_t c1 = item.find(':');
+      size_t c2 = c1 == std::string::npos ? c1 : item.find(':', c1 + 1);
+      PurgeSpec spec;
+      char* end = nullptr;
+      spec.at = c2 == std::string::npos ? -1.0 : std::strtod(item.c_str(), &end);
+      if (spec.at < 0 || end != item.c_str() + c1 || c2 + 1 == item.size()
+          || !HttpCacheApp::ParsePurgeScope(item.substr(c1 + 1, c2 - c1 - 1), &spec.scope)) {
+        std::cerr << "Malformed purge " << item << " (expected at:key|prefix|service:target)" << std::endl;
+        return 1;
+      }
+      spec.target = item.substr(c2 + 1);
+      purgeSpecs.push_back(spec);
+    }
+  }
+  if (static_cast<uint64_t>(objectSize) + responseHeaderBytes > 65507) {
+    std::cerr << "objectSize + responseHeaderBytes must fit in one UDP datagram (65507 bytes)" << std::endl;
+    return 1;
+  }
+  // Chunk fetches are answered one chunk per datagram
+  if (chunkKiB > 0 && static_cast<uint64_t>(chunkKiB) * 1024 + responseHeaderBytes > 65507) {
+    std::cerr << "chunkKiB x 1024 + responseHeaderBytes must fit in one UDP datagram (65507 bytes)" << std::endl;
+    return 1;
+  }
+  // Without chunks the cache fetches and answers the whole VoD file in one datagram
+  if (vodByteRanges && chunkKiB == 0
+      && static_cast<uint64_t>(numSegments) * objectSize + responseHeaderBytes > 65507) {
+    std::cerr << "--vodByteRanges without --chunkKiB: numSegments x objectSize + responseHeaderBytes must fit in one "
+                 "UDP datagram (65507 bytes)" << std::endl;
+    return 1;
+  }
+  if (purgeFrom != "origin" && purgeFrom != "cache") {
+    std::cerr << "Unknown purgeFrom " << purgeFrom << std::endl;
+    return 1;
+  }
+  if (fastForward > 0 && abr) {
+    // ABR clients pace themselves on responses, which the direct path does not produce
+    std::cerr << "--fastForward cannot be combined with --abr" << std::endl;
+    return 1;
+  }
 
   // Setup progress tracking
   bool verboseSetup = (numClients >= 1000);
@@ -141,13 +392,29 @@ int main(int argc, char** argv){
   Ipv4GlobalRoutingHelper::PopulateRoutingTables();
   if (verboseSetup) std::cout << " done" << std::endl;
 
-  uint16_t clientToCachePort = 8080; uint16_t cacheToOriginPort = 8081;
+  uint16_t clientToCachePort = 8080; uint16_t cacheToOriginPort = 8081; uint16_t originBatchPort = 8082;
+  uint16_t cachePurgePort = 8085;
 
   // Origin app
   Ptr<HttpOriginApp> origin = CreateObject<HttpOriginApp>();
   origin->SetListenPort(cacheToOriginPort);
+  origin->SetBatchPort(originBatchPort);
   origin->SetServiceDelay(MilliSeconds(originDelay));
   origin->SetObjectSize(objectSize);
+  origin->SetResponseHeaderSize(responseHeaderBytes);
+  HttpServerQueue& originQ = origin->GetServerQueue();
+  HttpServerQueue::Discipline discipline;
+  HttpServerQueue::ServiceModel serviceModel;
+  if (!HttpServerQueue::ParseDiscipline(originQueue, &discipline)
+      || !HttpServerQueue::ParseServiceModel(originServiceModel, &serviceModel)) {
+    std::cerr << "Unknown originQueue or originServiceModel" << std::endl;
+    return 1;
+  }
+  originQ.SetWorkers(originWorkers);
+  originQ.SetQueueLimit(originQueueLimit);
+  originQ.SetDiscipline(discipline);
+  originQ.SetServiceModel(serviceModel, originServiceCv);
+  originQ.SetServiceTimePerKiB(MicroSeconds(static_cast<uint64_t>(originPerKiB)));
   originNode->AddApplication(origin);
   origin->SetStartTime(Seconds(0.1));
   origin->SetStopTime(Seconds(totalTime + 1.0));
@@ -160,7 +427,9 @@ int main(int argc, char** argv){
     capacityBytes = static_cast<uint64_t>(maxObjects) * objectSize;
   } else {
     capacityBytes = static_cast<uint64_t>(cacheCapacityGB * 1024 * 1024 * 1024);
-    maxObjects = static_cast<uint32_t>(capacityBytes / objectSize);
+    // Each chunk is an entry, so a chunked cache of the same bytes holds more entries
+    uint32_t entryBytes = chunkKiB > 0 ? std::min(objectSize, chunkKiB * 1024) : objectSize;
+    maxObjects = static_cast<uint32_t>(capacityBytes / entryBytes);
   }
   std::cout << "Cache configuration:" << std::endl;
   if (cacheCapacityObjs > 0) {
@@ -170,6 +439,7 @@ int main(int argc, char** argv){
   }
   std::cout << "  Object size: " << objectSize << " bytes" << std::endl;
   std::cout << "  Max objects: " << maxObjects << std::endl;
+  if (chunkKiB > 0) std::cout << "  Chunk size: " << chunkKiB << " KiB (max objects counts chunks)" << std::endl;
   if (dynamicTtl) {
     std::cout << "  Dynamic TTL: enabled" << std::endl;
     std::cout << "    Window: " << ttlWindow << "s" << std::endl;
@@ -180,15 +450,98 @@ int main(int argc, char** argv){
   Ptr<HttpCacheApp> cache = CreateObject<HttpCacheApp>();
   cache->SetListenPort(clientToCachePort);
   cache->SetOrigin(Address(cacheOriginInterfaces.GetAddress(1)), cacheToOriginPort);
+  cache->SetOriginBatchPort(originBatchPort);
+  cache->SetBatching(MicroSeconds(static_cast<int64_t>(batchWindowMs * 1000)), batchMaxKeys);
   cache->SetTtl(Seconds(ttl));
   cache->SetCapacity(maxObjects);
   cache->SetCacheDelay(MilliSeconds(cacheDelay));
+  HttpServerQueue::ServiceModel cacheModel;
+  if (!HttpServerQueue::ParseServiceModel(cacheServiceModel, &cacheModel)
+      || (cacheOverflow != "reject" && cacheOverflow != "drop")) {
+    std::cerr << "Unknown cacheServiceModel or cacheOverflow" << std::endl;
+    return 1;
+  }
+  cache->SetMissCost(NanoSeconds(static_cast<int64_t>(cacheMissCostUs * 1000)));
+  cache->SetOverflowReject(cacheOverflow == "reject");
+  cache->GetCpu().SetWorkers(cacheWorkers);
+  cache->GetCpu().SetQueueLimit(cacheQueueLimit);
+  cache->GetCpu().SetServiceModel(cacheModel, cacheServiceCv);
+  cache->GetCpu().SetServiceTimePerKiB(NanoSeconds(static_cast<int64_t>(cachePerKiBUs * 1000)));
+  HttpCacheApp::LimitAction limitActionValue;
+  if (!HttpCacheApp::ParseLimitAction(limitAction, &limitActionValue)) {
+    std::cerr << "Unknown limitAction " << limitAction << std::endl;
+    return 1;
+  }
+  cache->SetServiceRateLimit(serviceRateLimit, serviceBurst);
+  cache->SetClientRateLimit(clientRateLimit, clientBurst);
+  cache->SetOriginRateLimit(originRateLimit, originBurst);
+  cache->SetLimitAction(limitActionValue, MicroSeconds(static_cast<int64_t>(maxDeferMs * 1000)));
   cache->SetObjectSize(objectSize);
+  cache->SetHeaderSizes(requestHeaderBytes, responseHeaderBytes);
+  cache->SetChunkSize(chunkKiB * 1024);
   cache->SetDynamicTtlEnabled(dynamicTtl);
   cache->SetTtlWindow(Seconds(ttlWindow));
   cache->SetTtlThreshold(ttlThreshold);
   cache->SetTtlReduction(ttlReduction);
   cache->SetTtlEvalInterval(Seconds(ttlEvalInterval));
+  HttpAdmissionFilter::Mode admissionMode;
+  if (!HttpAdmissionFilter::ParseMode(admission, &admissionMode)) {
+    std::cerr << "Unknown admission mode " << admission << std::endl;
+    return 1;
+  }
+  uint64_t cachedObjects = tiered ? static_cast<uint64_t>((ramMB * 1024 * 1024 + ssdGB * 1024 * 1024 * 1024) / objectSize)
+                                  : maxObjects;
+  cache->GetEngine().SetAdmission(admissionMode, admissionItems > 0 ? admissionItems : cachedObjects);
+  g_mrcRange = mrcMaxObjects > 0 ? mrcMaxObjects : 4 * std::max<uint64_t>(1, cachedObjects);
+  g_mrcPoints = mrcPoints;
+  g_objectSize = objectSize;
+  if (mrc) {
+    cache->GetEngine().SetMrcEstimation(mrcRate, mrcMaxKeys, static_cast<uint32_t>(std::max<uint64_t>(1, g_mrcRange / 1000)));
+    if (!mrcCsv.empty()) {
+      g_mrcCsv.open(mrcCsv);
+      g_mrcCsv << "time_s,capacity_objects,capacity_bytes,hit_ratio\n";
+    }
+  }
+  if (tiered) {
+    HttpCacheEngine& engine = cache->GetEngine();
+    engine.SetTieredEnabled(true);
+    engine.SetTierModel(HttpCacheEngine::RAM, static_cast<uint64_t>(ramMB * 1024 * 1024),
+                        NanoSeconds(static_cast<int64_t>(ramLatencyUs * 1000)), ramBwGBps * 1e9);
+    engine.SetTierModel(HttpCacheEngine::SSD, static_cast<uint64_t>(ssdGB * 1024 * 1024 * 1024),
+                        NanoSeconds(static_cast<int64_t>(ssdLatencyUs * 1000)), ssdBwMBps * 1e6);
+    engine.SetPromotionHits(promoteHits);
+    engine.SetDemotionEnabled(demote);
+    engine.SetInsertTier(ssdInsert ? HttpCacheEngine::SSD : HttpCacheEngine::RAM);
+    engine.SetSsdOverProvisioning(ssdOverProvision);
+    std::cout << "  Tiered storage: " << ramMB << " MB RAM + " << ssdGB << " GB SSD" << std::endl;
+  }
+  HttpCacheEngine::PartitionMode partitionMode;
+  if (!HttpCacheEngine::ParsePartitionMode(partition, &partitionMode)) {
+    std::cerr << "Unknown partition mode " << partition << std::endl;
+    return 1;
+  }
+  if (partitionMode != HttpCacheEngine::SHARED && tiered) {
+    std::cerr << "--partition applies to the object-count LRU and cannot be combined with --tiered" << std::endl;
+    return 1;
+  }
+  cache->GetEngine().SetPartitioning(partitionMode, partitionStep);
+  cache->GetEngine().SetServiceStatsEnabled(serviceStats || !partitionCsv.empty());
+  if (!cache->GetEngine().SetPartitionShares(partitionShares)) {
+    std::cerr << "Malformed --partitionShares " << partitionShares << std::endl;
+    return 1;
+  }
+  cache->GetEngine().SetPurgeIndexEnabled(purgeIndex);
+  cache->SetPurgeStormWindow(Seconds(purgeStormWindow));
+  if (!purgeSpecs.empty() && purgeFrom == "origin") {
+    cache->SetPurgePort(cachePurgePort);
+    origin->AddPurgeSubscriber(Address(cacheOriginInterfaces.GetAddress(0)), cachePurgePort);
+  }
+  for (const PurgeSpec& spec : purgeSpecs) {
+    if (purgeFrom == "origin") origin->SchedulePurge(Seconds(spec.at), spec.scope, spec.target);
+    else cache->SchedulePurge(Seconds(spec.at), spec.scope, spec.target);
+  }
+  if (!snapshotLoad.empty()) cache->SetSnapshotLoad(snapshotLoad);
+  if (!snapshotSave.empty()) cache->SetSnapshotSave(snapshotSave, Seconds(snapshotAt > 0 ? snapshotAt : totalTime + 1.0));
   cacheNode->AddApplication(cache);
   cache->SetStartTime(Seconds(0.2));
   cache->SetStopTime(Seconds(totalTime + 1.0));
@@ -196,10 +549,28 @@ int main(int argc, char** argv){
   // Clients
   if (verboseSetup) std::cout << "Setup: Creating " << numClients << " client applications..." << std::flush;
   std::vector<Ptr<HttpClientApp>> clientApps;
+  std::vector<Ptr<HttpAbrClientApp>> abrApps;
+  // Every client records into one run-wide table; no per-client maps to merge after the run
+  Ptr<HttpStatsCollector> collector = CreateObject<HttpStatsCollector>();
+  collector->SetThreads(statsThreads);
   for (uint32_t i = 0; i < numClients; ++i) {
-    Ptr<HttpClientApp> client = CreateObject<HttpClientApp>();
+    Ptr<HttpClientApp> client;
+    if (abr) {
+      Ptr<HttpAbrClientApp> abrClient = CreateObject<HttpAbrClientApp>();
+      abrClient->SetRenditions(HttpAbrClientApp::ParseRenditions(renditions));
+      abrClient->SetSegmentDuration(Seconds(segmentDuration));
+      abrClient->SetMaxBuffer(Seconds(maxBuffer));
+      abrClient->SetBytesScale(bytesScale);
+      if (abrAlgorithm == "throughput") abrClient->SetAbrAlgorithm(HttpAbrClientApp::THROUGHPUT);
+      else if (abrAlgorithm == "buffer") abrClient->SetAbrAlgorithm(HttpAbrClientApp::BUFFER);
+      else abrClient->SetAbrAlgorithm(HttpAbrClientApp::HYBRID);
+      abrApps.push_back(abrClient);
+      client = abrClient;
+    } else {
+      client = CreateObject<HttpClientApp>();
+    }
     client->SetRemote(Address(clientCacheInterfaces[i].GetAddress(1)), clientToCachePort);
-    client->SetObjectSize(objectSize);
+    client->SetRequestHeaderSize(requestHeaderBytes);
     // Streaming-specific settings
     client->SetNumServices(numServices);
     client->SetNumSegments(numSegments);
@@ -207,7 +578,9 @@ int main(int argc, char** argv){
     client->SetZipf(zipf);
     client->SetZipfS(zipfS);
     client->SetStreaming(true);
+    client->SetExternallyDriven(abr || workload == "sessions");
     client->SetTotalTime(Seconds(totalTime));
+    client->SetStatsCollector(collector);
 
     // CSV paths
     if (!csv.empty()) {
@@ -243,121 +616,281 @@ int main(int argc, char** argv){
   }
   if (verboseSetup) std::cout << " done" << std::endl;
 
+  // Session workload: live edge / VoD viewers dispatched over the client pool
+  Ptr<HttpVideoWorkload> sessions;
+  if (workload == "sessions") {
+    sessions = CreateObject<HttpVideoWorkload>();
+    sessions->SetNumServices(numServices);
+    sessions->SetNumLiveServices(numLiveServices);
+    sessions->SetZipf(zipf, zipfS);
+    sessions->SetSegmentDuration(Seconds(segmentDuration));
+    sessions->SetVodSegments(numSegments);
+    sessions->SetSessionRate(sessionRate);
+    sessions->SetDiurnal(diurnalAmplitude, Seconds(diurnalPeriod), Seconds(0));
+    sessions->SetLiveWatchMean(Seconds(liveWatchMean));
+    sessions->SetVodWatchTime(Seconds(vodWatchMean), 1.0);
+    sessions->SetSeekProbability(seekProb);
+    sessions->SetAbandonProbability(abandonProb);
+    if (!sessions->SetVodByteRanges(vodByteRanges ? objectSize : 0)) {
+      std::cerr << "--vodByteRanges: numSegments x objectSize must stay below 4 GiB" << std::endl;
+      return 1;
+    }
+    std::stringstream fc(flashCrowds);
+    std::string spec;
+    while (std::getline(fc, spec, ';')) {
+      if (!spec.empty() && !sessions->AddFlashCrowd(spec)) {
+        std::cerr << "Invalid flash crowd spec '" << spec << "'" << std::endl;
+        return 1;
+      }
+    }
+    for (const auto& client : clientApps) sessions->AddClient(client);
+    sessions->Start(Seconds(0.4), Seconds(totalTime));
+    std::cout << "Session workload: " << sessionRate << " sessions/s, "
+              << numLiveServices << " live of " << numServices << " services" << std::endl;
+  }
+
+  // Fast-forward warm-up: requests go straight into the cache as function calls until then
+  if (fastForward > 0) {
+    cache->SetFastForward(Seconds(fastForward));
+    for (const auto& client : clientApps) {
+      client->SetDirectPath(MakeCallback(&HttpCacheApp::ServeDirect, cache), Seconds(fastForward));
+    }
+    std::cout << "Fast-forward warm-up: first " << fastForward << "s without packets" << std::endl;
+  }
+
   std::cout << "Starting streaming simulation with " << numClients << " client(s) for " << totalTime << "s..." << std::endl;
 
   // Set up progress tracking
   g_cache = cache;
   g_totalTime = totalTime;
-  g_progressInterval = (progressInterval / 100.0) * totalTime;
-  if (g_progressInterval > 0) {
-    Simulator::Schedule(Seconds(g_progressInterval), &PrintProgress);
+  Ptr<HttpConvergenceMonitor> convergence;
+  if (converge) {
+    convergence = CreateObject<HttpConvergenceMonitor>();
+    convergence->SetObservationInterval(Seconds(convergeInterval));
+    convergence->SetRelativePrecision(convergePrecision);
+    convergence->SetConfidence(convergeConfidence);
+    convergence->SetBatches(convergeBatches);
+    for (auto& c : clientApps) convergence->Attach(c);
+    convergence->Start(Seconds(std::max(0.3, fastForward)));
+  }
+
+  Ptr<HttpProgressMonitor> progress = CreateObject<HttpProgressMonitor>();
+  progress->SetCache(cache);
+  progress->SetQueueProbe(queueProbe);
+  progress->SetMachineReadable(progressJson);
+  progress->Start(Seconds((progressInterval / 100.0) * totalTime), Seconds(totalTime));
+
+  Ptr<HttpLinkMonitor> links;
+  if (linkStatsInterval > 0) {
+    links = CreateObject<HttpLinkMonitor>();
+    for (const auto& dev : clientCacheDevices) {
+      links->AddDevice("client->cache", dev.Get(0));
+      links->AddDevice("cache->client", dev.Get(1));
+    }
+    links->AddDevice("cache->origin", cacheOriginDevices.Get(0));
+    links->AddDevice("origin->cache", cacheOriginDevices.Get(1));
+    links->SetOutput(linkStatsCsv);
+    links->Start(Seconds(linkStatsInterval), Seconds(totalTime));
+  }
+
+  if (mrc && mrcInterval > 0) {
+    Simulator::Schedule(Seconds(mrcInterval), &ReportMrc, mrcInterval);
   }
 
   Simulator::Stop(Seconds(totalTime + 1.0));
+  auto wallStart = std::chrono::steady_clock::now();
   Simulator::Run();
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
   std::cout << "Simulation completed successfully!" << std::endl;
-
-  // Global summary aggregation
-  if (!globalSummaryCsv.empty()) {
-    std::cout << "Writing global summary CSV..." << std::endl;
-    std::unordered_map<std::string, HttpClientApp::ContentStats> globalStats;
-    for (const auto& client : clientApps) {
-      const auto& clientStats = client->GetContentStats();
-      for (const auto& pair : clientStats) {
-        const std::string& content = pair.first;
-        const HttpClientApp::ContentStats& stats = pair.second;
-        auto& global = globalStats[content];
-        global.totalRequests += stats.totalRequests;
-        global.cacheHits += stats.cacheHits;
-        global.cacheMisses += stats.cacheMisses;
-        global.totalLatency += stats.totalLatency;
-        global.totalHitLatency += stats.totalHitLatency;
-        global.totalMissLatency += stats.totalMissLatency;
-        global.minLatency = std::min(global.minLatency, stats.minLatency);
-        global.maxLatency = std::max(global.maxLatency, stats.maxLatency);
+  if (convergence) convergence->PrintSummary(std::cout);
+  std::cout << "Events: " << Simulator::GetEventCount() << " in " << std::fixed << std::setprecision(2) << wall
+            << "s wall clock (" << std::setprecision(0) << (wall > 0 ? Simulator::GetEventCount() / wall : 0.0)
+            << " events/s" << (scheduler.empty() ? "" : ", " + scheduler + " scheduler") << ")" << std::endl;
+  {
+    const auto& os = origin->GetServerQueue().GetStats();
+    std::cout << "Origin: " << os.served << " served, " << os.shed << " shed, utilization "
+              << std::fixed << std::setprecision(1) << 100.0 * origin->GetServerQueue().GetUtilization()
+              << "%, mean queue " << std::setprecision(2) << origin->GetServerQueue().GetMeanQueueDepth()
+              << " (max " << os.maxQueueDepth << "), mean wait "
+              << std::setprecision(3) << (os.served > 0 ? 1000.0 * os.waitSeconds / os.served : 0.0) << " ms"
+              << std::endl;
+    uint64_t keys = cache->GetOriginKeys();
+    uint64_t requests = cache->GetOriginRequests();
+    std::cout << "Origin fetches: " << keys << " keys in " << requests << " requests ("
+              << std::setprecision(1) << (keys > 0 ? 100.0 * (1.0 - static_cast<double>(requests) / keys) : 0.0)
+              << "% fewer), mean batching delay " << std::setprecision(3) << 1000.0 * cache->GetMeanBatchDelay()
+              << " ms, " << std::setprecision(1) << cache->GetOriginBytes() / (1024.0 * 1024.0) << " MB" << std::endl;
+    if (chunkKiB > 0) {
+      const auto& cs = cache->GetChunkStats();
+      uint64_t chunks = cs.chunkHits + cs.chunkMisses;
+      std::cout << "Chunks (" << chunkKiB << " KiB): " << cs.requests << " requests, " << cs.fullHits << " full hits, "
+                << cs.partialHits << " partial hits; " << (chunks > 0 ? 100.0 * cs.chunkHits / chunks : 0.0)
+                << "% of " << chunks << " chunks cached, " << cs.chunkFetches << " fetched, " << cs.chunksCoalesced
+                << " coalesced" << std::endl;
+    }
+    // Storm fetches are compared with the run's mean fetch rate over the same window
+    double meanWindowFetches = totalTime > 0 ? keys * purgeStormWindow / totalTime : 0.0;
+    static const char* scopeNames[] = {"key", "prefix", "service"};
+    for (const auto& pr : cache->GetPurges()) {
+      std::cout << "Purge at " << std::setprecision(1) << pr.at.GetSeconds() << "s " << scopeNames[pr.scope] << " "
+                << pr.target << ": " << pr.objects << " objects, " << pr.examined << " keys examined in "
+                << std::setprecision(1) << pr.wallMicros << " us";
+      if (pr.inFlight > 0) std::cout << ", " << pr.inFlight << " fetches in flight not stored";
+      if (pr.delay.IsStrictlyPositive()) {
+        std::cout << ", " << std::setprecision(3) << pr.delay.GetSeconds() * 1000.0 << " ms after the push";
       }
+      std::cout << "; " << pr.stormFetches << " origin fetches in the next " << std::setprecision(1)
+                << purgeStormWindow << "s (" << std::setprecision(2)
+                << (meanWindowFetches > 0 ? pr.stormFetches / meanWindowFetches : 0.0) << "x the mean)" << std::endl;
     }
-    std::ofstream globalSummary(globalSummaryCsv, std::ios::out);
-    globalSummary << "content,total_requests,cache_hits,cache_misses,hit_rate_percent,avg_latency_ms,min_latency_ms,max_latency_ms,avg_hit_latency_ms,avg_miss_latency_ms\n";
-    for (const auto& pair : globalStats) {
-      const std::string& content = pair.first;
-      const HttpClientApp::ContentStats& stats = pair.second;
-      double hitRate = (stats.totalRequests > 0) ? (100.0 * stats.cacheHits / stats.totalRequests) : 0.0;
-      double avgLatency = (stats.totalRequests > 0) ? (stats.totalLatency / stats.totalRequests) : 0.0;
-      double avgHitLatency = (stats.cacheHits > 0) ? (stats.totalHitLatency / stats.cacheHits) : 0.0;
-      double avgMissLatency = (stats.cacheMisses > 0) ? (stats.totalMissLatency / stats.cacheMisses) : 0.0;
-      globalSummary << content << ","
-                    << stats.totalRequests << ","
-                    << stats.cacheHits << ","
-                    << stats.cacheMisses << ","
-                    << hitRate << ","
-                    << avgLatency << ","
-                    << stats.minLatency << ","
-                    << stats.maxLatency << ","
-                    << avgHitLatency << ","
-                    << avgMissLatency << "\n";
+    const HttpServerQueue& cpu = cache->GetCpu();
+    std::cout << "Cache CPU: " << cpu.GetStats().served << " served, " << cpu.GetStats().shed << " shed, "
+              << std::setprecision(1);
+    if (cpu.GetWorkers() > 0) {
+      std::cout << "utilization " << 100.0 * cpu.GetUtilization() << "% of " << cpu.GetWorkers() << " workers";
+    } else {
+      std::cout << "mean concurrency " << cpu.GetUtilization();
     }
-    globalSummary.close();
-    std::cout << "Global summary written to: " << globalSummaryCsv << std::endl;
-    // Optionally write a service-level aggregated CSV
-    if (!serviceSummaryCsv.empty()) {
-      std::cout << "Writing service-level summary CSV..." << std::endl;
-      std::unordered_map<std::string, HttpClientApp::ContentStats> serviceStats;
-      for (const auto& pair : globalStats) {
-        const std::string& content = pair.first;
-        const HttpClientApp::ContentStats& stats = pair.second;
-        // Derive service key from content. For content like "/service-2/seg-1" we want "service-2".
-        std::string serviceKey;
-        size_t lastSlash = content.find_last_of('/');
-        if (lastSlash != std::string::npos) {
-          if (!content.empty() && content[0] == '/') {
-            if (lastSlash > 1) serviceKey = content.substr(1, lastSlash - 1);
-            else serviceKey = content.substr(1);
-          } else {
-            if (lastSlash > 0) serviceKey = content.substr(0, lastSlash);
-            else serviceKey = content;
-          }
-        } else {
-          if (!content.empty() && content[0] == '/') serviceKey = content.substr(1);
-          else serviceKey = content;
-        }
-
-        auto& agg = serviceStats[serviceKey];
-        agg.totalRequests += stats.totalRequests;
-        agg.cacheHits += stats.cacheHits;
-        agg.cacheMisses += stats.cacheMisses;
-        agg.totalLatency += stats.totalLatency;
-        agg.totalHitLatency += stats.totalHitLatency;
-        agg.totalMissLatency += stats.totalMissLatency;
-        agg.minLatency = std::min(agg.minLatency, stats.minLatency);
-        agg.maxLatency = std::max(agg.maxLatency, stats.maxLatency);
-      }
+    std::cout << ", mean queue " << std::setprecision(2) << cpu.GetMeanQueueDepth() << " (max "
+              << cpu.GetStats().maxQueueDepth << "), mean wait " << std::setprecision(3)
+              << (cpu.GetStats().served > 0 ? 1000.0 * cpu.GetStats().waitSeconds / cpu.GetStats().served : 0.0)
+              << " ms" << std::endl;
+  }
+  if (links) {
+    links->PrintSummary(std::cout);
+    if (!linkStatsCsv.empty()) std::cout << "Link samples written to: " << linkStatsCsv << std::endl;
+  }
+  if (!snapshotLoad.empty()) {
+    if (cache->GetSnapshotEntriesLoaded() < 0) {
+      std::cout << "Snapshot: could not load " << snapshotLoad << ", cache started cold" << std::endl;
+    } else {
+      std::cout << "Snapshot: warm start with " << cache->GetSnapshotEntriesLoaded() << " entries from "
+                << snapshotLoad << std::endl;
+    }
+  }
+  if (fastForward > 0) {
+    std::cout << "Fast-forward: " << cache->GetDirectRequests() << " requests served without packets before "
+              << fastForward << "s; statistics cover the rest of the run" << std::endl;
+  }
+  {
+    uint64_t lost = 0;
+    uint64_t late = 0;
+    for (const auto& client : clientApps) {
+      lost += client->GetLostRequests();
+      late += client->GetLateResponses();
+    }
+    std::cout << "Timeouts: " << lost << " client requests lost (" << late << " late responses), "
+              << cache->GetOriginTimeouts() << " origin fetches timed out" << std::endl;
+  }
 
-      std::ofstream serviceSummary(serviceSummaryCsv, std::ios::out);
-      serviceSummary << "service,total_requests,cache_hits,cache_misses,hit_rate_percent,avg_latency_ms,min_latency_ms,max_latency_ms,avg_hit_latency_ms,avg_miss_latency_ms\n";
-      for (const auto& pair : serviceStats) {
-        const std::string& service = pair.first;
-        const HttpClientApp::ContentStats& stats = pair.second;
-        double hitRate = (stats.totalRequests > 0) ? (100.0 * stats.cacheHits / stats.totalRequests) : 0.0;
-        double avgLatency = (stats.totalRequests > 0) ? (stats.totalLatency / stats.totalRequests) : 0.0;
-        double avgHitLatency = (stats.cacheHits > 0) ? (stats.totalHitLatency / stats.cacheHits) : 0.0;
-        double avgMissLatency = (stats.cacheMisses > 0) ? (stats.totalMissLatency / stats.cacheMisses) : 0.0;
-        serviceSummary << service << ","
-                       << stats.totalRequests << ","
-                       << stats.cacheHits << ","
-                       << stats.cacheMisses << ","
-                       << hitRate << ","
-                       << avgLatency << ","
-                       << stats.minLatency << ","
-                       << stats.maxLatency << ","
-                       << avgHitLatency << ","
-                       << avgMissLatency << "\n";
-      }
-      serviceSummary.close();
-      std::cout << "Service-level summary written to: " << serviceSummaryCsv << std::endl;
+  if (serviceRateLimit > 0 || clientRateLimit > 0 || originRateLimit > 0) {
+    const auto& ls = cache->GetLimitStats();
+    std::cout << "Rate limiting (" << limitAction << "): " << ls.rejected << " rejected, " << ls.deferred
+              << " deferred, " << ls.stale << " served stale; origin fetches: " << ls.originThrottled
+              << " throttled, " << ls.originDeferred << " deferred" << std::endl;
+    // Per-service view from the clients' side, to see whether shedding one service protected the others
+    std::vector<HttpClientApp::ContentStats> byService = collector->RollupServices();
+    std::vector<uint32_t> rows(byService.size());
+    for (uint32_t s = 0; s < rows.size(); ++s) rows[s] = s;
+    std::sort(rows.begin(), rows.end(), [&byService](uint32_t a, uint32_t b) {
+      return byService[a].totalRequests + byService[a].unavailable > byService[b].totalRequests + byService[b].unavailable;
+    });
+    const auto& shed = cache->GetShedByService();
+    for (size_t i = 0; i < rows.size() && i < 10; ++i) {
+      const auto& st = byService[rows[i]];
+      const std::string& service = collector->GetServiceName(rows[i]);
+      auto it = shed.find(service);
+      std::cout << "  " << service << ": " << st.totalRequests << " served, mean latency " << std::fixed
+                << std::setprecision(2) << (st.totalRequests > 0 ? st.totalLatency / st.totalRequests : 0.0)
+                << " ms, " << (it != shed.end() ? it->second : 0) << " shed by limits, " << st.unavailable
+                << " unavailable" << std::endl;
+    }
+  }
+
+  if (mrc) ReportMrc(0.0);
+  const HttpCacheEngine& engine = cache->GetEngine();
+  if (engine.GetAdmissionFilter().GetMode() != HttpAdmissionFilter::NONE) {
+    std::cout << "Admission (" << admission << "): " << engine.GetAdmissionRejects() << " fills rejected, sketch "
+              << engine.GetAdmissionFilter().GetMemoryBytes() / 1024 << " KiB, "
+              << engine.GetAdmissionFilter().GetAgings() << " agings" << std::endl;
+  }
+  if (engine.IsTieredEnabled()) {
+    uint64_t reqs = engine.GetTotalRequests();
+    const char* names[] = {"RAM", "SSD"};
+    for (auto t : {HttpCacheEngine::RAM, HttpCacheEngine::SSD}) {
+      const auto& ts = engine.GetTierStats(t);
+      std::cout << names[t] << " tier: " << ts.hits << " hits ("
+                << std::fixed << std::setprecision(2) << (reqs > 0 ? 100.0 * ts.hits / reqs : 0.0)
+                << "% of requests), mean read " << std::setprecision(1)
+                << (ts.hits > 0 ? 1e6 * ts.readSeconds / ts.hits : 0.0) << " us, "
+                << ts.objects << " objects / " << ts.bytesUsed / (1024 * 1024) << " MB, "
+                << ts.evictions << " evictions" << std::endl;
+    }
+    const auto& fs = engine.GetFlashStats();
+    std::cout << "Promotions: " << fs.promotions << ", demotions: " << fs.demotions << std::endl;
+    std::cout << "Flash writes: " << fs.logicalBytesWritten / (1024 * 1024) << " MB logical, "
+              << fs.physicalBytesWritten / (1024 * 1024) << " MB physical (WA "
+              << std::setprecision(2) << engine.GetWriteAmplification() << ")" << std::endl;
+  }
+
+  if (partitionMode != HttpCacheEngine::SHARED || serviceStats || !partitionCsv.empty()) {
+    engine.PrintServiceStats(std::cout, "");
+    if (!partitionCsv.empty()) {
+      std::ofstream out(partitionCsv);
+      engine.WriteServiceStats(out);
+    }
+  }
+
+  if (sessions) {
+    const auto& ws = sessions->GetStats();
+    std::cout << "Session workload: " << ws.liveSessions << " live / " << ws.vodSessions << " VoD sessions ("
+              << ws.flashSessions << " flash), " << ws.requests << " requests, "
+              << ws.seeks << " seeks, " << ws.abandons << " abandons, peak "
+              << ws.peakConcurrent << " concurrent" << std::endl;
+  }
+
+  // QoE summary across ABR clients
+  if (!abrApps.empty()) {
+    HttpAbrClientApp::QoeStats total;
+    for (const auto& a : abrApps) {
+      const auto& q = a->GetQoeStats();
+      total.segments += q.segments; total.stalls += q.stalls; total.switches += q.switches;
+      total.timeouts += q.timeouts; total.unavailable += q.unavailable; total.sessions += q.sessions; total.segmentHits += q.segmentHits;
+      total.playSeconds += q.playSeconds; total.stallSeconds += q.stallSeconds;
+      total.startupSeconds += q.startupSeconds; total.bitrateSumKbps += q.bitrateSumKbps;
+      total.clampedSegments += q.clampedSegments;
+    }
+    double watched = total.playSeconds + total.stallSeconds;
+    std::cout << "ABR QoE (" << abrAlgorithm << "):" << std::endl;
+    std::cout << "  Segments: " << total.segments << " (" << std::setprecision(1)
+              << (total.segments > 0 ? 100.0 * total.segmentHits / total.segments : 0.0) << "% cache hits)" << std::endl;
+    std::cout << "  Average bitrate: " << std::setprecision(0)
+              << (total.segments > 0 ? total.bitrateSumKbps / total.segments : 0.0) << " kbps" << std::endl;
+    std::cout << "  Rebuffer ratio: " << std::setprecision(2)
+              << (watched > 0 ? 100.0 * total.stallSeconds / watched : 0.0) << "% ("
+              << total.stalls << " stalls)" << std::endl;
+    std::cout << "  Avg startup delay: " << std::setprecision(3)
+              << (total.sessions > 0 ? total.startupSeconds / total.sessions : 0.0) << "s" << std::endl;
+    std::cout << "  Bitrate switches: " << total.switches << ", timeouts: " << total.timeouts
+              << ", shed and retried: " << total.unavailable << std::endl;
+    if (total.clampedSegments > 0) {
+      std::cout << "  Warning: " << total.clampedSegments << " segments exceeded " << HttpAbrClientApp::kMaxSegmentBytes
+                << " bytes and were clamped; lower --bytesScale" << std::endl;
     }
   }
 
+  // Global and service-level summaries from the shared collector
+  if (!globalSummaryCsv.empty()) {
+    collector->WriteContentCsv(globalSummaryCsv);
+    std::cout << "Global summary written to: " << globalSummaryCsv << " (" << collector->GetNumContent()
+              << " contents)" << std::endl;
+  }
+  if (!serviceSummaryCsv.empty()) {
+    collector->WriteServiceCsv(serviceSummaryCsv);
+    std::cout << "Service-level summary written to: " << serviceSummaryCsv << " (" << collector->GetNumServices()
+              << " services)" << std::endl;
+  }
+
   Simulator::Destroy();
   return 0;
 }
@@ -0,0 +1,239 @@
+#include "http-abr-client-app.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include <algorithm>
+#include <sstream>
+
+namespace ns3 {
+NS_LOG_COMPONENT_DEFINE("HttpAbrClientApp");
+
+TypeId HttpAbrClientApp::GetTypeId() {
+  static TypeId tid = TypeId("ns3::HttpAbrClientApp")
+    .SetParent<HttpClientApp>()
+    .AddConstructor<HttpAbrClientApp>();
+  return tid;
+}
+
+HttpAbrClientApp::HttpAbrClientApp() {
+  // Segments are requested by the ABR loop, services are picked like streaming mode
+  SetExternallyDriven(true);
+  SetStreaming(true);
+}
+
+void HttpAbrClientApp::SetRenditions(const std::vector<uint32_t>& kbps) {
+  if (kbps.empty()) return;
+  m_renditions = kbps;
+  std::sort(m_renditions.begin(), m_renditions.end());
+}
+void HttpAbrClientApp::SetSegmentDuration(Time d) { m_segmentDuration = d; }
+void HttpAbrClientApp::SetAbrAlgorithm(AbrAlgorithm a) { m_algorithm = a; }
+void HttpAbrClientApp::SetMaxBuffer(Time t) { m_maxBuffer = t; }
+void HttpAbrClientApp::SetStartupBuffer(Time t) { m_startupBuffer = t; }
+void HttpAbrClientApp::SetRebufferThreshold(Time t) { m_rebufferThreshold = t; }
+void HttpAbrClientApp::SetBytesScale(double scale) { m_bytesScale = scale > 0 ? scale : 0.05; }
+void HttpAbrClientApp::SetRequestTimeout(Time t) { m_requestTimeout = t; }
+
+std::vector<uint32_t> HttpAbrClientApp::ParseRenditions(const std::string& list) {
+  std::vector<uint32_t> out;
+  std::stringstream ss(list);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (!item.empty()) out.push_back(static_cast<uint32_t>(std::stoul(item)));
+  }
+  return out;
+}
+
+void HttpAbrClientApp::StartApplication() {
+  HttpClientApp::StartApplication();
+  m_lastUpdate = Simulator::Now();
+  StartSession();
+}
+
+void HttpAbrClientApp::StopApplication() {
+  UpdatePlayback();
+  m_requestEvent.Cancel();
+  m_timeoutEvent.Cancel();
+  m_underflowEvent.Cancel();
+  HttpClientApp::StopApplication();
+}
+
+void HttpAbrClientApp::StartSession() {
+  if (Simulator::Now() >= GetTotalTime()) return;
+  m_service = PickService();
+  m_nextSegment = 1;
+  m_lastRendition = -1;
+  m_renditionCap = -1;
+  m_buffer = 0.0;
+  m_started = m_playing = m_stalled = false;
+  m_sessionStart = m_lastUpdate = Simulator::Now();
+  m_qoe.sessions++;
+  NS_LOG_INFO("ABR session start: service-" << m_service);
+  RequestNext();
+}
+
+void HttpAbrClientApp::RequestNext() {
+  if (Simulator::Now() >= GetTotalTime() || m_nextSegment > GetNumSegments()) return;
+
+  uint32_t idx = SelectRendition();
+  if (m_renditionCap >= 0) {
+    idx = std::min(idx, static_cast<uint32_t>(m_renditionCap));
+    m_renditionCap = -1;
+  }
+  m_pendingKbps = m_renditions[idx];
+  if (m_lastRendition >= 0 && static_cast<uint32_t>(m_lastRendition) != idx) m_qoe.switches++;
+  m_lastRendition = static_cast<int32_t>(idx);
+
+  double mediaBytes = m_pendingKbps * 1000.0 / 8.0 * m_segmentDuration.GetSeconds();
+  double scaled = std::max(1.0, mediaBytes * m_bytesScale);
+  uint32_t wireBytes = static_cast<uint32_t>(std::min<double>(scaled, kMaxSegmentBytes));
+  if (scaled > kMaxSegmentBytes) {
+    if (m_qoe.clampedSegments++ == 0) {
+      NS_LOG_WARN("Segment of " << scaled << " bytes exceeds the UDP limit; clamped to " << kMaxSegmentBytes
+                  << " (lower the bytes scale)");
+    }
+  }
+  m_pending = "/service-" + std::to_string(m_service) + "/seg-" + std::to_string(m_nextSegment)
+              + "/r-" + std::to_string(m_pendingKbps);
+  SendRequest(m_pending, wireBytes);
+  m_timeoutEvent.Cancel();
+  m_timeoutEvent = Simulator::Schedule(m_requestTimeout, &HttpAbrClientApp::OnTimeout, this);
+}
+
+void HttpAbrClientApp::OnTimeout() {
+  NS_LOG_INFO("ABR request timed out: " << m_pending);
+  m_qoe.timeouts++;
+  m_pending.clear();
+  // Treat a lost segment as a throughput collapse and retry conservatively
+  m_throughputKbps.clear();
+  RequestNext();
+}
+
+void HttpAbrClientApp::OnUnavailable(const std::string& content) {
+  if (content != m_pending) return; // answer to a request that already timed out
+  NS_LOG_INFO("ABR request shed: " << m_pending);
+  m_timeoutEvent.Cancel();
+  m_qoe.unavailable++;
+  m_pending.clear();
+  if (m_lastRendition > 0) {
+    m_renditionCap = m_lastRendition - 1;
+    RequestNext();
+    return;
+  }
+  // Already at the lowest rendition: back off rather than hammer the server that shed it
+  m_renditionCap = 0;
+  m_requestEvent = Simulator::Schedule(m_segmentDuration, &HttpAbrClientApp::RequestNext, this);
+}
+
+void HttpAbrClientApp::OnResponse(const std::string& content, Time latency, bool hit, uint32_t size) {
+  if (content != m_pending) return; // late response to a timed-out request
+  m_timeoutEvent.Cancel();
+  m_pending.clear();
+
+  double secs = std::max(latency.GetSeconds(), 1e-6);
+  double mediaBits = (size > 0 ? size / m_bytesScale : 0.0) * 8.0;
+  m_throughputKbps.push_back(mediaBits / 1000.0 / secs);
+  while (m_throughputKbps.size() > m_throughputWindow) m_throughputKbps.pop_front();
+
+  UpdatePlayback();
+  m_buffer += m_segmentDuration.GetSeconds();
+  m_nextSegment++;
+  m_qoe.segments++;
+  m_qoe.bitrateSumKbps += m_pendingKbps;
+  if (hit) m_qoe.segmentHits++;
+
+  bool lastSegment = m_nextSegment > GetNumSegments();
+  Time now = Simulator::Now();
+  if (!m_started && (m_buffer >= m_startupBuffer.GetSeconds() || lastSegment)) {
+    m_started = m_playing = true;
+    m_qoe.startupSeconds += (now - m_sessionStart).GetSeconds();
+    NS_LOG_INFO("ABR playback start after " << (now - m_sessionStart).GetSeconds() << "s");
+  } else if (m_stalled && (m_buffer >= m_rebufferThreshold.GetSeconds() || lastSegment)) {
+    m_stalled = false;
+    m_playing = true;
+  }
+  ScheduleUnderflow();
+
+  if (lastSegment) return; // next session starts when playback drains the buffer
+
+  // Keep at most m_maxBuffer of media buffered
+  double excess = m_buffer + m_segmentDuration.GetSeconds() - m_maxBuffer.GetSeconds();
+  if (excess <= 0 || !m_playing) {
+    RequestNext();
+  } else {
+    m_requestEvent = Simulator::Schedule(Seconds(excess), &HttpAbrClientApp::RequestNext, this);
+  }
+}
+
+void HttpAbrClientApp::UpdatePlayback() {
+  Time now = Simulator::Now();
+  double dt = (now - m_lastUpdate).GetSeconds();
+  if (m_playing) {
+    double played = std::min(dt, m_buffer);
+    m_buffer -= played;
+    m_qoe.playSeconds += played;
+  } else if (m_stalled) {
+    m_qoe.stallSeconds += dt;
+  }
+  m_lastUpdate = now;
+}
+
+void HttpAbrClientApp::ScheduleUnderflow() {
+  m_underflowEvent.Cancel();
+  if (m_playing) {
+    m_underflowEvent = Simulator::Schedule(Seconds(m_buffer), &HttpAbrClientApp::OnUnderflow, this);
+  }
+}
+
+void HttpAbrClientApp::OnUnderflow() {
+  UpdatePlayback();
+  m_buffer = 0.0;
+  m_playing = false;
+  if (m_nextSegment > GetNumSegments() && m_pending.empty()) {
+    StartSession(); // played to the end
+    return;
+  }
+  m_stalled = true;
+  m_qoe.stalls++;
+  NS_LOG_INFO("ABR stall on service-" << m_service << " seg-" << m_nextSegment);
+}
+
+double HttpAbrClientApp::EstimateThroughputKbps() const {
+  // Harmonic mean of recent samples: robust against single fast downloads
+  if (m_throughputKbps.empty()) return 0.0;
+  double inv = 0.0;
+  for (double t : m_throughputKbps) inv += 1.0 / std::max(t, 1e-3);
+  return m_throughputKbps.size() / inv;
+}
+
+uint32_t HttpAbrClientApp::SelectRendition() const {
+  const uint32_t n = static_cast<uint32_t>(m_renditions.size());
+
+  uint32_t byThroughput = 0;
+  double budget = m_safetyFactor * EstimateThroughputKbps();
+  for (uint32_t i = 0; i < n; ++i) {
+    if (m_renditions[i] <= budget) byThroughput = i;
+  }
+
+  double reservoir = 0.2 * m_maxBuffer.GetSeconds();
+  double cushion = 0.6 * m_maxBuffer.GetSeconds();
+  uint32_t byBuffer = 0;
+  if (m_buffer >= reservoir + cushion) {
+    byBuffer = n - 1;
+  } else if (m_buffer > reservoir) {
+    double target = m_renditions.front()
+                    + (m_renditions.back() - m_renditions.front()) * (m_buffer - reservoir) / cushion;
+    for (uint32_t i = 0; i < n; ++i) {
+      if (m_renditions[i] <= target) byBuffer = i;
+    }
+  }
+
+  switch (m_algorithm) {
+    case THROUGHPUT: return byThroughput;
+    case BUFFER: return byBuffer;
+    case HYBRID:
+    default:
+      return (m_buffer < reservoir + cushion) ? std::min(byThroughput, byBuffer) : byThroughput;
+  }
+}
+
+} // namespace ns3
@@ -0,0 +1,131 @@
+#pragma once
+#include "http-client-app.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Adaptive bitrate streaming client
+ *
+ * Picks a service like HttpClientApp's streaming mode, then downloads its
+ * segments back to back into a playback buffer instead of at a fixed
+ * interval. Each segment exists in several renditions; the rendition is
+ * encoded in the resource name as "/service-X/seg-Y/r-<kbps>" and its size
+ * (bitrate x segment duration) is carried in the request, so cache and origin
+ * store and serve per-rendition objects.
+ *
+ * Playback starts once the startup buffer is filled. When the buffer runs
+ * dry the player stalls until the rebuffer threshold is reached again; stall
+ * count and duration, startup delay, average bitrate and switches are
+ * reported as QoE metrics.
+ */
+class HttpAbrClientApp : public HttpClientApp {
+public:
+  enum AbrAlgorithm {
+    THROUGHPUT, ///< highest rendition below a safety fraction of measured throughput
+    BUFFER,     ///< buffer-based (BBA): map buffer level between reservoir and cushion to bitrate
+    HYBRID      ///< throughput-based, capped by the buffer-based choice while the buffer is low
+  };
+
+  struct QoeStats {
+    uint32_t segments = 0;        ///< segments downloaded
+    uint32_t stalls = 0;          ///< rebuffering events after startup
+    uint32_t switches = 0;        ///< rendition changes between consecutive segments
+    uint32_t timeouts = 0;        ///< segment requests that got no response
+    uint32_t unavailable = 0;     ///< segment requests shed upstream, then retried
+    uint32_t sessions = 0;
+    double playSeconds = 0.0;     ///< media time played out
+    double stallSeconds = 0.0;    ///< time spent rebuffering after startup
+    double startupSeconds = 0.0;  ///< summed startup delays over all sessions
+    double bitrateSumKbps = 0.0;  ///< sum of selected bitrates, per segment
+    uint32_t segmentHits = 0;     ///< segments served by the cache
+    uint32_t clampedSegments = 0; ///< segments cut to kMaxSegmentBytes on the wire
+  };
+
+  /// Largest segment payload sent, leaving room for the HTTP header within one UDP datagram
+  static constexpr uint32_t kMaxSegmentBytes = 60000;
+
+  static TypeId GetTypeId();
+  HttpAbrClientApp();
+
+  /// Available bitrates in kbps (sorted ascending internally)
+  void SetRenditions(const std::vector<uint32_t>& kbps);
+  /// Media duration of one segment
+  void SetSegmentDuration(Time d);
+  void SetAbrAlgorithm(AbrAlgorithm a);
+  /// Buffer level (media time) at which downloads pause
+  void SetMaxBuffer(Time t);
+  /// Buffer needed before playback starts
+  void SetStartupBuffer(Time t);
+  /// Buffer needed before playback resumes after a stall
+  void SetRebufferThreshold(Time t);
+  /**
+   * \brief Wire bytes per media byte, to keep segment sizes within a UDP datagram
+   *
+   * The default 0.05 keeps a 2 s segment of up to ~4.8 Mbps below
+   * kMaxSegmentBytes; larger segments are clamped to it.
+   */
+  void SetBytesScale(double scale);
+  void SetRequestTimeout(Time t);
+
+  const QoeStats& GetQoeStats() const { return m_qoe; }
+
+  /// Parse a comma-separated rendition ladder such as "300,750,1500"
+  static std::vector<uint32_t> ParseRenditions(const std::string& list);
+
+protected:
+  void StartApplication() override;
+  void StopApplication() override;
+  void OnResponse(const std::string& content, Time latency, bool hit, uint32_t size) override;
+  /// Retry a shed segment at once one rendition lower, or after a segment duration at the lowest
+  void OnUnavailable(const std::string& content) override;
+
+private:
+  void StartSession();
+  void RequestNext();
+  void OnTimeout();
+  void OnUnderflow();
+  void UpdatePlayback();
+  void ScheduleUnderflow();
+  uint32_t SelectRendition() const;
+  double EstimateThroughputKbps() const;
+
+  std::vector<uint32_t> m_renditions{300, 750, 1500, 3000};
+  Time m_segmentDuration{Seconds(2)};
+  AbrAlgorithm m_algorithm = HYBRID;
+  Time m_maxBuffer{Seconds(30)};
+  Time m_startupBuffer{Seconds(4)};
+  Time m_rebufferThreshold{Seconds(4)};
+  double m_bytesScale = 0.05;
+  Time m_requestTimeout{Seconds(10)};
+  double m_safetyFactor = 0.9;
+  uint32_t m_throughputWindow = 5;
+
+  // session state
+  uint32_t m_service = 0;
+  uint32_t m_nextSegment = 1;
+  std::string m_pending;       ///< resource of the outstanding request
+  uint32_t m_pendingKbps = 0;
+  int32_t m_lastRendition = -1;
+  int32_t m_renditionCap = -1; ///< highest rendition for the next request after a shed one (-1 = none)
+  EventId m_requestEvent;
+  EventId m_timeoutEvent;
+
+  // playback state
+  double m_buffer = 0.0;       ///< seconds of media buffered
+  Time m_lastUpdate;
+  Time m_sessionStart;
+  bool m_started = false;      ///< playback has started in this session
+  bool m_playing = false;
+  bool m_stalled = false;
+  EventId m_underflowEvent;
+
+  std::deque<double> m_throughputKbps; ///< recent per-segment throughput samples
+  QoeStats m_qoe;
+};
+
+} // namespace ns3
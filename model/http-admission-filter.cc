@@ -0,0 +1,181 @@
+#include "http-admission-filter.h"
+#include "ns3/log.h"
+#include <algorithm>
+#include <functional>
+
+namespace ns3 {
+NS_LOG_COMPONENT_DEFINE("HttpAdmissionFilter");
+
+namespace {
+
+uint64_t Mix(uint64_t x) {
+  // splitmix64 finalizer: spreads std::hash output over all 64 bits
+  x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+uint64_t RoundUpPow2(uint64_t n) {
+  uint64_t p = 1;
+  while (p < n) p <<= 1;
+  return p;
+}
+
+/// i-th probe position by double hashing (Kirsch-Mitzenmacher)
+uint64_t Probe(uint64_t hash, uint32_t i) {
+  uint64_t h2 = (hash >> 32) | 1;
+  return hash + i * h2;
+}
+
+} // namespace
+
+uint64_t HttpKeyHash(const std::string& key) {
+  return Mix(std::hash<std::string>()(key));
+}
+
+void HttpBloomFilter::Resize(uint64_t items, uint32_t bitsPerItem, uint32_t hashes) {
+  uint64_t bits = RoundUpPow2(std::max<uint64_t>(64, items * bitsPerItem));
+  m_bits.assign(bits / 64, 0);
+  m_mask = bits - 1;
+  m_hashes = std::max(1u, hashes);
+}
+
+void HttpBloomFilter::Add(uint64_t hash) {
+  for (uint32_t i = 0; i < m_hashes; ++i) {
+    uint64_t bit = Probe(hash, i) & m_mask;
+    m_bits[bit >> 6] |= 1ULL << (bit & 63);
+  }
+}
+
+bool HttpBloomFilter::Contains(uint64_t hash) const {
+  if (m_bits.empty()) return false;
+  for (uint32_t i = 0; i < m_hashes; ++i) {
+    uint64_t bit = Probe(hash, i) & m_mask;
+    if (!(m_bits[bit >> 6] & (1ULL << (bit & 63)))) return false;
+  }
+  return true;
+}
+
+void HttpBloomFilter::Clear() { std::fill(m_bits.begin(), m_bits.end(), 0); }
+
+void HttpCountMinSketch::Resize(uint64_t items) {
+  // One 4-bit counter per expected item in each row, 16 counters per word
+  m_rowWords = RoundUpPow2(std::max<uint64_t>(1, items / 16));
+  m_table.assign(kDepth * m_rowWords, 0);
+}
+
+void HttpCountMinSketch::Locate(uint64_t hash, uint32_t row, size_t* word, uint32_t* shift) const {
+  uint64_t slot = Mix(hash + row * 0x9e3779b97f4a7c15ULL) & (m_rowWords * 16 - 1);
+  *word = row * m_rowWords + (slot >> 4);
+  *shift = static_cast<uint32_t>(slot & 15) * 4;
+}
+
+void HttpCountMinSketch::Increment(uint64_t hash) {
+  if (m_table.empty()) return;
+  // Conservative update: only raise the counters that hold the current minimum
+  uint32_t min = Estimate(hash);
+  if (min >= 15) return;
+  for (uint32_t r = 0; r < kDepth; ++r) {
+    size_t w; uint32_t s;
+    Locate(hash, r, &w, &s);
+    if (((m_table[w] >> s) & 0xf) == min) m_table[w] += 1ULL << s;
+  }
+}
+
+uint32_t HttpCountMinSketch::Estimate(uint64_t hash) const {
+  if (m_table.empty()) return 0;
+  uint32_t min = 15;
+  for (uint32_t r = 0; r < kDepth; ++r) {
+    size_t w; uint32_t s;
+    Locate(hash, r, &w, &s);
+    min = std::min(min, static_cast<uint32_t>((m_table[w] >> s) & 0xf));
+  }
+  return min;
+}
+
+void HttpCountMinSketch::Halve() {
+  // Shift every nibble right by one; the mask drops bits that crossed nibbles
+  for (auto& w : m_table) w = (w >> 1) & 0x7777777777777777ULL;
+}
+
+void HttpCountMinSketch::Clear() { std::fill(m_table.begin(), m_table.end(), 0); }
+
+void HttpAdmissionFilter::Configure(Mode mode, uint64_t expectedItems, uint64_t sampleSize) {
+  m_mode = mode;
+  m_recorded = 0;
+  m_agings = 0;
+  if (mode == NONE) {
+    m_sketch = HttpCountMinSketch();
+    m_doorkeeper = HttpBloomFilter();
+    return;
+  }
+  expectedItems = std::max<uint64_t>(expectedItems, 16);
+  m_sketch.Resize(expectedItems);
+  m_doorkeeper.Resize(expectedItems);
+  m_sampleSize = sampleSize > 0 ? sampleSize : 10 * expectedItems;
+}
+
+bool HttpAdmissionFilter::ParseMode(const std::string& name, Mode* mode) {
+  if (name == "none") { *mode = NONE; return true; }
+  if (name == "second-hit") { *mode = SECOND_HIT; return true; }
+  if (name == "frequency") { *mode = FREQUENCY; return true; }
+  return false;
+}
+
+void HttpAdmissionFilter::Record(const std::string& key) {
+  if (m_mode == NONE) return;
+  uint64_t h = HttpKeyHash(key);
+  if (m_doorkeeper.Contains(h)) {
+    m_sketch.Increment(h);
+  } else {
+    m_doorkeeper.Add(h);
+  }
+  if (++m_recorded >= m_sampleSize) {
+    m_sketch.Halve();
+    m_doorkeeper.Clear();
+    m_recorded = 0;
+    m_agings++;
+    NS_LOG_INFO("Admission filter aged (" << m_agings << ")");
+  }
+}
+
+uint32_t HttpAdmissionFilter::Frequency(const std::string& key) const {
+  uint64_t h = HttpKeyHash(key);
+  return m_sketch.Estimate(h) + (m_doorkeeper.Contains(h) ? 1 : 0);
+}
+
+std::vector<uint64_t> HttpAdmissionFilter::SaveState() const {
+  std::vector<uint64_t> words;
+  if (m_mode == NONE) return words;
+  const auto& sketch = m_sketch.GetWords();
+  const auto& door = m_doorkeeper.GetWords();
+  words.reserve(1 + sketch.size() + door.size());
+  words.push_back(m_recorded);
+  words.insert(words.end(), sketch.begin(), sketch.end());
+  words.insert(words.end(), door.begin(), door.end());
+  return words;
+}
+
+bool HttpAdmissionFilter::RestoreState(const std::vector<uint64_t>& words) {
+  auto& sketch = m_sketch.GetWords();
+  auto& door = m_doorkeeper.GetWords();
+  if (m_mode == NONE || words.size() != 1 + sketch.size() + door.size()) return false;
+  m_recorded = words[0];
+  std::copy(words.begin() + 1, words.begin() + 1 + sketch.size(), sketch.begin());
+  std::copy(words.begin() + 1 + sketch.size(), words.end(), door.begin());
+  return true;
+}
+
+bool HttpAdmissionFilter::Admit(const std::string& key, const std::string* victim) const {
+  switch (m_mode) {
+    case SECOND_HIT:
+      return Frequency(key) >= 2;
+    case FREQUENCY:
+      return !victim || Frequency(key) > Frequency(*victim);
+    case NONE:
+    default:
+      return true;
+  }
+}
+
+} // namespace ns3
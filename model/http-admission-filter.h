@@ -0,0 +1,111 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/// 64-bit key hash shared by the probabilistic structures below
+uint64_t HttpKeyHash(const std::string& key);
+
+/**
+ * \brief Bloom filter over hashed keys with k probes derived by double hashing
+ */
+class HttpBloomFilter {
+public:
+  /// Size for \p items entries at \p bitsPerItem bits each (rounded up to a power of two)
+  void Resize(uint64_t items, uint32_t bitsPerItem = 8, uint32_t hashes = 4);
+  void Add(uint64_t hash);
+  bool Contains(uint64_t hash) const;
+  void Clear();
+  size_t GetMemoryBytes() const { return m_bits.size() * sizeof(uint64_t); }
+  bool IsEmpty() const { return m_bits.empty(); }
+  /// Raw bit words, for snapshots
+  const std::vector<uint64_t>& GetWords() const { return m_bits; }
+  std::vector<uint64_t>& GetWords() { return m_bits; }
+
+private:
+  std::vector<uint64_t> m_bits;
+  uint64_t m_mask = 0;
+  uint32_t m_hashes = 4;
+};
+
+/**
+ * \brief Count-Min sketch with 4-bit saturating counters and periodic halving
+ */
+class HttpCountMinSketch {
+public:
+  /// Size for roughly \p items distinct keys (width rounded up to a power of two)
+  void Resize(uint64_t items);
+  void Increment(uint64_t hash);
+  uint32_t Estimate(uint64_t hash) const;
+  /// Halve every counter (aging)
+  void Halve();
+  void Clear();
+  size_t GetMemoryBytes() const { return m_table.size() * sizeof(uint64_t); }
+  /// Raw counter words, for snapshots
+  const std::vector<uint64_t>& GetWords() const { return m_table; }
+  std::vector<uint64_t>& GetWords() { return m_table; }
+
+private:
+  static constexpr uint32_t kDepth = 4;
+  /// Word index and nibble offset of the counter for \p hash in row \p row
+  void Locate(uint64_t hash, uint32_t row, size_t* word, uint32_t* shift) const;
+
+  std::vector<uint64_t> m_table; ///< kDepth rows of 16 nibbles per word
+  uint64_t m_rowWords = 0;
+};
+
+/**
+ * \brief TinyLFU-style admission filter for cache insertions
+ *
+ * Every request is recorded. First occurrences only set a doorkeeper Bloom
+ * filter bit; repeated ones increment a Count-Min sketch, so one-hit wonders
+ * never reach the sketch. After sampleSize recorded requests all counters are
+ * halved and the doorkeeper is cleared, so popularity estimates decay over
+ * time. Memory is fixed when the filter is configured.
+ *
+ * - SECOND_HIT admits an object only if it was requested before.
+ * - FREQUENCY admits it only if its estimated frequency beats that of the
+ *   eviction victim it would replace (always when no eviction is needed).
+ */
+class HttpAdmissionFilter {
+public:
+  enum Mode { NONE, SECOND_HIT, FREQUENCY };
+
+  /**
+   * \param expectedItems distinct keys to size the structures for
+   * \param sampleSize requests between agings (0 = 10 x expectedItems)
+   */
+  void Configure(Mode mode, uint64_t expectedItems, uint64_t sampleSize = 0);
+  Mode GetMode() const { return m_mode; }
+
+  void Record(const std::string& key);
+  /// Estimated request count within the current aging period
+  uint32_t Frequency(const std::string& key) const;
+  /**
+   * \brief Decide whether a missed object may enter the cache
+   * \param victim key that would be evicted, or nullptr if there is room
+   */
+  bool Admit(const std::string& key, const std::string* victim) const;
+
+  size_t GetMemoryBytes() const { return m_sketch.GetMemoryBytes() + m_doorkeeper.GetMemoryBytes(); }
+  uint64_t GetAgings() const { return m_agings; }
+
+  /// Frequency state as raw words: requests since the last aging, then sketch and doorkeeper words
+  std::vector<uint64_t> SaveState() const;
+  /// Restore SaveState() output; returns false (leaving the filter unchanged) if the sizes differ
+  bool RestoreState(const std::vector<uint64_t>& words);
+
+  static bool ParseMode(const std::string& name, Mode* mode);
+
+private:
+  Mode m_mode = NONE;
+  HttpCountMinSketch m_sketch;
+  HttpBloomFilter m_doorkeeper;
+  uint64_t m_sampleSize = 0;
+  uint64_t m_recorded = 0;
+  uint64_t m_agings = 0;
+};
+
+} // namespace ns3
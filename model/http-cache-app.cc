@@ -5,6 +5,8 @@
 #include "ns3/udp-socket-factory.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/simulator.h"
+#include <algorithm>
+#include <chrono>
 
 namespace ns3 {
 NS_LOG_COMPONENT_DEFINE("HttpCacheApp");
@@ -19,107 +21,213 @@ TypeId HttpCacheApp::GetTypeId(){
 HttpCacheApp::HttpCacheApp() = default;
 void HttpCacheApp::SetListenPort(uint16_t p){ m_listenPort = p; }
 void HttpCacheApp::SetOrigin(Address a, uint16_t p){ m_originAddr = a; m_originPort = p; }
-void HttpCacheApp::SetTtl(Time t){ m_ttl = t; }
-void HttpCacheApp::SetCapacity(uint32_t c){ m_capacity = c; }
+void HttpCacheApp::SetTtl(Time t){ m_engine.SetTtl(t); }
+void HttpCacheApp::SetCapacity(uint32_t c){ m_engine.SetCapacity(c); }
 void HttpCacheApp::SetCacheDelay(Time t){ m_cacheDelay = t; }
+void HttpCacheApp::SetMissCost(Time t){ m_missCost = t; }
+void HttpCacheApp::SetOverflowReject(bool reject){ m_overflowReject = reject; }
 void HttpCacheApp::SetObjectSize(uint32_t size) {
   m_objectSize = size;
 }
 
+void HttpCacheApp::SetHeaderSizes(uint32_t requestBytes, uint32_t responseBytes){
+  m_requestHeaderBytes = requestBytes;
+  m_responseHeaderBytes = responseBytes;
+}
+
 void HttpCacheApp::SetDynamicTtlEnabled(bool enabled) {
-  m_dynamicTtlEnabled = enabled;
+  m_engine.SetDynamicTtlEnabled(enabled);
 }
 
 void HttpCacheApp::SetTtlWindow(Time window) {
-  m_ttlWindow = window;
+  m_engine.SetTtlWindow(window);
 }
 
 void HttpCacheApp::SetTtlThreshold(double threshold) {
-  m_ttlThreshold = threshold;
+  m_engine.SetTtlThreshold(threshold);
 }
 
 void HttpCacheApp::SetTtlReduction(double reduction) {
-  m_ttlReduction = reduction;
+  m_engine.SetTtlReduction(reduction);
 }
 
 void HttpCacheApp::SetTtlEvalInterval(Time interval) {
-  m_ttlEvalInterval = interval;
+  m_engine.SetTtlEvalInterval(interval);
+}
+
+void HttpCacheApp::SetBatching(Time window, uint32_t maxKeys) {
+  m_batchWindow = window;
+  m_batchMaxKeys = std::max(1u, maxKeys);
 }
 
-std::string HttpCacheApp::ExtractService(const std::string& resource) {
-  // Parse "/service-X/seg-Y" -> "service-X"
-  // Or "/service-X" -> "service-X"
-  if (resource.empty()) return "";
+void HttpCacheApp::SetChunkSize(uint32_t bytes){ m_chunkSize = bytes; }
 
-  size_t start = (resource[0] == '/') ? 1 : 0;
-  size_t end = resource.find('/', start);
+void HttpCacheApp::SetOriginBatchPort(uint16_t p){ m_originBatchPort = p; }
+void HttpCacheApp::SetOriginTimeout(Time t){ m_originTimeout = t; }
 
-  if (end == std::string::npos) {
-    return resource.substr(start);
-  }
-  return resource.substr(start, end - start);
+void HttpCacheApp::SetServiceRateLimit(double rate, double burst){ m_serviceLimiter.Configure(rate, burst); }
+void HttpCacheApp::SetClientRateLimit(double rate, double burst){ m_clientLimiter.Configure(rate, burst); }
+void HttpCacheApp::SetOriginRateLimit(double rate, double burst){ m_originLimiter.Configure(rate, burst); }
+
+void HttpCacheApp::SetLimitAction(LimitAction action, Time maxDefer){
+  m_limitAction = action;
+  m_maxDefer = maxDefer;
 }
 
-void HttpCacheApp::RecordRequest(const std::string& service) {
-  if (!m_dynamicTtlEnabled || service.empty()) return;
+bool HttpCacheApp::ParseLimitAction(const std::string& name, LimitAction* action) {
+  if (name == "reject") { *action = LIMIT_REJECT; return true; }
+  if (name == "defer") { *action = LIMIT_DEFER; return true; }
+  if (name == "stale") { *action = LIMIT_STALE; return true; }
+  return false;
+}
 
-  Time now = Simulator::Now();
+void HttpCacheApp::AddSibling(Address addr){ m_siblings.push_back(addr); }
 
-  // Create new bucket if needed
-  if (m_buckets.empty() || (now - m_buckets.back().startTime) >= m_bucketDuration) {
-    TimeBucket bucket;
-    bucket.startTime = now;
-    m_buckets.push_back(bucket);
-  }
+void HttpCacheApp::SetSiblingPorts(uint16_t lookupPort, uint16_t digestPort){
+  m_siblingPort = lookupPort;
+  m_digestPort = digestPort;
+}
 
-  // Increment count for this service in current bucket
-  m_buckets.back().serviceRequests[service]++;
+void HttpCacheApp::SetDigest(Time interval, uint32_t bitsPerItem, uint32_t hashes){
+  m_digestInterval = interval;
+  m_digestBitsPerItem = std::max(1u, bitsPerItem);
+  m_digestHashes = std::max(1u, hashes);
 }
 
-Time HttpCacheApp::GetEffectiveTtl(const std::string& service) {
-  if (!m_dynamicTtlEnabled) return m_ttl;
+void HttpCacheApp::SetSiblingTimeout(Time t){ m_siblingTimeout = t; }
 
-  if (m_penalizedServices.count(service) > 0) {
-    return m_ttl * (1.0 - m_ttlReduction);
-  }
-  return m_ttl;
+void HttpCacheApp::SetVersionOracle(Callback<uint32_t, const std::string&> oracle){ m_versionOracle = oracle; }
+
+void HttpCacheApp::SetPurgePort(uint16_t p){ m_purgePort = p; }
+void HttpCacheApp::SetPurgeStormWindow(Time t){ m_stormWindow = t; }
+
+void HttpCacheApp::SchedulePurge(Time at, HttpPurgeHeader::Scope scope, const std::string& target){
+  m_purgeSchedule.push_back(ScheduledPurge{at, scope, target});
 }
 
-void HttpCacheApp::EvaluatePolicy() {
-  if (!m_dynamicTtlEnabled) return;
+bool HttpCacheApp::ParsePurgeScope(const std::string& name, HttpPurgeHeader::Scope* scope) {
+  if (name == "key") { *scope = HttpPurgeHeader::KEY; return true; }
+  if (name == "prefix") { *scope = HttpPurgeHeader::PREFIX; return true; }
+  if (name == "service") { *scope = HttpPurgeHeader::SERVICE; return true; }
+  return false;
+}
 
-  Time now = Simulator::Now();
-  Time cutoff = now - m_ttlWindow;
+size_t HttpCacheApp::Purge(HttpPurgeHeader::Scope scope, const std::string& target){
+  ApplyPurge(scope, target, Time(0));
+  return m_purges.back().objects;
+}
 
-  // 1. Prune old buckets outside the window
-  while (!m_buckets.empty() && m_buckets.front().startTime < cutoff) {
-    m_buckets.pop_front();
+void HttpCacheApp::ApplyPurge(HttpPurgeHeader::Scope scope, std::string target, Time delay){
+  PurgeRecord rec;
+  rec.at = Simulator::Now();
+  rec.delay = delay;
+  rec.scope = scope;
+  rec.target = target;
+  uint64_t examined = m_engine.GetPurgeStats().examined;
+  auto wallStart = std::chrono::steady_clock::now();
+  switch (scope) {
+    case HttpPurgeHeader::KEY:
+      rec.objects = m_engine.PurgeKey(target);
+      // Chunk keys are the object key, "#" and the chunk index (ChunkKey()), so they form one prefix
+      if (m_chunkSize > 0) rec.objects += m_engine.PurgePrefix(target + "#");
+      break;
+    case HttpPurgeHeader::PREFIX:
+      rec.objects = m_engine.PurgePrefix(target);
+      break;
+    case HttpPurgeHeader::SERVICE:
+      rec.objects = m_engine.PurgeService(target);
+      break;
   }
-
-  // 2. Aggregate requests per service
-  std::unordered_map<std::string, uint32_t> totals;
-  uint32_t grandTotal = 0;
-  for (const auto& bucket : m_buckets) {
-    for (const auto& pair : bucket.serviceRequests) {
-      totals[pair.first] += pair.second;
-      grandTotal += pair.second;
+  rec.wallMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - wallStart).count();
+  rec.examined = m_engine.GetPurgeStats().examined - examined;
+  // Answers already on their way carry pre-purge content; waiting clients still get them, the cache does not
+  m_fetches.ForEach([&](uint32_t, OriginFetch& f) {
+    if (!f.purged && PurgeMatches(scope, target, *f.key)) {
+      f.purged = true;
+      rec.inFlight++;
+    }
+  });
+  m_lookups.ForEach([&](uint32_t, SiblingLookup& l) {
+    if (!l.purged && PurgeMatches(scope, target, *l.key)) {
+      l.purged = true;
+      rec.inFlight++;
     }
+  });
+  NS_LOG_INFO("PURGE: " << target << " removed " << rec.objects << " objects (" << rec.examined << " keys examined)");
+  m_purges.push_back(rec);
+  Simulator::Schedule(m_stormWindow, &HttpCacheApp::CloseStormWindow, this, m_purges.size() - 1, m_originKeys);
+}
+
+bool HttpCacheApp::PurgeMatches(HttpPurgeHeader::Scope scope, const std::string& target, const std::string& key) const {
+  switch (scope) {
+    case HttpPurgeHeader::KEY:
+      return key == target || (m_chunkSize > 0 && key.size() > target.size() && key.compare(0, target.size(), target) == 0
+                               && key[target.size()] == '#');
+    case HttpPurgeHeader::PREFIX:
+      return key.compare(0, target.size(), target) == 0;
+    case HttpPurgeHeader::SERVICE:
+      return !target.empty() && HttpCacheEngine::ExtractService(key) == target;
   }
+  return false;
+}
 
-  // 3. Determine penalized services
-  m_penalizedServices.clear();
-  if (grandTotal > 0) {
-    for (const auto& pair : totals) {
-      double share = static_cast<double>(pair.second) / grandTotal;
-      if (share > m_ttlThreshold) {
-        m_penalizedServices.insert(pair.first);
-        NS_LOG_INFO("Dynamic TTL: service " << pair.first << " penalized (share=" << share << ")");
-      }
+void HttpCacheApp::CloseStormWindow(size_t index, uint64_t originKeysAtPurge){
+  m_purges[index].stormFetches = m_originKeys - originKeysAtPurge;
+}
+
+void HttpCacheApp::HandlePurgeRead(Ptr<Socket> sock){
+  Address from; Ptr<Packet> p;
+  while ((p = sock->RecvFrom(from))){
+    HttpPurgeHeader hdr; p->RemoveHeader(hdr);
+    ApplyPurge(hdr.GetScope(), hdr.GetTarget(), Simulator::Now() - NanoSeconds(hdr.GetSentNs()));
+  }
+}
+
+void HttpCacheApp::SetSnapshotLoad(const std::string& path){ m_snapshotLoadPath = path; }
+
+void HttpCacheApp::SetSnapshotSave(const std::string& path, Time at){
+  m_snapshotSavePath = path;
+  m_snapshotSaveAt = at;
+}
+
+void HttpCacheApp::SaveSnapshot(){
+  m_engine.SaveSnapshot(m_snapshotSavePath, Simulator::Now());
+}
+
+void HttpCacheApp::SetFastForward(Time until){ m_fastForwardUntil = until; }
+
+bool HttpCacheApp::ServeDirect(std::string key, uint32_t sizeHint, uint32_t rangeStart, uint32_t rangeLength){
+  Time now = Simulator::Now();
+  m_directRequests++;
+  uint32_t size = sizeHint > 0 ? sizeHint : m_objectSize;
+  if (m_chunkSize > 0) {
+    // Only the chunks the range covers, as ProcessRange() would fetch them
+    uint32_t first = 0, last = 0;
+    CoveredChunks(size, rangeStart, rangeLength, &first, &last);
+    bool hit = true;
+    for (uint32_t c = first; c <= last; ++c) {
+      std::string chunk = ChunkKey(key, c);
+      if (m_engine.Access(chunk, now) == HttpCacheEngine::HIT) continue;
+      m_engine.Insert(chunk, std::min(m_chunkSize, size - c * m_chunkSize), now);
+      hit = false;
     }
+    return hit;
   }
+  if (m_engine.Access(key, now) == HttpCacheEngine::HIT) return true;
+  m_engine.Insert(key, size, now);
+  return false;
+}
 
-  // 4. Schedule next evaluation
-  Simulator::Schedule(m_ttlEvalInterval, &HttpCacheApp::EvaluatePolicy, this);
+void HttpCacheApp::EndFastForward(){
+  NS_LOG_INFO("Fast-forward ended after " << m_directRequests << " direct requests, " << m_engine.GetSize()
+              << " objects cached");
+  m_engine.ResetStats();
+}
+
+void HttpCacheApp::EvaluatePolicy() {
+  if (!m_engine.IsDynamicTtlEnabled()) return;
+  m_engine.EvaluatePolicy(Simulator::Now());
+  Simulator::Schedule(m_engine.GetTtlEvalInterval(), &HttpCacheApp::EvaluatePolicy, this);
 }
 
 void HttpCacheApp::StartApplication(){
@@ -132,41 +240,63 @@ void HttpCacheApp::StartApplication(){
   m_originSock->Connect(InetSocketAddress(Ipv4Address::ConvertFrom(m_originAddr), m_originPort));
   m_originSock->SetRecvCallback(MakeCallback(&HttpCacheApp::HandleOriginRead, this));
 
-  // Start dynamic TTL policy evaluation if enabled
-  if (m_dynamicTtlEnabled) {
-    Simulator::Schedule(m_ttlEvalInterval, &HttpCacheApp::EvaluatePolicy, this);
+  if (!m_siblings.empty()) {
+    m_siblingListenSock = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+    m_siblingListenSock->Bind(InetSocketAddress(Ipv4Address::GetAny(), m_siblingPort));
+    m_siblingListenSock->SetRecvCallback(MakeCallback(&HttpCacheApp::HandleSiblingLookup, this));
+
+    m_siblingSock = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+    m_siblingSock->Bind();
+    m_siblingSock->SetRecvCallback(MakeCallback(&HttpCacheApp::HandleSiblingRead, this));
+
+    m_digestSock = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+    m_digestSock->Bind(InetSocketAddress(Ipv4Address::GetAny(), m_digestPort));
+    m_digestSock->SetRecvCallback(MakeCallback(&HttpCacheApp::HandleDigestRead, this));
+    m_digestEvent = Simulator::Schedule(m_digestInterval, &HttpCacheApp::SendDigest, this);
   }
-}
-void HttpCacheApp::StopApplication(){ if (m_clientSock) m_clientSock->Close(); if (m_originSock) m_originSock->Close(); }
 
-void HttpCacheApp::Touch(const std::string& key){
-  auto it = m_map.find(key);
-  if (it == m_map.end()) return;
+  if (m_purgePort != 0) {
+    m_purgeSock = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+    m_purgeSock->Bind(InetSocketAddress(Ipv4Address::GetAny(), m_purgePort));
+    m_purgeSock->SetRecvCallback(MakeCallback(&HttpCacheApp::HandlePurgeRead, this));
+  }
+  for (const ScheduledPurge& sp : m_purgeSchedule) {
+    Time delay = std::max(Time(0), sp.at - Simulator::Now());
+    Simulator::Schedule(delay, &HttpCacheApp::ApplyPurge, this, sp.scope, sp.target, Time(0));
+  }
 
-  // Update LRU position
-  m_lru.erase(it->second.it);
-  m_lru.push_front(key);
-  it->second.it = m_lru.begin();
+  if (!m_snapshotLoadPath.empty()) {
+    m_snapshotLoaded = m_engine.LoadSnapshot(m_snapshotLoadPath, Simulator::Now());
+  }
+  if (m_fastForwardUntil > Simulator::Now()) {
+    Simulator::Schedule(m_fastForwardUntil - Simulator::Now(), &HttpCacheApp::EndFastForward, this);
+  }
+  if (!m_snapshotSavePath.empty()) {
+    Time delay = std::max(Time(0), m_snapshotSaveAt - Simulator::Now());
+    m_snapshotEvent = Simulator::Schedule(delay, &HttpCacheApp::SaveSnapshot, this);
+  }
 
-  // Refresh TTL on access
-  std::string service = ExtractService(key);
-  Time oldExpiry = it->second.expiry;
-  Time newTtl = GetEffectiveTtl(service);
-  it->second.expiry = Simulator::Now() + newTtl;
-  NS_LOG_INFO("TOUCH: Refreshed TTL for " << key << " from " << oldExpiry.GetSeconds() << "s to " << it->second.expiry.GetSeconds() << "s (new TTL=" << newTtl.GetSeconds() << "s)");
+  // Start dynamic TTL policy evaluation if enabled
+  if (m_engine.IsDynamicTtlEnabled()) {
+    Simulator::Schedule(m_engine.GetTtlEvalInterval(), &HttpCacheApp::EvaluatePolicy, this);
+  }
 }
-void HttpCacheApp::Insert(const std::string& key, const std::string& val){
-  auto now = Simulator::Now();
-  if (m_map.size() >= m_capacity){ // evict LRU
-    std::string evictKey = m_lru.back();
-    NS_LOG_INFO("EVICTION: Evicting " << evictKey << " to make room for " << key << " (cache full at " << m_capacity << " items)");
-    m_lru.pop_back(); m_map.erase(evictKey);
+void HttpCacheApp::StopApplication(){
+  Simulator::Cancel(m_batchEvent);
+  Simulator::Cancel(m_fetchTimeoutEvent);
+  Simulator::Cancel(m_lookupTimeoutEvent);
+  Simulator::Cancel(m_digestEvent);
+  // A save due at or after the stop time is taken now, while the contents are still there
+  if (m_snapshotEvent.IsPending()) {
+    Simulator::Cancel(m_snapshotEvent);
+    SaveSnapshot();
   }
-  m_lru.push_front(key);
-  std::string service = ExtractService(key);
-  Time ttl = GetEffectiveTtl(service);
-  m_map[key] = Entry{val, now + ttl, m_lru.begin()};
-  NS_LOG_INFO("INSERT: Cached " << key << " with TTL=" << ttl.GetSeconds() << "s (expires at " << (now + ttl).GetSeconds() << "s)");
+  if (m_clientSock) m_clientSock->Close();
+  if (m_originSock) m_originSock->Close();
+  if (m_siblingListenSock) m_siblingListenSock->Close();
+  if (m_siblingSock) m_siblingSock->Close();
+  if (m_digestSock) m_digestSock->Close();
+  if (m_purgeSock) m_purgeSock->Close();
 }
 
 void HttpCacheApp::HandleClientRead(Ptr<Socket> sock){
@@ -174,46 +304,347 @@ void HttpCacheApp::HandleClientRead(Ptr<Socket> sock){
   while ((p = sock->RecvFrom(from))){
     HttpHeader hdr; p->RemoveHeader(hdr);
     std::string key = hdr.GetResource();
-    std::string service = ExtractService(key);
-    RecordRequest(service);
-    m_totalRequests++;
-    auto it = m_map.find(key);
-    auto now = Simulator::Now();
-    if (it != m_map.end() && it->second.expiry > now){
-      NS_LOG_INFO("Cache HIT key=" << key << " at time=" << now.GetSeconds() << "s (expires at " << it->second.expiry.GetSeconds() << "s)");
-      m_totalHits++;
-      Touch(key);
-      Simulator::Schedule(m_cacheDelay, &HttpCacheApp::ReplyToClient, this, hdr.GetRequestId(), key, true, from);
-    } else {
-      if (it != m_map.end()) {
-        NS_LOG_INFO("Cache MISS (EXPIRED) key=" << key << " at time=" << now.GetSeconds() << "s (expired at " << it->second.expiry.GetSeconds() << "s, age=" << (now - it->second.expiry).GetSeconds() << "s)");
+    uint32_t reqId = hdr.GetRequestId();
+    uint32_t hint = hdr.GetObjectSize();
+    uint32_t start = hdr.GetRangeStart();
+    uint32_t length = hdr.GetRangeLength();
+    Time wait(0);
+    if ((m_serviceLimiter.IsEnabled() || m_clientLimiter.IsEnabled()) && !CheckLimits(key, from, &wait)) {
+      OverLimit(reqId, key, from, hint, start, length);
+      continue;
+    }
+    if (wait.IsStrictlyPositive()) {
+      m_limitStats.deferred++;
+      if (m_chunkSize > 0) {
+        Simulator::Schedule(wait, &HttpCacheApp::ProcessRange, this, reqId, key, from, hint, start, length);
       } else {
-        NS_LOG_INFO("Cache MISS (NOT FOUND) key=" << key << " at time=" << now.GetSeconds() << "s");
+        Simulator::Schedule(wait, &HttpCacheApp::ProcessRequest, this, reqId, key, from, hint);
       }
+      continue;
+    }
+    if (m_chunkSize > 0) ProcessRange(reqId, key, from, hint, start, length);
+    else ProcessRequest(reqId, key, from, hint);
+  }
+}
 
-      // Check if this resource is already being fetched
-      auto pendingIt = m_pendingRequests.find(key);
-      if (pendingIt != m_pendingRequests.end()) {
-        // Already pending - add this client to the waiting list
-        NS_LOG_INFO("PENDING: Request for " << key << " already in flight, adding client to waiting list (now " << (pendingIt->second.size() + 1) << " waiting)");
-        pendingIt->second.push_back(std::make_pair(hdr.GetRequestId(), from));
-      } else {
-        // First request for this resource - send to origin
-        NS_LOG_INFO("FORWARD: Sending first request for " << key << " to origin");
-        uint32_t origReqId = hdr.GetRequestId();
-        uint32_t fid = m_nextForwardId++;
-        m_forwarding[fid] = std::make_pair(origReqId, from);
-
-        // Mark this resource as pending
-        m_pendingRequests[key] = std::vector<std::pair<uint32_t, Address>>();
-
-        // Replace header request id with forward id when sending to origin
-        HttpHeader fhdr(fid, key);
-        Ptr<Packet> fwd = Create<Packet>(m_objectSize);
-        fwd->AddHeader(fhdr);
-        m_originSock->Send(fwd);
+bool HttpCacheApp::CheckLimits(const std::string& key, const Address& from, Time* wait){
+  Time now = Simulator::Now();
+  Time maxWait = m_limitAction == LIMIT_DEFER ? m_maxDefer : Time(0);
+  Time clientWait(0), serviceWait(0);
+  uint64_t clientId = 0;
+  if (m_clientLimiter.IsEnabled()) {
+    InetSocketAddress addr = InetSocketAddress::ConvertFrom(from);
+    clientId = (static_cast<uint64_t>(addr.GetIpv4().Get()) << 16) | addr.GetPort();
+    if (!m_clientLimiter.Acquire(clientId, now, maxWait, &clientWait)) return false;
+  }
+  if (m_serviceLimiter.IsEnabled()
+      && !m_serviceLimiter.Acquire(HttpKeyHash(HttpCacheEngine::ExtractService(key)), now, maxWait, &serviceWait)) {
+    // The request is not served, so it must not use up the client's allowance either
+    if (m_clientLimiter.IsEnabled()) m_clientLimiter.Refund(clientId, clientWait);
+    return false;
+  }
+  *wait = std::max(clientWait, serviceWait);
+  return true;
+}
+
+bool HttpCacheApp::HasStale(const std::string& key, uint32_t sizeHint, uint32_t start, uint32_t length,
+                            uint32_t* bytes) const {
+  Time now = Simulator::Now();
+  if (m_chunkSize == 0) return m_engine.Peek(key, now, bytes) != HttpCacheEngine::MISS;
+  // A range is served stale only if every chunk it covers is still stored
+  uint32_t first = 0, last = 0;
+  *bytes = CoveredChunks(sizeHint > 0 ? sizeHint : m_objectSize, start, length, &first, &last);
+  for (uint32_t c = first; c <= last; ++c) {
+    if (m_engine.Peek(ChunkKey(key, c), now) == HttpCacheEngine::MISS) return false;
+  }
+  return true;
+}
+
+void HttpCacheApp::OverLimit(uint32_t reqId, const std::string& key, const Address& from, uint32_t sizeHint,
+                             uint32_t start, uint32_t length){
+  m_shedByService[HttpCacheEngine::ExtractService(key)]++;
+  uint32_t size = 0;
+  if (m_limitAction == LIMIT_STALE && HasStale(key, sizeHint, start, length, &size)) {
+    NS_LOG_INFO("RATE LIMIT: serving " << key << " stale");
+    m_limitStats.stale++;
+    Simulator::Schedule(m_cacheDelay, &HttpCacheApp::ReplyToClient, this, reqId, key, true, from, size, HttpHeader::OK);
+    return;
+  }
+  NS_LOG_INFO("RATE LIMIT: rejecting request for " << key);
+  m_limitStats.rejected++;
+  ReplyToClient(reqId, key, false, from, 0, HttpHeader::UNAVAILABLE);
+}
+
+void HttpCacheApp::ProcessRequest(uint32_t reqId, const std::string& key, const Address& from, uint32_t hint){
+  uint32_t size = 0;
+  HttpCacheEngine::Tier tier = HttpCacheEngine::RAM;
+  bool admitted = true;
+  if (m_engine.Access(key, Simulator::Now(), &size, &tier) == HttpCacheEngine::HIT){
+    CheckVersion(key, key);
+    admitted = m_cpu.Submit(size, m_cacheDelay, [this, reqId, key, from, size, tier]() {
+      // With tiered storage the hit also pays the serving tier's latency and transfer time
+      if (!m_engine.IsTieredEnabled()) {
+        ReplyToClient(reqId, key, true, from, size, HttpHeader::OK);
+        return;
       }
+      Time read = m_engine.ReadTime(tier, size, Simulator::Now());
+      Simulator::Schedule(read, &HttpCacheApp::ReplyToClient, this, reqId, key, true, from, size, HttpHeader::OK);
+    });
+  } else if (m_cpu.GetWorkers() == 0 && m_missCost.IsZero()) {
+    HandleMiss(reqId, key, from, hint);
+  } else {
+    admitted = m_cpu.Submit(hint > 0 ? hint : m_objectSize, m_missCost,
+                            [this, reqId, key, from, hint]() { HandleMiss(reqId, key, from, hint); });
+  }
+  if (!admitted) Overloaded(reqId, key, from);
+}
+
+std::string HttpCacheApp::ChunkKey(const std::string& key, uint32_t chunk){
+  return key + "#" + std::to_string(chunk);
+}
+
+uint32_t HttpCacheApp::CoveredChunks(uint32_t size, uint32_t start, uint32_t length, uint32_t* first,
+                                     uint32_t* last) const {
+  // An unsatisfiable range is ignored, so the whole object is served
+  if (start >= size) start = length = 0;
+  uint32_t end = length > 0 ? static_cast<uint32_t>(std::min<uint64_t>(size, static_cast<uint64_t>(start) + length)) : size;
+  *first = start / m_chunkSize;
+  *last = end > 0 ? (end - 1) / m_chunkSize : 0;
+  return end - start;
+}
+
+void HttpCacheApp::ProcessRange(uint32_t reqId, const std::string& key, const Address& from, uint32_t hint,
+                                uint32_t start, uint32_t length){
+  Time now = Simulator::Now();
+  uint32_t size = hint > 0 ? hint : m_objectSize;
+  uint32_t first = 0, last = 0;
+  uint32_t bytes = CoveredChunks(size, start, length, &first, &last);
+  m_chunkStats.requests++;
+
+  std::vector<uint32_t> missing;
+  HttpCacheEngine::Tier slowest = HttpCacheEngine::RAM;
+  for (uint32_t c = first; c <= last; ++c) {
+    HttpCacheEngine::Tier tier = HttpCacheEngine::RAM;
+    std::string chunk = ChunkKey(key, c);
+    if (m_engine.Access(chunk, now, nullptr, &tier) == HttpCacheEngine::HIT) {
+      CheckVersion(chunk, key);
+      m_chunkStats.chunkHits++;
+      slowest = std::max(slowest, tier);
+    } else {
+      missing.push_back(c);
+    }
+  }
+  m_chunkStats.chunkMisses += missing.size();
+
+  bool admitted = true;
+  if (missing.empty()) {
+    m_chunkStats.fullHits++;
+    admitted = m_cpu.Submit(bytes, m_cacheDelay, [this, reqId, key, from, bytes, slowest]() {
+      if (!m_engine.IsTieredEnabled()) {
+        ReplyToClient(reqId, key, true, from, bytes, HttpHeader::OK);
+        return;
+      }
+      Time read = m_engine.ReadTime(slowest, bytes, Simulator::Now());
+      Simulator::Schedule(read, &HttpCacheApp::ReplyToClient, this, reqId, key, true, from, bytes, HttpHeader::OK);
+    });
+  } else {
+    if (missing.size() <= last - first) m_chunkStats.partialHits++;
+    if (m_cpu.GetWorkers() == 0 && m_missCost.IsZero()) {
+      FetchChunks(reqId, key, from, size, start, length, bytes, missing);
+    } else {
+      admitted = m_cpu.Submit(bytes, m_missCost, [this, reqId, key, from, size, start, length, bytes, missing]() {
+        FetchChunks(reqId, key, from, size, start, length, bytes, missing);
+      });
+    }
+  }
+  if (!admitted) Overloaded(reqId, key, from);
+}
+
+void HttpCacheApp::FetchChunks(uint32_t reqId, const std::string& key, const Address& from, uint32_t objectSize,
+                               uint32_t start, uint32_t length, uint32_t bytes, const std::vector<uint32_t>& missing){
+  // The origin budget is charged once for a request that starts any chunk fetch
+  if (m_originLimiter.IsEnabled()) {
+    bool starts = false;
+    for (uint32_t c : missing) starts = starts || m_pendingRequests.find(ChunkKey(key, c)) == m_pendingRequests.end();
+    Time wait(0);
+    if (starts
+        && !m_originLimiter.Acquire(HttpKeyHash(HttpCacheEngine::ExtractService(key)), Simulator::Now(), Time(0), &wait)) {
+      m_limitStats.originThrottled++;
+      OverLimit(reqId, key, from, objectSize, start, length);
+      return;
+    }
+  }
+  uint32_t id = m_nextAssemblyId++;
+  RangeAssembly& assembly = m_assemblies[id];
+  assembly.reqId = reqId;
+  assembly.key = key;
+  assembly.from = from;
+  assembly.bytes = bytes;
+  assembly.missing = static_cast<uint32_t>(missing.size());
+  for (uint32_t c : missing) {
+    std::string chunk = ChunkKey(key, c);
+    m_chunkWaiters[chunk].push_back(id);
+    if (m_pendingRequests.find(chunk) != m_pendingRequests.end()) {
+      m_chunkStats.chunksCoalesced++;
+      continue;
+    }
+    NS_LOG_INFO("CHUNK: Fetching " << chunk << " from origin");
+    m_pendingRequests[chunk];
+    m_chunkStats.chunkFetches++;
+    FetchFromOrigin(chunk, objectSize);
+  }
+}
+
+void HttpCacheApp::FinishChunk(const std::string& chunkKey, bool ok){
+  auto it = m_chunkWaiters.find(chunkKey);
+  if (it == m_chunkWaiters.end()) return;
+  for (uint32_t id : it->second) {
+    auto a = m_assemblies.find(id);
+    if (a == m_assemblies.end()) continue;
+    RangeAssembly& assembly = a->second;
+    if (!ok) assembly.failed = true;
+    if (--assembly.missing > 0) continue;
+    if (assembly.failed) {
+      ReplyToClient(assembly.reqId, assembly.key, false, assembly.from, 0, HttpHeader::UNAVAILABLE);
+    } else {
+      ReplyToClient(assembly.reqId, assembly.key, false, assembly.from, assembly.bytes, HttpHeader::OK);
+    }
+    m_assemblies.erase(a);
+  }
+  m_chunkWaiters.erase(it);
+}
+
+void HttpCacheApp::Overloaded(uint32_t reqId, const std::string& key, const Address& from){
+  NS_LOG_INFO("OVERLOAD: shedding request for " << key);
+  if (m_overflowReject) ReplyToClient(reqId, key, false, from, 0, HttpHeader::UNAVAILABLE);
+}
+
+void HttpCacheApp::HandleMiss(uint32_t reqId, const std::string& key, const Address& from, uint32_t sizeHint){
+  // Check if this resource is already being fetched
+  auto pendingIt = m_pendingRequests.find(key);
+  if (pendingIt != m_pendingRequests.end()) {
+    // Already pending - add this client to the waiting list
+    NS_LOG_INFO("PENDING: Request for " << key << " already in flight, adding client to waiting list (now " << (pendingIt->second.size() + 1) << " waiting)");
+    pendingIt->second.push_back(std::make_pair(reqId, from));
+  } else {
+    // First request for this resource - ask a sibling that advertises it, which costs no origin budget
+    Ipv4Address sibling;
+    if (FindSibling(key, &sibling)) {
+      NS_LOG_INFO("SIBLING: Asking " << sibling << " for " << key);
+      m_pendingRequests[key].push_back(std::make_pair(reqId, from));
+      AskSibling(key, sizeHint, sibling);
+      return;
+    }
+    // Otherwise send to origin, within the service's origin budget
+    Time wait(0);
+    if (!AcquireOriginToken(key, &wait)) {
+      OverLimit(reqId, key, from);
+      return;
+    }
+    NS_LOG_INFO("FORWARD: Sending first request for " << key << " to origin");
+    m_pendingRequests[key].push_back(std::make_pair(reqId, from));
+    if (wait.IsStrictlyPositive()) {
+      // Later misses for the key join the waiting list meanwhile
+      m_limitStats.originDeferred++;
+      Simulator::Schedule(wait, &HttpCacheApp::FetchFromOrigin, this, key, sizeHint);
+      return;
     }
+    FetchFromOrigin(key, sizeHint);
+  }
+}
+
+bool HttpCacheApp::AcquireOriginToken(const std::string& key, Time* wait){
+  *wait = Time(0);
+  if (m_originLimiter.IsEnabled()
+      && !m_originLimiter.Acquire(HttpKeyHash(HttpCacheEngine::ExtractService(key)), Simulator::Now(),
+                                  m_limitAction == LIMIT_DEFER ? m_maxDefer : Time(0), wait)) {
+    m_limitStats.originThrottled++;
+    return false;
+  }
+  return true;
+}
+
+void HttpCacheApp::FetchAfterLookup(const std::string& key, uint32_t sizeHint){
+  // The sibling could not help, so the key now needs the origin budget a plain miss would have spent
+  Time wait(0);
+  if (!AcquireOriginToken(key, &wait)) {
+    auto pendingIt = m_pendingRequests.find(key);
+    std::vector<std::pair<uint32_t, Address>> waiting = std::move(pendingIt->second);
+    m_pendingRequests.erase(pendingIt);
+    for (const auto& w : waiting) OverLimit(w.first, key, w.second);
+    return;
+  }
+  if (wait.IsStrictlyPositive()) {
+    m_limitStats.originDeferred++;
+    Simulator::Schedule(wait, &HttpCacheApp::FetchFromOrigin, this, key, sizeHint);
+    return;
+  }
+  FetchFromOrigin(key, sizeHint);
+}
+
+void HttpCacheApp::FetchFromOrigin(const std::string& key, uint32_t sizeHint){
+  // Use a unique forward id towards the origin to avoid request id collisions across clients
+  uint32_t fid = m_nextForwardId++;
+  m_originKeys++;
+  m_fetches.Insert(fid, Simulator::Now()).key = &m_pendingRequests.find(key)->first;
+  if (m_originTimeout.IsStrictlyPositive() && !m_fetchTimeoutEvent.IsPending()) {
+    m_fetchTimeoutEvent = Simulator::Schedule(m_originTimeout, &HttpCacheApp::ExpireFetches, this);
+  }
+  // A chunk is fetched as a byte range of its object; sizeHint is then the whole object's size
+  std::string resource = key;
+  uint32_t rangeStart = 0;
+  uint32_t rangeLength = 0;
+  if (m_chunkSize > 0) {
+    size_t hash = key.rfind('#');
+    resource = key.substr(0, hash);
+    rangeStart = static_cast<uint32_t>(std::stoul(key.substr(hash + 1))) * m_chunkSize;
+    uint32_t size = sizeHint > 0 ? sizeHint : m_objectSize;
+    rangeLength = std::min(m_chunkSize, size - rangeStart);
+  }
+  if (m_batchWindow.IsZero()) {
+    HttpHeader fhdr(fid, resource, sizeHint);
+    fhdr.SetRange(rangeStart, rangeLength);
+    Ptr<Packet> fwd = Create<Packet>(m_requestHeaderBytes);
+    fwd->AddHeader(fhdr);
+    m_originSock->Send(fwd);
+    m_originRequests++;
+    return;
+  }
+  m_batch.AddKey(fid, resource, sizeHint, rangeStart, rangeLength);
+  m_batchQueued.push_back(Simulator::Now());
+  if (m_batch.GetKeys().size() >= m_batchMaxKeys) {
+    Simulator::Cancel(m_batchEvent);
+    FlushBatch();
+  } else if (!m_batchEvent.IsPending()) {
+    m_batchEvent = Simulator::Schedule(m_batchWindow, &HttpCacheApp::FlushBatch, this);
+  }
+}
+
+void HttpCacheApp::FlushBatch(){
+  if (m_batch.GetKeys().empty()) return;
+  NS_LOG_INFO("BATCH: Sending " << m_batch.GetKeys().size() << " keys to origin");
+  for (const Time& t : m_batchQueued) m_batchDelaySeconds += (Simulator::Now() - t).GetSeconds();
+  // One header block for the whole batch; the key list rides in the batch header
+  Ptr<Packet> req = Create<Packet>(m_requestHeaderBytes);
+  req->AddHeader(m_batch);
+  m_originSock->SendTo(req, 0, InetSocketAddress(Ipv4Address::ConvertFrom(m_originAddr), m_originBatchPort));
+  m_originRequests++;
+  m_batch.Clear();
+  m_batchQueued.clear();
+}
+
+void HttpCacheApp::ExpireFetches(){
+  Time now = Simulator::Now();
+  m_fetches.Expire(now - m_originTimeout, [this](uint32_t fid, const OriginFetch& fetch) {
+    NS_LOG_INFO("TIMEOUT: origin fetch " << fid << " for " << *fetch.key);
+    m_originTimeouts++;
+    std::string key = *fetch.key;
+    ServePending(key, 0, HttpHeader::UNAVAILABLE);
+    if (m_chunkSize > 0) FinishChunk(key, false);
+  });
+  Time oldest;
+  if (m_fetches.GetOldest(&oldest)) {
+    m_fetchTimeoutEvent = Simulator::Schedule(oldest + m_originTimeout - now, &HttpCacheApp::ExpireFetches, this);
   }
 }
 
@@ -221,36 +652,219 @@ void HttpCacheApp::HandleOriginRead(Ptr<Socket> sock){
   Address from; Ptr<Packet> p;
   while ((p = sock->RecvFrom(from))){
     HttpHeader hdr; p->RemoveHeader(hdr);
-    std::string key = hdr.GetResource(); // origin echoes key
-    // store and reply to waiting client. The origin returns the forward id as
-    // the request id; look up the original client request id and address.
-    Insert(key, "data");
-    uint32_t fid = hdr.GetRequestId();
-    auto itf = m_forwarding.find(fid);
-    if (itf != m_forwarding.end()){
-      uint32_t origReqId = itf->second.first;
-      Address clientAddr = itf->second.second;
-      ReplyToClient(origReqId, key, false, clientAddr);
-      m_forwarding.erase(itf);
+    // The origin echoes the forward id and key; batched and single fetches are demultiplexed the same way
+    std::string key = hdr.GetResource();
+    HttpHeader::Status status = hdr.GetStatus();
+    uint32_t size = hdr.GetObjectSize() > 0 ? hdr.GetObjectSize() : m_objectSize;
+    if (m_chunkSize > 0) {
+      // Chunk fetches are answered with (or, when shed, tagged with) their byte range
+      key = ChunkKey(key, hdr.GetRangeStart() / m_chunkSize);
+      if (hdr.HasRange()) size = hdr.GetRangeLength();
+    }
+    OriginFetch* fetch = m_fetches.Find(hdr.GetRequestId());
+    if (status == HttpHeader::OK) {
+      m_originBytes += size;
+      if (fetch && fetch->purged) NS_LOG_INFO("PURGE: not storing " << key << ", fetched before the purge");
+      else m_engine.Insert(key, size, Simulator::Now(), hdr.GetVersion());
+    } else {
+      // The origin shed the fetch: fail every waiting client instead of caching
+      NS_LOG_INFO("UNAVAILABLE: origin shed the fetch for " << key);
+      m_originUnavailable++;
+      size = 0;
     }
 
-    // Serve all clients waiting for this resource
-    auto pendingIt = m_pendingRequests.find(key);
-    if (pendingIt != m_pendingRequests.end()) {
-      NS_LOG_INFO("SERVING PENDING: Responding to " << pendingIt->second.size() << " waiting clients for " << key);
-      for (const auto& waiting : pendingIt->second) {
-        ReplyToClient(waiting.first, key, false, waiting.second);
-      }
-      m_pendingRequests.erase(pendingIt);
+    // Serve all clients waiting for this fetch; a fetch that already timed out has none
+    if (!fetch) continue;
+    m_fetches.Erase(hdr.GetRequestId());
+    ServePending(key, size, status);
+    if (m_chunkSize > 0) FinishChunk(key, status == HttpHeader::OK);
+  }
+}
+
+void HttpCacheApp::CheckVersion(const std::string& key, const std::string& resource){
+  if (m_versionOracle.IsNull()) return;
+  uint32_t stored = m_engine.GetVersion(key);
+  if (stored == 0) return;
+  uint32_t current = m_versionOracle(resource);
+  m_staleness.checkedHits++;
+  if (current > stored) {
+    NS_LOG_INFO("STALE: " << key << " at version " << stored << ", origin has " << current);
+    m_staleness.staleHits++;
+    m_staleness.versionsBehind += current - stored;
+  }
+}
+
+void HttpCacheApp::ServePending(const std::string& key, uint32_t size, HttpHeader::Status status){
+  auto pendingIt = m_pendingRequests.find(key);
+  if (pendingIt == m_pendingRequests.end()) return;
+  NS_LOG_INFO("SERVING PENDING: Responding to " << pendingIt->second.size() << " waiting clients for " << key);
+  for (const auto& waiting : pendingIt->second) {
+    ReplyToClient(waiting.first, key, false, waiting.second, size, status);
+  }
+  m_pendingRequests.erase(pendingIt);
+}
+
+bool HttpCacheApp::FindSibling(const std::string& key, Ipv4Address* sibling) const {
+  if (m_peers.empty()) return false;
+  uint64_t hash = HttpKeyHash(key);
+  for (const auto& kv : m_peers) {
+    if (!kv.second.digest.IsEmpty() && kv.second.digest.Contains(hash)) {
+      *sibling = kv.second.addr;
+      return true;
+    }
+  }
+  return false;
+}
+
+void HttpCacheApp::AskSibling(const std::string& key, uint32_t sizeHint, Ipv4Address sibling){
+  uint32_t id = m_nextLookupId++;
+  m_siblingStats.lookups++;
+  SiblingLookup& lookup = m_lookups.Insert(id, Simulator::Now());
+  lookup.key = &m_pendingRequests.find(key)->first;
+  lookup.sizeHint = sizeHint;
+  if (!m_lookupTimeoutEvent.IsPending()) {
+    m_lookupTimeoutEvent = Simulator::Schedule(m_siblingTimeout, &HttpCacheApp::ExpireLookups, this);
+  }
+  // Lookups carry only the key and request headers; the sibling answers with the object or NOT_FOUND
+  HttpHeader hdr(id, key, sizeHint);
+  Ptr<Packet> req = Create<Packet>(m_requestHeaderBytes);
+  req->AddHeader(hdr);
+  m_siblingSock->SendTo(req, 0, InetSocketAddress(sibling, m_siblingPort));
+}
+
+void HttpCacheApp::HandleSiblingLookup(Ptr<Socket> sock){
+  Address from; Ptr<Packet> p;
+  while ((p = sock->RecvFrom(from))){
+    HttpHeader hdr; p->RemoveHeader(hdr);
+    std::string key = hdr.GetResource();
+    uint32_t id = hdr.GetRequestId();
+    uint32_t size = 0;
+    // Only-if-cached: a sibling never triggers an origin fetch here, and its request is not counted
+    if (m_engine.Peek(key, Simulator::Now(), &size) != HttpCacheEngine::HIT) {
+      m_siblingStats.lookupsNotFound++;
+      HttpHeader resp(id, key, 0);
+      resp.SetStatus(HttpHeader::NOT_FOUND);
+      Ptr<Packet> r = Create<Packet>(m_responseHeaderBytes);
+      r->AddHeader(resp);
+      sock->SendTo(r, 0, from);
+      continue;
+    }
+    m_siblingStats.lookupsServed++;
+    uint32_t version = m_engine.GetVersion(key);
+    uint32_t bytes = size + m_responseHeaderBytes;
+    bool admitted = m_cpu.Submit(size, m_cacheDelay, [sock, id, key, from, size, bytes, version]() {
+      HttpHeader resp(id, key, size);
+      resp.SetVersion(version);
+      Ptr<Packet> r = Create<Packet>(bytes);
+      r->AddHeader(resp);
+      sock->SendTo(r, 0, from);
+    });
+    if (!admitted) {
+      HttpHeader resp(id, key, 0);
+      resp.SetStatus(HttpHeader::UNAVAILABLE);
+      Ptr<Packet> r = Create<Packet>(m_responseHeaderBytes);
+      r->AddHeader(resp);
+      sock->SendTo(r, 0, from);
+    }
+  }
+}
+
+void HttpCacheApp::HandleSiblingRead(Ptr<Socket> sock){
+  Address from; Ptr<Packet> p;
+  while ((p = sock->RecvFrom(from))){
+    HttpHeader hdr; p->RemoveHeader(hdr);
+    SiblingLookup* found = m_lookups.Find(hdr.GetRequestId());
+    // An answer after the timeout is ignored: the key has gone to the origin already
+    if (!found) continue;
+    SiblingLookup lookup = *found;
+    m_lookups.Erase(hdr.GetRequestId());
+    std::string key = *lookup.key;
+    if (hdr.GetStatus() == HttpHeader::OK) {
+      uint32_t size = hdr.GetObjectSize() > 0 ? hdr.GetObjectSize() : m_objectSize;
+      m_siblingStats.siblingHits++;
+      if (!lookup.purged) m_engine.Insert(key, size, Simulator::Now(), hdr.GetVersion());
+      ServePending(key, size, HttpHeader::OK);
+      continue;
+    }
+    if (hdr.GetStatus() == HttpHeader::NOT_FOUND) {
+      NS_LOG_INFO("SIBLING: False positive for " << key << ", fetching from origin");
+      m_siblingStats.falsePositives++;
+    }
+    FetchAfterLookup(key, lookup.sizeHint);
+  }
+}
+
+void HttpCacheApp::ExpireLookups(){
+  Time now = Simulator::Now();
+  m_lookups.Expire(now - m_siblingTimeout, [this](uint32_t id, const SiblingLookup& lookup) {
+    NS_LOG_INFO("TIMEOUT: sibling lookup " << id << " for " << *lookup.key);
+    m_siblingStats.lookupTimeouts++;
+    FetchAfterLookup(std::string(*lookup.key), lookup.sizeHint);
+  });
+  Time oldest;
+  if (m_lookups.GetOldest(&oldest)) {
+    m_lookupTimeoutEvent = Simulator::Schedule(oldest + m_siblingTimeout - now, &HttpCacheApp::ExpireLookups, this);
+  }
+}
+
+void HttpCacheApp::SendDigest(){
+  HttpBloomFilter digest;
+  digest.Resize(std::max<uint64_t>(m_engine.GetSize(), 1), m_digestBitsPerItem, m_digestHashes);
+  m_engine.AddKeysTo(digest, Simulator::Now());
+  const std::vector<uint64_t>& words = digest.GetWords();
+  uint32_t total = static_cast<uint32_t>(words.size());
+  uint32_t generation = ++m_digestGeneration;
+  m_siblingStats.lastDigestBytes = total * sizeof(uint64_t);
+  for (const Address& sibling : m_siblings) {
+    for (uint32_t offset = 0; offset < total; offset += HttpDigestHeader::kMaxWords) {
+      HttpDigestHeader hdr(GetNode()->GetId(), generation, m_digestHashes, total, offset);
+      hdr.SetWords(words.data() + offset, std::min(HttpDigestHeader::kMaxWords, total - offset));
+      Ptr<Packet> chunk = Create<Packet>(0);
+      chunk->AddHeader(hdr);
+      m_digestSock->SendTo(chunk, 0, InetSocketAddress(Ipv4Address::ConvertFrom(sibling), m_digestPort));
+      m_siblingStats.digestBytesSent += hdr.GetSerializedSize();
+    }
+    m_siblingStats.digestsSent++;
+  }
+  NS_LOG_INFO("DIGEST: " << m_engine.GetSize() << " keys in " << m_siblingStats.lastDigestBytes << " bytes");
+  m_digestEvent = Simulator::Schedule(m_digestInterval, &HttpCacheApp::SendDigest, this);
+}
+
+void HttpCacheApp::HandleDigestRead(Ptr<Socket> sock){
+  Address from; Ptr<Packet> p;
+  while ((p = sock->RecvFrom(from))){
+    HttpDigestHeader hdr; p->RemoveHeader(hdr);
+    Peer& peer = m_peers[hdr.GetSender()];
+    peer.addr = InetSocketAddress::ConvertFrom(from).GetIpv4();
+    uint32_t total = hdr.GetTotalWords();
+    // Chunks of an older generation are stale; a newer one restarts the assembly
+    if (hdr.GetGeneration() < peer.generation) continue;
+    if (hdr.GetGeneration() > peer.generation || peer.words.size() != total) {
+      peer.generation = hdr.GetGeneration();
+      peer.words.assign(total, 0);
+      peer.received = 0;
     }
+    const std::vector<uint64_t>& words = hdr.GetWords();
+    if (hdr.GetOffset() + words.size() > total) continue;
+    std::copy(words.begin(), words.end(), peer.words.begin() + hdr.GetOffset());
+    peer.received += words.size();
+    if (peer.received < total) continue;
+    // Every word is in: a filter of total * 64 bits at one bit per item has exactly this size
+    peer.digest.Resize(static_cast<uint64_t>(total) * 64, 1, hdr.GetHashes());
+    peer.digest.GetWords().swap(peer.words);
+    peer.words.clear();
+    peer.received = 0;
+    m_siblingStats.digestsReceived++;
   }
 }
 
-void HttpCacheApp::ReplyToClient(uint32_t reqId, const std::string& resource, bool hit, const Address& to){
+void HttpCacheApp::ReplyToClient(uint32_t reqId, const std::string& resource, bool hit, const Address& to, uint32_t size,
+                                 HttpHeader::Status status){
   // Encode hit/miss by suffixing resource with 'H' or 'M'
   std::string res = resource + (hit?"H":"M");
-  Ptr<Packet> resp = Create<Packet>(m_objectSize);
-  HttpHeader hdr(reqId, res);
+  Ptr<Packet> resp = Create<Packet>(size + m_responseHeaderBytes);
+  HttpHeader hdr(reqId, res, size);
+  hdr.SetStatus(status);
   resp->AddHeader(hdr);
   m_clientSock->SendTo(resp, 0, to);
 }
@@ -1,12 +1,20 @@
 #pragma once
+#include "http-cache-engine.h"
+#include "http-header.h"
+#include "http-inflight-table.h"
+#include "http-rate-limiter.h"
+#include "http-server-queue.h"
 #include "ns3/application.h"
 #include "ns3/socket.h"
 #include "ns3/address.h"
+#include "ns3/callback.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/event-id.h"
 #include "ns3/nstime.h"
+#include <map>
 #include <unordered_map>
-#include <unordered_set>
-#include <list>
 #include <string>
+#include <vector>
 
 namespace ns3 {
 
@@ -15,80 +23,417 @@ public:
   static TypeId GetTypeId();
   HttpCacheApp();
 
+  /// What happens to a request over a rate limit
+  enum LimitAction {
+    LIMIT_REJECT, ///< answer UNAVAILABLE
+    LIMIT_DEFER,  ///< hold it until a token is available, or reject if that is beyond the maximum deferral
+    LIMIT_STALE   ///< answer from the cached copy even if expired, without an origin fetch; reject if none
+  };
+  struct LimitStats {
+    uint64_t rejected = 0;        ///< answered UNAVAILABLE
+    uint64_t deferred = 0;        ///< client requests held for a token
+    uint64_t stale = 0;           ///< answered from the cached copy
+    uint64_t originThrottled = 0; ///< misses refused an origin fetch (then rejected or served stale)
+    uint64_t originDeferred = 0;  ///< origin fetches held for a token
+  };
+  struct ChunkStats {
+    uint64_t requests = 0;        ///< client requests served through chunks
+    uint64_t fullHits = 0;        ///< every chunk of the range was cached
+    uint64_t partialHits = 0;     ///< some chunks cached, only the others fetched
+    uint64_t chunkHits = 0;
+    uint64_t chunkMisses = 0;
+    uint64_t chunkFetches = 0;    ///< chunk fetches sent to the origin
+    uint64_t chunksCoalesced = 0; ///< missing chunks that joined a fetch already in flight
+  };
+  struct SiblingStats {
+    uint64_t digestsSent = 0;      ///< digests sent, one per sibling per interval
+    uint64_t digestBytesSent = 0;  ///< header and filter bytes of all digest packets
+    uint32_t lastDigestBytes = 0;  ///< filter size of the latest digest
+    uint64_t digestsReceived = 0;  ///< complete digests assembled from siblings
+    uint64_t lookups = 0;          ///< misses sent to a sibling
+    uint64_t siblingHits = 0;      ///< lookups answered with the object
+    uint64_t falsePositives = 0;   ///< lookups answered NOT_FOUND, then fetched from the origin
+    uint64_t lookupTimeouts = 0;   ///< lookups unanswered within the sibling timeout
+    uint64_t lookupsServed = 0;    ///< siblings' lookups this cache answered with the object
+    uint64_t lookupsNotFound = 0;  ///< siblings' lookups this cache answered NOT_FOUND
+  };
+  /// One purge as applied by this cache
+  struct PurgeRecord {
+    Time at;                      ///< when the cache applied it
+    Time delay;                   ///< from the origin's push to its application (zero for local purges)
+    HttpPurgeHeader::Scope scope = HttpPurgeHeader::KEY;
+    std::string target;
+    uint64_t objects = 0;         ///< objects removed
+    uint64_t examined = 0;        ///< keys the engine looked at to find them
+    double wallMicros = 0.0;      ///< host time spent removing them
+    uint64_t stormFetches = 0;    ///< origin fetches started in the storm window that followed
+    uint64_t inFlight = 0;        ///< fetches and sibling lookups already under way, answered but not stored
+  };
+  struct StalenessStats {
+    uint64_t checkedHits = 0;      ///< hits of versioned entries compared with the origin
+    uint64_t staleHits = 0;        ///< hits that served an outdated version
+    uint64_t versionsBehind = 0;   ///< updates missed, summed over stale hits
+  };
+
   void SetListenPort(uint16_t p);
   void SetOrigin(Address a, uint16_t p);
   void SetTtl(Time t);
   void SetCapacity(uint32_t entries);
+  /// CPU time a hit occupies a worker (the fixed hit delay when workers are unlimited)
   void SetCacheDelay(Time t);
+  /// CPU time to look up and forward a miss (default zero: misses go straight to the origin)
+  void SetMissCost(Time t);
+  /// Answer requests shed by a full CPU queue with UNAVAILABLE (true) or drop them silently
+  void SetOverflowReject(bool reject);
   /**
    * \brief Set the size of objects being cached
    * \param size Object size in bytes
    */
   void SetObjectSize(uint32_t size);
+  /**
+   * \brief Bytes standing in for HTTP headers on the wire
+   * \param requestBytes payload of each origin fetch, multi-get batch and sibling lookup
+   * \param responseBytes added to every response sent to a client or a sibling
+   */
+  void SetHeaderSizes(uint32_t requestBytes, uint32_t responseBytes);
   void SetDynamicTtlEnabled(bool enabled);
   void SetTtlWindow(Time window);
   void SetTtlThreshold(double threshold);
   void SetTtlReduction(double reduction);
   void SetTtlEvalInterval(Time interval);
+  /**
+   * \brief Batch origin fetches (multi-get)
+   * \param window how long a miss may wait for other misses; zero sends each miss on its own
+   * \param maxKeys flush a batch early once it holds this many keys
+   *
+   * Batches go to the origin's batch port as one HttpBatchHeader request.
+   */
+  void SetBatching(Time window, uint32_t maxKeys = 32);
+  void SetOriginBatchPort(uint16_t p);
+  /**
+   * \brief Store objects as fixed-size chunks (0 = whole objects, the default)
+   *
+   * Each chunk is a cache entry keyed by object and chunk index. A request
+   * (or byte range, see HttpHeader::SetRange) is served from the chunks it
+   * covers: the cached ones are hits, and only the missing ones are fetched
+   * from the origin as range requests, one per chunk. A chunk already being
+   * fetched for another request is waited for, not fetched again. The
+   * engine's request and hit counters then count chunks, and chunked misses
+   * neither ask siblings nor wait for origin tokens (over the origin limit
+   * they are rejected or served stale at once).
+   *
+   * Without chunking the cache ignores request ranges, as a server without
+   * range support may, and always answers with the whole object.
+   */
+  void SetChunkSize(uint32_t bytes);
+  uint32_t GetChunkSize() const { return m_chunkSize; }
+  const ChunkStats& GetChunkStats() const { return m_chunkStats; }
+  /// Fail the waiting clients of an origin fetch unanswered for this long (zero = wait forever)
+  void SetOriginTimeout(Time t);
+  /**
+   * \brief Token-bucket limits at the cache (rate in requests per second, 0 = unlimited)
+   *
+   * Client requests are limited per service and per client address before
+   * they reach the CPU queue. Origin fetches are limited per service when a
+   * miss starts one; misses that join a fetch in flight are not charged.
+   * Over-limit requests get the SetLimitAction() treatment.
+   * \param burst bucket depth (0 = one second's worth)
+   */
+  void SetServiceRateLimit(double rate, double burst = 0.0);
+  void SetClientRateLimit(double rate, double burst = 0.0);
+  void SetOriginRateLimit(double rate, double burst = 0.0);
+  void SetLimitAction(LimitAction action, Time maxDefer);
+  static bool ParseLimitAction(const std::string& name, LimitAction* action);
+  const LimitStats& GetLimitStats() const { return m_limitStats; }
+  /// Requests rejected or served stale by a rate limit, per service
+  const std::unordered_map<std::string, uint64_t>& GetShedByService() const { return m_shedByService; }
+  /**
+   * \brief Cooperate with a sibling cache
+   *
+   * Every digest interval the cache sends each sibling a Bloom filter of its
+   * fresh keys. On a miss it first asks a sibling whose latest digest holds
+   * the key, with an only-if-cached lookup; a NOT_FOUND answer (a false
+   * positive or an object evicted since the digest) or no answer within the
+   * sibling timeout falls back to the origin. Siblings must use the same
+   * ports (SetSiblingPorts()).
+   */
+  void AddSibling(Address addr);
+  void SetSiblingPorts(uint16_t lookupPort, uint16_t digestPort);
+  /// Digest refresh interval and filter size (bits per cached object, Bloom probes per key)
+  void SetDigest(Time interval, uint32_t bitsPerItem = 8, uint32_t hashes = 4);
+  void SetSiblingTimeout(Time t);
+  const SiblingStats& GetSiblingStats() const { return m_siblingStats; }
+  /**
+   * \brief Compare every hit with the version the origin would serve now
+   *
+   * Origin versions (HttpHeader::GetVersion) are stored with each object and
+   * feed the engine's adaptive TTL (HttpCacheEngine::SetAdaptiveTtl). The
+   * oracle, e.g. HttpOriginApp::PeekVersion, only measures staleness: a hit
+   * on an older version is counted, and still answered from the cache.
+   */
+  void SetVersionOracle(Callback<uint32_t, const std::string&> oracle);
+  const StalenessStats& GetStalenessStats() const { return m_staleness; }
+  /**
+   * \brief Invalidate cached objects by key, prefix or service
+   *
+   * Purges are applied by Purge(), at times set with SchedulePurge(), or on
+   * HttpPurgeHeader messages pushed by the origin (HttpOriginApp::SchedulePurge)
+   * to the purge port. A KEY purge also removes the object's chunks. Enable
+   * the engine's purge index (HttpCacheEngine::SetPurgeIndexEnabled) to make
+   * prefix and service purges cost time proportional to what they remove.
+   * Each purge is recorded with the origin fetches of the storm window that
+   * follows it, which shows the miss storm it causes.
+   * \param p port for pushed purges (0 = none, the default)
+   */
+  void SetPurgePort(uint16_t p);
+  void SetPurgeStormWindow(Time t);
+  void SchedulePurge(Time at, HttpPurgeHeader::Scope scope, const std::string& target);
+  /// Apply a purge now; returns the number of objects removed
+  size_t Purge(HttpPurgeHeader::Scope scope, const std::string& target);
+  const std::vector<PurgeRecord>& GetPurges() const { return m_purges; }
+  static bool ParsePurgeScope(const std::string& name, HttpPurgeHeader::Scope* scope);
+  /// Load this snapshot (see HttpCacheEngine::LoadSnapshot) when the application starts
+  void SetSnapshotLoad(const std::string& path);
+  /// Save a snapshot to \p path at simulation time \p at (or when the application stops, if earlier)
+  void SetSnapshotSave(const std::string& path, Time at);
+  /// Entries loaded from the snapshot at start (-1 if loading failed, 0 if none was configured)
+  int64_t GetSnapshotEntriesLoaded() const { return m_snapshotLoaded; }
+  /**
+   * \brief Serve a request by function call, without sockets or packets
+   *
+   * Looks the key up and, on a miss, stores it at once as if the origin had
+   * answered instantly. Clients use this during a fast-forward warm-up (see
+   * HttpClientApp::SetDirectPath). With chunked storage only the chunks the
+   * range covers are looked up and stored.
+   * \param sizeHint object size in bytes (0 = SetObjectSize())
+   * \param rangeStart, rangeLength byte range wanted (length 0 = the whole object)
+   * \return true on a hit
+   */
+  bool ServeDirect(std::string key, uint32_t sizeHint, uint32_t rangeStart, uint32_t rangeLength);
+  /// End of the fast-forward warm-up; the engine's counters restart at \p until
+  void SetFastForward(Time until);
+  /// Requests served through ServeDirect()
+  uint64_t GetDirectRequests() const { return m_directRequests; }
 
   // Progress tracking getters
-  uint64_t GetTotalRequests() const { return m_totalRequests; }
-  uint64_t GetTotalHits() const { return m_totalHits; }
+  uint64_t GetTotalRequests() const { return m_engine.GetTotalRequests(); }
+  uint64_t GetTotalHits() const { return m_engine.GetTotalHits(); }
+  /// Origin fetches answered with HttpHeader::UNAVAILABLE
+  uint64_t GetOriginUnavailable() const { return m_originUnavailable; }
+  /// Request packets sent to the origin (one per batch when batching)
+  uint64_t GetOriginRequests() const { return m_originRequests; }
+  /// Keys fetched from the origin
+  uint64_t GetOriginKeys() const { return m_originKeys; }
+  /// Object bytes received from the origin
+  uint64_t GetOriginBytes() const { return m_originBytes; }
+  /// Keys with an origin fetch outstanding (including keys waiting in a batch)
+  uint64_t GetOriginFetchesInFlight() const { return m_pendingRequests.size(); }
+  /// Origin fetches that timed out; their waiting clients got HttpHeader::UNAVAILABLE
+  uint64_t GetOriginTimeouts() const { return m_originTimeouts; }
+  /// Mean time a fetched key waited in the batching window, in seconds
+  double GetMeanBatchDelay() const { return m_originKeys > 0 ? m_batchDelaySeconds / m_originKeys : 0.0; }
+
+  /**
+   * \brief Request-processing model of the cache node
+   *
+   * Every client request occupies one of the queue's workers: a hit for
+   * SetCacheDelay() and a miss for SetMissCost(), plus the queue's per-KiB
+   * cost for the object size. Configure workers, queue limit, discipline and
+   * service-time distribution here; with the default of unlimited workers a
+   * hit is answered after exactly the cache delay, as before.
+   */
+  HttpServerQueue& GetCpu() { return m_cpu; }
+  const HttpServerQueue& GetCpu() const { return m_cpu; }
+
+  /// Cache state shared with network-free drivers
+  HttpCacheEngine& GetEngine() { return m_engine; }
+  const HttpCacheEngine& GetEngine() const { return m_engine; }
 
 private:
-  struct Entry { std::string value; Time expiry; std::list<std::string>::iterator it; };
   void StartApplication() override;
   void StopApplication() override;
   void HandleClientRead(Ptr<Socket> sock);
+  /// Take the service and client tokens for a request; false if it is over a limit
+  bool CheckLimits(const std::string& key, const Address& from, Time* wait);
+  /// Look a request up and queue it on the CPU
+  void ProcessRequest(uint32_t reqId, const std::string& key, const Address& from, uint32_t sizeHint);
+  /// Serve bytes [start, start + length) of \p key (length 0 = all) from its chunks
+  void ProcessRange(uint32_t reqId, const std::string& key, const Address& from, uint32_t sizeHint, uint32_t start,
+                    uint32_t length);
+  /// Wait for the \p missing chunks of a range, fetching those not already in flight
+  void FetchChunks(uint32_t reqId, const std::string& key, const Address& from, uint32_t objectSize, uint32_t start,
+                   uint32_t length, uint32_t bytes, const std::vector<uint32_t>& missing);
+  /// A chunk fetch ended; answer the requests whose last missing chunk this was
+  void FinishChunk(const std::string& chunkKey, bool ok);
+  /// Cache key of chunk \p chunk of \p key
+  static std::string ChunkKey(const std::string& key, uint32_t chunk);
+  /// Chunks [*first, *last] holding bytes [start, start + length) of a \p size byte object; returns the bytes covered
+  uint32_t CoveredChunks(uint32_t size, uint32_t start, uint32_t length, uint32_t* first, uint32_t* last) const;
+  /// Whether a copy of the request, fresh or expired, is stored; with chunks, every chunk of the range
+  bool HasStale(const std::string& key, uint32_t sizeHint, uint32_t start, uint32_t length, uint32_t* bytes) const;
+  /// Reject an over-limit request or serve it stale; the range applies with chunked storage
+  void OverLimit(uint32_t reqId, const std::string& key, const Address& from, uint32_t sizeHint = 0,
+                 uint32_t start = 0, uint32_t length = 0);
   void HandleOriginRead(Ptr<Socket> sock);
-  void ReplyToClient(uint32_t reqId, const std::string& resource, bool hit, const Address& to);
-  void Touch(const std::string& key);
-  void Insert(const std::string& key, const std::string& val);
-  void RecordRequest(const std::string& service);
+  /// Join the pending fetch for \p key or start one
+  void HandleMiss(uint32_t reqId, const std::string& key, const Address& from, uint32_t sizeHint);
+  void Overloaded(uint32_t reqId, const std::string& key, const Address& from);
+  /// Take an origin token for \p key's service; false (counted as throttled) if refused within the allowed wait
+  bool AcquireOriginToken(const std::string& key, Time* wait);
+  /// Send \p key to the origin after a failed sibling lookup, within the origin budget
+  void FetchAfterLookup(const std::string& key, uint32_t sizeHint);
+  void FetchFromOrigin(const std::string& key, uint32_t sizeHint);
+  void FlushBatch();
+  void ExpireFetches();
+  /// Answer every client waiting for \p key
+  void ServePending(const std::string& key, uint32_t size, HttpHeader::Status status);
+  /// Address of a sibling whose digest holds \p key; false if none does
+  bool FindSibling(const std::string& key, Ipv4Address* sibling) const;
+  void AskSibling(const std::string& key, uint32_t sizeHint, Ipv4Address sibling);
+  void HandleSiblingLookup(Ptr<Socket> sock);
+  void HandleSiblingRead(Ptr<Socket> sock);
+  void ExpireLookups();
+  void SendDigest();
+  void HandleDigestRead(Ptr<Socket> sock);
+  void ReplyToClient(uint32_t reqId, const std::string& resource, bool hit, const Address& to, uint32_t size,
+                     HttpHeader::Status status);
   void EvaluatePolicy();
-  Time GetEffectiveTtl(const std::string& service);
-  std::string ExtractService(const std::string& resource);
+  void SaveSnapshot();
+  void EndFastForward();
 
   Ptr<Socket> m_clientSock; // listening for clients
   Ptr<Socket> m_originSock; // to talk to origin
   Address m_originAddr; uint16_t m_originPort = 8081;
   uint16_t m_listenPort = 8080;
-  Time m_ttl{Seconds(5)}; uint32_t m_capacity = 64;
   Time m_cacheDelay{MilliSeconds(1)};
+  Time m_missCost{0};
+  bool m_overflowReject = true;
+  HttpServerQueue m_cpu;         ///< worker pool that serves client requests
   uint32_t m_objectSize = 1024;  ///< Object size in bytes
+  uint32_t m_requestHeaderBytes = 300;
+  uint32_t m_responseHeaderBytes = 0;
+  uint64_t m_originUnavailable = 0;
+  uint64_t m_originRequests = 0;
+  uint64_t m_originKeys = 0;
+  uint64_t m_originBytes = 0;
+  double m_batchDelaySeconds = 0.0;
 
-  // LRU structures
-  std::list<std::string> m_lru;
-  std::unordered_map<std::string, Entry> m_map;
+  // LRU storage and TTL policy
+  HttpCacheEngine m_engine;
 
-  // pending miss state: reqId -> client Address
-  std::unordered_map<uint32_t, Address> m_waiting;
-  // To avoid request id collisions across clients, use a unique forward id when
-  // forwarding to origin: forwardId -> (originalReqId, client Address)
+  // Forward ids sent to the origin; responses are matched back by id
+  struct OriginFetch {
+    const std::string* key = nullptr; ///< key of the fetch's m_pendingRequests entry
+    bool purged = false;              ///< sent before a purge of the key: serve the response, do not store it
+  };
   uint32_t m_nextForwardId = 1;
-  std::unordered_map<uint32_t, std::pair<uint32_t, Address>> m_forwarding;
+  HttpInFlightTable<OriginFetch> m_fetches;
+  Time m_originTimeout{Seconds(60)};
+  EventId m_fetchTimeoutEvent;
+  uint64_t m_originTimeouts = 0;
 
-  // Pending request tracking: resource -> list of (reqId, clientAddr) waiting for it
+  // Pending request tracking: resource -> list of (reqId, clientAddr) waiting for it,
+  // including the client whose miss triggered the origin fetch
   std::unordered_map<std::string, std::vector<std::pair<uint32_t, Address>>> m_pendingRequests;
 
-  // Dynamic TTL policy
-  struct TimeBucket {
-    Time startTime;
-    std::unordered_map<std::string, uint32_t> serviceRequests;
+  // Multi-get batching
+  Time m_batchWindow{Seconds(0)};
+  uint32_t m_batchMaxKeys = 32;
+  uint16_t m_originBatchPort = 8082;
+  HttpBatchHeader m_batch;
+  std::vector<Time> m_batchQueued; ///< enqueue time of each key in m_batch
+  EventId m_batchEvent;
+
+  // Chunked storage: requests waiting for missing chunks, by assembly id. Chunk fetches
+  // have an m_pendingRequests entry with no clients; their requests wait in m_chunkWaiters.
+  struct RangeAssembly {
+    uint32_t reqId = 0;
+    std::string key;
+    Address from;
+    uint32_t bytes = 0;   ///< size of the answer
+    uint32_t missing = 0; ///< chunks still being fetched
+    bool failed = false;  ///< a chunk fetch was shed or timed out
   };
-  std::list<TimeBucket> m_buckets;
-  std::unordered_set<std::string> m_penalizedServices;
-
-  bool m_dynamicTtlEnabled = false;
-  Time m_ttlWindow{Seconds(300)};
-  double m_ttlThreshold = 0.5;
-  double m_ttlReduction = 0.5;
-  Time m_ttlEvalInterval{Seconds(30)};
-  Time m_bucketDuration{Seconds(10)};
-
-  // Progress tracking counters
-  uint64_t m_totalRequests = 0;
-  uint64_t m_totalHits = 0;
+  uint32_t m_chunkSize = 0;
+  uint32_t m_nextAssemblyId = 1;
+  std::unordered_map<uint32_t, RangeAssembly> m_assemblies;
+  std::unordered_map<std::string, std::vector<uint32_t>> m_chunkWaiters;
+  ChunkStats m_chunkStats;
+
+  // Rate limiting
+  HttpRateLimiter m_serviceLimiter;
+  HttpRateLimiter m_clientLimiter;
+  HttpRateLimiter m_originLimiter;
+  LimitAction m_limitAction = LIMIT_REJECT;
+  Time m_maxDefer{MilliSeconds(500)};
+  LimitStats m_limitStats;
+  std::unordered_map<std::string, uint64_t> m_shedByService;
+
+  // Sibling caches: digests received per sender node id, reassembled chunk by chunk
+  struct Peer {
+    Ipv4Address addr;
+    HttpBloomFilter digest;         ///< latest complete digest
+    uint32_t generation = 0;        ///< generation being assembled
+    std::vector<uint64_t> words;    ///< words of that generation received so far
+    uint32_t received = 0;
+  };
+  struct SiblingLookup {
+    const std::string* key = nullptr; ///< key of the lookup's m_pendingRequests entry
+    uint32_t sizeHint = 0;
+    bool purged = false;              ///< as OriginFetch::purged
+  };
+  std::vector<Address> m_siblings;
+  std::map<uint32_t, Peer> m_peers;
+  uint16_t m_siblingPort = 8083;
+  uint16_t m_digestPort = 8084;
+  Time m_digestInterval{Seconds(5)};
+  uint32_t m_digestBitsPerItem = 8;
+  uint32_t m_digestHashes = 4;
+  uint32_t m_digestGeneration = 0;
+  Time m_siblingTimeout{MilliSeconds(100)};
+  Ptr<Socket> m_siblingListenSock; // lookups from siblings
+  Ptr<Socket> m_siblingSock;       // our lookups to siblings
+  Ptr<Socket> m_digestSock;
+  uint32_t m_nextLookupId = 1;
+  HttpInFlightTable<SiblingLookup> m_lookups;
+  EventId m_lookupTimeoutEvent;
+  EventId m_digestEvent;
+  SiblingStats m_siblingStats;
+
+  // Staleness measurement
+  /// Count a hit on stored \p key (an object or one of its chunks) of \p resource as fresh or stale
+  void CheckVersion(const std::string& key, const std::string& resource);
+  Callback<uint32_t, const std::string&> m_versionOracle;
+  StalenessStats m_staleness;
+
+  // Purges
+  struct ScheduledPurge {
+    Time at;
+    HttpPurgeHeader::Scope scope;
+    std::string target;
+  };
+  void ApplyPurge(HttpPurgeHeader::Scope scope, std::string target, Time delay);
+  void HandlePurgeRead(Ptr<Socket> sock);
+  /// Whether purging \p target with \p scope covers \p key, as the engine's Purge*() functions decide
+  bool PurgeMatches(HttpPurgeHeader::Scope scope, const std::string& target, const std::string& key) const;
+  /// Record the origin fetches started since purge \p index, when its storm window closes
+  void CloseStormWindow(size_t index, uint64_t originKeysAtPurge);
+  uint16_t m_purgePort = 0;
+  Ptr<Socket> m_purgeSock;
+  Time m_stormWindow{Seconds(5)};
+  std::vector<ScheduledPurge> m_purgeSchedule;
+  std::vector<PurgeRecord> m_purges;
+
+  // Warm-start snapshots
+  std::string m_snapshotLoadPath;
+  std::string m_snapshotSavePath;
+  Time m_snapshotSaveAt;
+  int64_t m_snapshotLoaded = 0;
+  EventId m_snapshotEvent;
+
+  // Fast-forward warm-up
+  Time m_fastForwardUntil;
+  uint64_t m_directRequests = 0;
 };
 
 } // namespace ns3
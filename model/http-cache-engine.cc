@@ -0,0 +1,876 @@
+#include "http-cache-engine.h"
+#include "ns3/log.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ns3 {
+NS_LOG_COMPONENT_DEFINE("HttpCacheEngine");
+
+std::string HttpCacheEngine::ExtractService(const std::string& resource) {
+  // Parse "/service-X/seg-Y" -> "service-X"
+  // Or "/service-X" -> "service-X"
+  if (resource.empty()) return "";
+
+  size_t start = (resource[0] == '/') ? 1 : 0;
+  size_t end = resource.find('/', start);
+
+  if (end == std::string::npos) {
+    return resource.substr(start);
+  }
+  return resource.substr(start, end - start);
+}
+
+void HttpCacheEngine::RecordRequest(const std::string& service, Time now) {
+  if (!m_dynamicTtlEnabled || service.empty()) return;
+
+  // Create new bucket if needed
+  if (m_buckets.empty() || (now - m_buckets.back().startTime) >= m_bucketDuration) {
+    TimeBucket bucket;
+    bucket.startTime = now;
+    m_buckets.push_back(bucket);
+  }
+
+  // Increment count for this service in current bucket
+  m_buckets.back().serviceRequests[service]++;
+}
+
+Time HttpCacheEngine::GetEffectiveTtl(const std::string& service) const {
+  if (!m_dynamicTtlEnabled) return m_ttl;
+
+  if (m_penalizedServices.count(service) > 0) {
+    return m_ttl * (1.0 - m_ttlReduction);
+  }
+  return m_ttl;
+}
+
+void HttpCacheEngine::EvaluatePolicy(Time now) {
+  if (!m_dynamicTtlEnabled) return;
+
+  Time cutoff = now - m_ttlWindow;
+
+  // 1. Prune old buckets outside the window
+  while (!m_buckets.empty() && m_buckets.front().startTime < cutoff) {
+    m_buckets.pop_front();
+  }
+
+  // 2. Aggregate requests per service
+  std::unordered_map<std::string, uint32_t> totals;
+  uint32_t grandTotal = 0;
+  for (const auto& bucket : m_buckets) {
+    for (const auto& pair : bucket.serviceRequests) {
+      totals[pair.first] += pair.second;
+      grandTotal += pair.second;
+    }
+  }
+
+  // 3. Determine penalized services
+  m_penalizedServices.clear();
+  if (grandTotal > 0) {
+    for (const auto& pair : totals) {
+      double share = static_cast<double>(pair.second) / grandTotal;
+      if (share > m_ttlThreshold) {
+        m_penalizedServices.insert(pair.first);
+        NS_LOG_INFO("Dynamic TTL: service " << pair.first << " penalized (share=" << share << ")");
+      }
+    }
+  }
+}
+
+bool HttpCacheEngine::ParsePartitionMode(const std::string& name, PartitionMode* mode) {
+  if (name == "none" || name == "shared") { *mode = SHARED; return true; }
+  if (name == "static") { *mode = STATIC; return true; }
+  if (name == "weighted") { *mode = WEIGHTED; return true; }
+  if (name == "dynamic") { *mode = DYNAMIC; return true; }
+  return false;
+}
+
+void HttpCacheEngine::SetPartitioning(PartitionMode mode, uint32_t step) {
+  m_partitionMode = mode;
+  m_partitionStep = step;
+  Rebalance(nullptr);
+}
+
+void HttpCacheEngine::SetServiceQuota(const std::string& service, uint32_t objects) {
+  Partition& p = m_partitions[service];
+  p.stats.quota = objects;
+  p.fixedQuota = true;
+  Rebalance(nullptr);
+}
+
+void HttpCacheEngine::SetServiceWeight(const std::string& service, double weight) {
+  m_partitions[service].weight = std::max(0.0, weight);
+  Rebalance(nullptr);
+}
+
+bool HttpCacheEngine::SetPartitionShares(const std::string& list) {
+  std::stringstream ss(list);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (item.empty()) continue;
+    size_t colon = item.rfind(':');
+    if (colon == 0 || colon == std::string::npos) return false;
+    char* end = nullptr;
+    double value = std::strtod(item.c_str() + colon + 1, &end);
+    if (end == item.c_str() + colon + 1 || *end != '\0' || value < 0) return false;
+    std::string service = item.substr(0, colon);
+    if (m_partitionMode == STATIC) SetServiceQuota(service, static_cast<uint32_t>(value));
+    else SetServiceWeight(service, value);
+  }
+  return true;
+}
+
+HttpCacheEngine::Partition* HttpCacheEngine::GetPartition(const std::string& key) {
+  std::string service = ExtractService(key);
+  auto it = m_partitions.find(service);
+  if (it != m_partitions.end()) return &it->second;
+  // Values of an unordered_map keep their address across rehashing, so entries can point at them
+  Partition* p = &m_partitions[service];
+  Rebalance(p);
+  return p;
+}
+
+void HttpCacheEngine::Rebalance(Partition* added) {
+  if (m_partitionMode == SHARED || m_partitions.empty()) return;
+  uint32_t n = static_cast<uint32_t>(m_partitions.size());
+  switch (m_partitionMode) {
+  case STATIC: {
+    uint64_t fixed = 0;
+    uint32_t others = 0;
+    for (const auto& kv : m_partitions) {
+      if (kv.second.fixedQuota) fixed += kv.second.stats.quota;
+      else others++;
+    }
+    uint32_t share = (others > 0 && fixed < m_capacity) ? static_cast<uint32_t>((m_capacity - fixed) / others) : 0;
+    for (auto& kv : m_partitions) {
+      if (!kv.second.fixedQuota) kv.second.stats.quota = share;
+    }
+    break;
+  }
+  case WEIGHTED: {
+    double total = 0.0;
+    for (const auto& kv : m_partitions) total += kv.second.weight;
+    for (auto& kv : m_partitions) {
+      kv.second.stats.quota = total > 0 ? static_cast<uint32_t>(m_capacity * kv.second.weight / total) : 0;
+    }
+    break;
+  }
+  case DYNAMIC: {
+    // Every partition keeps at least one slot, otherwise it never evicts and never sees a ghost hit
+    uint32_t share = std::max(1u, m_capacity / n);
+    if (added == nullptr) {
+      for (auto& kv : m_partitions) kv.second.stats.quota = share;
+      break;
+    }
+    // A newcomer gets an equal share, taken from the others in proportion to their learned quotas
+    uint64_t others = 0;
+    for (const auto& kv : m_partitions) {
+      if (&kv.second != added) others += kv.second.stats.quota;
+    }
+    double scale = others > 0 ? std::max(0.0, static_cast<double>(m_capacity) - share) / others : 0.0;
+    for (auto& kv : m_partitions) {
+      Partition& p = kv.second;
+      p.stats.quota = (&p == added) ? share : std::max(1u, static_cast<uint32_t>(p.stats.quota * std::min(1.0, scale)));
+    }
+    break;
+  }
+  case SHARED:
+    break;
+  }
+}
+
+bool HttpCacheEngine::UntieredFull(const Partition* p) const {
+  if (m_map.size() >= m_capacity) return true;
+  return p && m_partitionMode != SHARED && p->stats.objects >= p->stats.quota;
+}
+
+std::list<std::string>* HttpCacheEngine::VictimList(Partition* p) {
+  if (!p || m_partitionMode == SHARED) return m_lru.empty() ? nullptr : &m_lru;
+  // At its quota a partition evicts from itself ...
+  if (p->stats.objects >= p->stats.quota) return p->lru.empty() ? nullptr : &p->lru;
+  // ... below it, it reclaims a slot from the partition furthest over its own
+  Partition* over = nullptr;
+  int64_t most = std::numeric_limits<int64_t>::min();
+  for (auto& kv : m_partitions) {
+    Partition& q = kv.second;
+    if (q.lru.empty()) continue;
+    int64_t excess = static_cast<int64_t>(q.stats.objects) - q.stats.quota;
+    if (excess > most) {
+      most = excess;
+      over = &q;
+    }
+  }
+  return over ? &over->lru : nullptr;
+}
+
+void HttpCacheEngine::EvictUntiered(std::list<std::string>& lru, bool count) {
+  auto victim = m_map.find(lru.back());
+  Partition* p = victim->second.part;
+  if (p) {
+    p->stats.objects--;
+    if (count) p->stats.evictions++;
+    if (count && m_partitionMode == DYNAMIC) {
+      uint64_t h = HttpKeyHash(victim->first);
+      if (p->ghostIndex.count(h) == 0) {
+        p->ghost.push_front(h);
+        p->ghostIndex[h] = p->ghost.begin();
+        // Ghost length tracks the quota, so ghost hits per object compare across partitions
+        size_t limit = std::max<size_t>(8, p->stats.quota / 8);
+        while (p->ghost.size() > limit) {
+          p->ghostIndex.erase(p->ghost.back());
+          p->ghost.pop_back();
+        }
+      }
+    }
+  }
+  if (count) m_evictions++;
+  Erase(victim);
+  lru.pop_back();
+}
+
+void HttpCacheEngine::GhostHit(Partition* p) {
+  p->stats.ghostHits++;
+  p->utility += 1.0;
+  uint32_t step = m_partitionStep > 0 ? m_partitionStep : std::max(1u, m_capacity / 1000);
+  Partition* donor = nullptr;
+  double lowest = std::numeric_limits<double>::max();
+  for (auto& kv : m_partitions) {
+    Partition& q = kv.second;
+    if (&q == p || q.stats.quota <= step) continue;
+    double u = q.utility / q.stats.quota;
+    if (u < lowest) {
+      lowest = u;
+      donor = &q;
+    }
+  }
+  // Only move capacity downhill in marginal utility, so quotas settle instead of oscillating
+  if (!donor || lowest >= p->utility / std::max(1u, p->stats.quota)) return;
+  donor->stats.quota -= step;
+  p->stats.quota += step;
+  NS_LOG_INFO("PARTITION: Moved " << step << " objects of quota after a ghost hit (quota now " << p->stats.quota
+              << ", donor now " << donor->stats.quota << ")");
+}
+
+std::vector<std::pair<std::string, HttpCacheEngine::ServiceStats>> HttpCacheEngine::GetServiceStats() const {
+  std::vector<std::pair<std::string, ServiceStats>> out;
+  out.reserve(m_partitions.size());
+  for (const auto& kv : m_partitions) out.emplace_back(kv.first, kv.second.stats);
+  std::sort(out.begin(), out.end(), [](const auto& a, const auto& b) {
+    return a.second.requests != b.second.requests ? a.second.requests > b.second.requests : a.first < b.first;
+  });
+  return out;
+}
+
+void HttpCacheEngine::PrintServiceStats(std::ostream& os, const std::string& indent, size_t maxRows) const {
+  auto services = GetServiceStats();
+  os << indent << "Per-service cache (" << services.size() << " services, busiest first):" << std::endl;
+  size_t shown = 0;
+  for (const auto& s : services) {
+    if (++shown > maxRows) break;
+    const auto& st = s.second;
+    os << indent << "  " << s.first << ": " << st.requests << " requests, " << std::fixed << std::setprecision(2)
+       << (st.requests > 0 ? 100.0 * st.hits / st.requests : 0.0) << "% hits, " << st.objects;
+    if (m_partitionMode != SHARED) os << "/" << st.quota;
+    os << " objects, " << st.evictions << " evictions";
+    if (m_partitionMode == DYNAMIC) os << ", " << st.ghostHits << " ghost hits";
+    os << std::endl;
+  }
+}
+
+void HttpCacheEngine::WriteServiceStats(std::ostream& os) const {
+  os << "service,requests,hits,hit_ratio,objects,quota,evictions,ghost_hits\n";
+  for (const auto& s : GetServiceStats()) {
+    const auto& st = s.second;
+    os << s.first << "," << st.requests << "," << st.hits << ","
+       << (st.requests > 0 ? static_cast<double>(st.hits) / st.requests : 0.0) << "," << st.objects << ","
+       << st.quota << "," << st.evictions << "," << st.ghostHits << "\n";
+  }
+}
+
+void HttpCacheEngine::ResetStats() {
+  m_totalRequests = 0;
+  m_totalHits = 0;
+  m_evictions = 0;
+  m_admissionRejects = 0;
+  for (auto& ts : m_tiers) {
+    ts.stats.hits = 0;
+    ts.stats.evictions = 0;
+    ts.stats.readSeconds = 0.0;
+  }
+  m_flash = FlashStats();
+  m_freshnessStats = FreshnessStats();
+  m_purgeStats = PurgeStats();
+  for (auto& kv : m_partitions) {
+    ServiceStats& st = kv.second.stats;
+    st.requests = 0;
+    st.hits = 0;
+    st.evictions = 0;
+    st.ghostHits = 0;
+  }
+}
+
+void HttpCacheEngine::Touch(EntryMap::iterator it, Time now){
+  // Update LRU position
+  std::list<std::string>& lru = m_tiered ? m_tiers[it->second.tier].lru : ListOf(it->second);
+  lru.splice(lru.begin(), lru, it->second.it);
+
+  // A learned TTL counts from the fetch: a hit says nothing about whether the object changed
+  if (m_adaptiveTtl && it->second.fresh.observed.IsStrictlyPositive()) return;
+
+  // Refresh TTL on access
+  Time oldExpiry = it->second.expiry;
+  Time newTtl = m_dynamicTtlEnabled ? GetEffectiveTtl(ExtractService(it->first)) : m_ttl;
+  it->second.expiry = now + newTtl;
+  NS_LOG_INFO("TOUCH: Refreshed TTL for " << it->first << " from " << oldExpiry.GetSeconds() << "s to " << it->second.expiry.GetSeconds() << "s (new TTL=" << newTtl.GetSeconds() << "s)");
+}
+
+HttpCacheEngine::LookupResult HttpCacheEngine::Access(const std::string& key, Time now, uint32_t* size, Tier* tier){
+  if (m_dynamicTtlEnabled) RecordRequest(ExtractService(key), now);
+  m_admission.Record(key);
+  m_mrc.Record(key);
+  m_totalRequests++;
+  Partition* part = TracksServices() ? GetPartition(key) : nullptr;
+  if (part) {
+    part->stats.requests++;
+    if (m_partitionMode == DYNAMIC && ++m_partitionAge >= std::max(1u, m_capacity)) {
+      // Age the ghost hit counts so quotas follow shifts in the workload
+      for (auto& kv : m_partitions) kv.second.utility *= 0.5;
+      m_partitionAge = 0;
+    }
+  }
+
+  auto it = m_map.find(key);
+  if (it == m_map.end()) {
+    NS_LOG_INFO("Cache MISS (NOT FOUND) key=" << key << " at time=" << now.GetSeconds() << "s");
+    if (part && m_partitionMode == DYNAMIC) {
+      auto ghost = part->ghostIndex.find(HttpKeyHash(key));
+      if (ghost != part->ghostIndex.end()) {
+        part->ghost.erase(ghost->second);
+        part->ghostIndex.erase(ghost);
+        GhostHit(part);
+      }
+    }
+    return MISS;
+  }
+  if (it->second.expiry <= now) {
+    NS_LOG_INFO("Cache MISS (EXPIRED) key=" << key << " at time=" << now.GetSeconds() << "s (expired at " << it->second.expiry.GetSeconds() << "s, age=" << (now - it->second.expiry).GetSeconds() << "s)");
+    return EXPIRED;
+  }
+  NS_LOG_INFO("Cache HIT key=" << key << " at time=" << now.GetSeconds() << "s (expires at " << it->second.expiry.GetSeconds() << "s)");
+  m_totalHits++;
+  if (part) part->stats.hits++;
+  if (size) *size = it->second.size;
+  Touch(it, now);
+  if (!m_tiered) return HIT;
+
+  Entry& e = it->second;
+  if (tier) *tier = e.tier;
+  m_tiers[e.tier].stats.hits++;
+  if (e.tier == SSD && m_promotionHits > 0 && ++e.ssdHits >= m_promotionHits
+      && e.size <= m_tiers[RAM].capacityBytes) {
+    Detach(it);
+    MakeRoom(RAM, e.size, now);
+    Attach(it, RAM, now);
+    m_flash.promotions++;
+    NS_LOG_INFO("PROMOTE: " << key << " to RAM");
+  }
+  return HIT;
+}
+
+HttpCacheEngine::LookupResult HttpCacheEngine::Peek(const std::string& key, Time now, uint32_t* size) const {
+  auto it = m_map.find(key);
+  if (it == m_map.end()) return MISS;
+  if (size) *size = it->second.size;
+  return it->second.expiry > now ? HIT : EXPIRED;
+}
+
+uint32_t HttpCacheEngine::GetVersion(const std::string& key) const {
+  auto it = m_map.find(key);
+  return it != m_map.end() ? it->second.fresh.version : 0;
+}
+
+void HttpCacheEngine::AddKeysTo(HttpBloomFilter& filter, Time now) const {
+  for (const auto& kv : m_map) {
+    if (kv.second.expiry > now) filter.Add(HttpKeyHash(kv.first));
+  }
+}
+
+void HttpCacheEngine::Observe(Freshness& f, uint32_t version, Time now){
+  // Versions only grow at the origin; an older copy (e.g. from a sibling) teaches nothing
+  if (version > 0 && f.version > 0 && version >= f.version) {
+    m_freshnessStats.refetches++;
+    if (version == f.version) m_freshnessStats.unchanged++;
+    f.changes += version - f.version;
+    f.observed += now - f.fetched;
+  }
+  f.version = version;
+  f.fetched = now;
+}
+
+Time HttpCacheEngine::TtlFor(const std::string& key, const Freshness& f){
+  Time base = m_dynamicTtlEnabled ? GetEffectiveTtl(ExtractService(key)) : m_ttl;
+  if (!m_adaptiveTtl || !f.observed.IsStrictlyPositive()) return base;
+  // Half an update of prior keeps the rate positive for objects never seen changing
+  double rate = (f.changes + 0.5) / f.observed.GetSeconds();
+  Time ttl = Seconds(-std::log(1.0 - m_staleTarget) / rate);
+  ttl = std::min(m_maxTtl, std::max(m_minTtl, ttl));
+  m_freshnessStats.adaptiveTtls++;
+  m_freshnessStats.adaptiveTtlSeconds += ttl.GetSeconds();
+  NS_LOG_INFO("ADAPTIVE TTL: " << key << " changed " << f.changes << " times in " << f.observed.GetSeconds()
+              << "s, TTL=" << ttl.GetSeconds() << "s");
+  return ttl;
+}
+
+void HttpCacheEngine::Insert(const std::string& key, uint32_t size, Time now, uint32_t version){
+  auto existing = m_map.find(key);
+  Freshness fresh = existing != m_map.end() ? existing->second.fresh : Freshness();
+  Observe(fresh, version, now);
+  Time ttl = TtlFor(key, fresh);
+  if (m_tiered) {
+    InsertTiered(key, size, now + ttl, now, fresh);
+    return;
+  }
+
+  // Refill of an expired entry: replace it in place
+  if (existing != m_map.end()) {
+    existing->second.expiry = now + ttl;
+    existing->second.size = size;
+    existing->second.fresh = fresh;
+    std::list<std::string>& lru = ListOf(existing->second);
+    lru.splice(lru.begin(), lru, existing->second.it);
+    NS_LOG_INFO("INSERT: Refreshed " << key << " with TTL=" << ttl.GetSeconds() << "s (expires at " << (now + ttl).GetSeconds() << "s)");
+    return;
+  }
+
+  if (m_capacity == 0) return;
+  Partition* part = TracksServices() ? GetPartition(key) : nullptr;
+  bool full = UntieredFull(part);
+  std::list<std::string>* victims = full ? VictimList(part) : nullptr;
+  if (full && !victims) {
+    NS_LOG_INFO("PARTITION: No quota for " << key);
+    return;
+  }
+  if (!m_admission.Admit(key, victims ? &victims->back() : nullptr)) {
+    NS_LOG_INFO("ADMISSION: Rejected " << key);
+    m_admissionRejects++;
+    return;
+  }
+  if (victims){ // evict LRU
+    NS_LOG_INFO("EVICTION: Evicting " << victims->back() << " to make room for " << key << " (cache full at " << m_capacity << " items)");
+    EvictUntiered(*victims, true);
+  }
+  std::list<std::string>& lru = (part && m_partitionMode != SHARED) ? part->lru : m_lru;
+  lru.push_front(key);
+  Emplace(key, Entry{now + ttl, lru.begin(), size, RAM, 0, part, fresh});
+  if (part) part->stats.objects++;
+  NS_LOG_INFO("INSERT: Cached " << key << " with TTL=" << ttl.GetSeconds() << "s (expires at " << (now + ttl).GetSeconds() << "s)");
+}
+
+HttpCacheEngine::EntryMap::iterator HttpCacheEngine::Emplace(std::string key, const Entry& e){
+  auto it = m_map.emplace(std::move(key), e).first;
+  if (m_purgeIndex) m_keyIndex.insert(&it->first);
+  return it;
+}
+
+void HttpCacheEngine::Erase(EntryMap::iterator it){
+  if (m_purgeIndex) m_keyIndex.erase(&it->first);
+  m_map.erase(it);
+}
+
+void HttpCacheEngine::Remove(EntryMap::iterator it){
+  if (m_tiered) {
+    Detach(it);
+  } else {
+    ListOf(it->second).erase(it->second.it);
+    if (it->second.part) it->second.part->stats.objects--;
+  }
+  NS_LOG_INFO("PURGE: Removed " << it->first);
+  Erase(it);
+  m_purgeStats.objects++;
+}
+
+void HttpCacheEngine::SetPurgeIndexEnabled(bool enabled){
+  m_purgeIndex = enabled;
+  m_keyIndex.clear();
+  if (!enabled) return;
+  for (const auto& kv : m_map) m_keyIndex.insert(&kv.first);
+}
+
+size_t HttpCacheEngine::RemoveKey(const std::string& key){
+  m_purgeStats.examined++;
+  auto it = m_map.find(key);
+  if (it == m_map.end()) return 0;
+  Remove(it);
+  return 1;
+}
+
+size_t HttpCacheEngine::RemoveRange(const std::string& prefix){
+  size_t n = 0;
+  auto it = m_keyIndex.lower_bound(prefix);
+  while (it != m_keyIndex.end() && (*it)->compare(0, prefix.size(), prefix) == 0) {
+    const std::string& key = **it++; // Remove() erases this index node
+    m_purgeStats.examined++;
+    Remove(m_map.find(key));
+    n++;
+  }
+  return n;
+}
+
+template <typename F>
+size_t HttpCacheEngine::RemoveWhere(F match){
+  size_t n = 0;
+  m_purgeStats.examined += m_map.size();
+  for (auto it = m_map.begin(); it != m_map.end();) {
+    auto next = std::next(it);
+    if (match(it->first)) {
+      Remove(it);
+      n++;
+    }
+    it = next;
+  }
+  return n;
+}
+
+size_t HttpCacheEngine::PurgeKey(const std::string& key){
+  m_purgeStats.purges++;
+  return RemoveKey(key);
+}
+
+size_t HttpCacheEngine::PurgePrefix(const std::string& prefix){
+  m_purgeStats.purges++;
+  if (m_purgeIndex) return RemoveRange(prefix);
+  return RemoveWhere([&prefix](const std::string& k) { return k.compare(0, prefix.size(), prefix) == 0; });
+}
+
+size_t HttpCacheEngine::PurgeService(const std::string& service){
+  m_purgeStats.purges++;
+  if (service.empty()) return 0;
+  if (!m_purgeIndex) return RemoveWhere([&service](const std::string& k) { return ExtractService(k) == service; });
+  // ExtractService() maps "/s", "/s/...", "s" and "s/..." to service s: two keys and two index ranges
+  size_t n = 0;
+  for (const std::string& root : {"/" + service, service}) {
+    n += RemoveKey(root);
+    n += RemoveRange(root + "/");
+  }
+  return n;
+}
+
+void HttpCacheEngine::SetTierModel(Tier t, uint64_t capacityBytes, Time latency, double bytesPerSecond){
+  m_tiers[t].capacityBytes = capacityBytes;
+  m_tiers[t].latency = latency;
+  m_tiers[t].bytesPerSecond = bytesPerSecond;
+}
+
+void HttpCacheEngine::SetSsdOverProvisioning(double op){
+  m_writeAmplification = op > 0 ? std::max(1.0, (1.0 + op) / (2.0 * op)) : 1.0;
+}
+
+Time HttpCacheEngine::ReadTime(Tier t, uint32_t size, Time now){
+  TierState& ts = m_tiers[t];
+  Time start = std::max(now, ts.busyUntil);
+  Time transfer = ts.bytesPerSecond > 0 ? Seconds(size / ts.bytesPerSecond) : Time(0);
+  ts.busyUntil = start + transfer;
+  Time total = (start - now) + transfer + ts.latency;
+  ts.stats.readSeconds += total.GetSeconds();
+  return total;
+}
+
+void HttpCacheEngine::WriteSsd(uint32_t size, Time now){
+  uint64_t physical = static_cast<uint64_t>(size * m_writeAmplification);
+  m_flash.logicalBytesWritten += size;
+  m_flash.physicalBytesWritten += physical;
+  TierState& ts = m_tiers[SSD];
+  if (ts.bytesPerSecond > 0) ts.busyUntil = std::max(now, ts.busyUntil) + Seconds(physical / ts.bytesPerSecond);
+}
+
+void HttpCacheEngine::Attach(EntryMap::iterator it, Tier t, Time now){
+  TierState& ts = m_tiers[t];
+  ts.lru.push_front(it->first);
+  it->second.it = ts.lru.begin();
+  it->second.tier = t;
+  it->second.ssdHits = 0;
+  ts.stats.bytesUsed += it->second.size;
+  ts.stats.objects++;
+  if (t == SSD) WriteSsd(it->second.size, now);
+}
+
+void HttpCacheEngine::Detach(EntryMap::iterator it){
+  TierState& ts = m_tiers[it->second.tier];
+  ts.lru.erase(it->second.it);
+  ts.stats.bytesUsed -= it->second.size;
+  ts.stats.objects--;
+}
+
+bool HttpCacheEngine::MakeRoom(Tier t, uint64_t need, Time now){
+  TierState& ts = m_tiers[t];
+  if (need > ts.capacityBytes) return false;
+  while (ts.stats.bytesUsed + need > ts.capacityBytes) {
+    auto victim = m_map.find(ts.lru.back());
+    Detach(victim);
+    // Expired objects would only be refetched, so they are not worth a flash write
+    if (t == RAM && m_demote && victim->second.expiry > now
+        && MakeRoom(SSD, victim->second.size, now)) {
+      Attach(victim, SSD, now);
+      m_flash.demotions++;
+      NS_LOG_INFO("DEMOTE: " << victim->first << " to SSD");
+    } else {
+      NS_LOG_INFO("EVICTION: Evicting " << victim->first << " from " << (t == RAM ? "RAM" : "SSD"));
+      Erase(victim);
+      ts.stats.evictions++;
+      m_evictions++;
+    }
+  }
+  return true;
+}
+
+void HttpCacheEngine::InsertTiered(const std::string& key, uint32_t size, Time expiry, Time now,
+                                   const Freshness& fresh){
+  // Refills of expired entries were admitted before and skip the filter
+  auto existing = m_map.find(key);
+  bool refill = existing != m_map.end();
+  if (refill) {
+    Detach(existing);
+    Erase(existing);
+  }
+  Tier t = m_insertTier;
+  const TierState& ts = m_tiers[t];
+  bool full = !ts.lru.empty() && ts.stats.bytesUsed + size > ts.capacityBytes;
+  if (!refill && !m_admission.Admit(key, full ? &ts.lru.back() : nullptr)) {
+    NS_LOG_INFO("ADMISSION: Rejected " << key);
+    m_admissionRejects++;
+    return;
+  }
+  if (!MakeRoom(t, size, now)) {
+    // Too large for the insertion tier; fall back to the other one
+    t = (t == RAM) ? SSD : RAM;
+    if (!MakeRoom(t, size, now)) return;
+  }
+  auto it = Emplace(key, Entry{expiry, {}, size, t, 0, nullptr, fresh});
+  Attach(it, t, now);
+  NS_LOG_INFO("INSERT: Cached " << key << " in " << (t == RAM ? "RAM" : "SSD") << " (expires at " << expiry.GetSeconds() << "s)");
+}
+
+namespace {
+
+// Snapshot layout (native byte order; the magic doubles as an endianness check):
+//   u32 magic, u32 version, u32 flags, u32 entry count
+//   entries, coldest first: i64 expiry - now (ns), u32 size, u32 ssdHits, u8 tier, u16 key length, key
+//   u32 bucket count; per bucket: i64 start - now (ns), u32 services; per service: u16 length, name, u32 count
+//   u32 penalized count; per service: u16 length, name
+//   u64 admission word count, words
+constexpr uint32_t kSnapshotMagic = 0x50414e53; // "SNAP"
+constexpr uint32_t kSnapshotVersion = 1;
+
+template <typename T>
+void Put(std::string& buf, T v) {
+  buf.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+void PutString(std::string& buf, const std::string& s) {
+  Put<uint16_t>(buf, static_cast<uint16_t>(s.size()));
+  buf.append(s, 0, static_cast<uint16_t>(s.size()));
+}
+
+/// Bounds-checked cursor over the mapped file; fields may be unaligned, so they are copied out
+struct SnapshotReader {
+  const char* p;
+  const char* end;
+  bool ok = true;
+
+  template <typename T>
+  T Get() {
+    T v{};
+    if (end - p < static_cast<ptrdiff_t>(sizeof(T))) { ok = false; return v; }
+    std::memcpy(&v, p, sizeof(T));
+    p += sizeof(T);
+    return v;
+  }
+  std::string GetString() {
+    uint16_t len = Get<uint16_t>();
+    if (!ok || end - p < len) { ok = false; return std::string(); }
+    std::string s(p, len);
+    p += len;
+    return s;
+  }
+};
+
+} // namespace
+
+bool HttpCacheEngine::SaveSnapshot(const std::string& path, Time now) const {
+  std::string buf;
+  buf.reserve(16 + m_map.size() * 48);
+  Put<uint32_t>(buf, kSnapshotMagic);
+  Put<uint32_t>(buf, kSnapshotVersion);
+  Put<uint32_t>(buf, (m_tiered ? 1u : 0u) | (m_dynamicTtlEnabled ? 2u : 0u));
+  Put<uint32_t>(buf, static_cast<uint32_t>(m_map.size()));
+
+  auto putList = [&](const std::list<std::string>& lru) {
+    for (auto k = lru.rbegin(); k != lru.rend(); ++k) {
+      const Entry& e = m_map.at(*k);
+      Put<int64_t>(buf, (e.expiry - now).GetNanoSeconds());
+      Put<uint32_t>(buf, e.size);
+      Put<uint32_t>(buf, e.ssdHits);
+      Put<uint8_t>(buf, e.tier);
+      PutString(buf, *k);
+    }
+  };
+  if (m_tiered) {
+    putList(m_tiers[SSD].lru);
+    putList(m_tiers[RAM].lru);
+  } else {
+    putList(m_lru);
+    for (const auto& kv : m_partitions) putList(kv.second.lru);
+  }
+
+  Put<uint32_t>(buf, static_cast<uint32_t>(m_buckets.size()));
+  for (const auto& bucket : m_buckets) {
+    Put<int64_t>(buf, (bucket.startTime - now).GetNanoSeconds());
+    Put<uint32_t>(buf, static_cast<uint32_t>(bucket.serviceRequests.size()));
+    for (const auto& pair : bucket.serviceRequests) {
+      PutString(buf, pair.first);
+      Put<uint32_t>(buf, pair.second);
+    }
+  }
+  Put<uint32_t>(buf, static_cast<uint32_t>(m_penalizedServices.size()));
+  for (const auto& service : m_penalizedServices) PutString(buf, service);
+
+  std::vector<uint64_t> admission = m_admission.SaveState();
+  Put<uint64_t>(buf, admission.size());
+  buf.append(reinterpret_cast<const char*>(admission.data()), admission.size() * sizeof(uint64_t));
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(buf.data(), buf.size());
+  if (!out) {
+    NS_LOG_WARN("Cannot write snapshot " << path);
+    return false;
+  }
+  NS_LOG_INFO("SNAPSHOT: Saved " << m_map.size() << " entries (" << buf.size() << " bytes) to " << path);
+  return true;
+}
+
+void HttpCacheEngine::DropLru(Tier t){
+  auto victim = m_map.find(m_tiers[t].lru.back());
+  Detach(victim);
+  Erase(victim);
+}
+
+int64_t HttpCacheEngine::LoadSnapshot(const std::string& path, Time now){
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    NS_LOG_WARN("Cannot open snapshot " << path);
+    return -1;
+  }
+  struct stat st;
+  void* map = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (map == MAP_FAILED) {
+    NS_LOG_WARN("Cannot map snapshot " << path);
+    return -1;
+  }
+  madvise(map, st.st_size, MADV_SEQUENTIAL);
+  SnapshotReader r{static_cast<const char*>(map), static_cast<const char*>(map) + st.st_size};
+  if (r.Get<uint32_t>() != kSnapshotMagic || r.Get<uint32_t>() != kSnapshotVersion) {
+    NS_LOG_WARN("Not a cache snapshot (or wrong version/byte order): " << path);
+    munmap(map, st.st_size);
+    return -1;
+  }
+  r.Get<uint32_t>(); // flags; the current configuration decides how entries are stored
+  uint32_t count = r.Get<uint32_t>();
+
+  m_map.clear();
+  m_keyIndex.clear();
+  m_lru.clear();
+  for (auto& kv : m_partitions) {
+    kv.second.lru.clear();
+    kv.second.stats.objects = 0;
+  }
+  for (auto& ts : m_tiers) {
+    ts.lru.clear();
+    ts.stats.bytesUsed = 0;
+    ts.stats.objects = 0;
+  }
+  m_map.reserve(count);
+
+  uint32_t duplicates = 0;
+  for (uint32_t i = 0; i < count && r.ok; ++i) {
+    Time expiry = now + NanoSeconds(r.Get<int64_t>());
+    uint32_t size = r.Get<uint32_t>();
+    uint32_t ssdHits = r.Get<uint32_t>();
+    Tier t = r.Get<uint8_t>() == SSD ? SSD : RAM;
+    std::string key = r.GetString();
+    if (!r.ok) break;
+    // SaveSnapshot() writes each key once; a repeat means a damaged file, so keep the first copy
+    if (m_map.count(key)) {
+      duplicates++;
+      continue;
+    }
+    // Entries arrive coldest first, so making room drops the coldest ones already loaded
+    if (m_tiered) {
+      TierState& ts = m_tiers[t];
+      if (size > ts.capacityBytes) continue;
+      while (ts.stats.bytesUsed + size > ts.capacityBytes) DropLru(t);
+      auto it = Emplace(std::move(key), Entry{expiry, {}, size, t, ssdHits});
+      ts.lru.push_front(it->first);
+      it->second.it = ts.lru.begin();
+      ts.stats.bytesUsed += size;
+      ts.stats.objects++;
+    } else {
+      if (m_capacity == 0) continue;
+      Partition* part = TracksServices() ? GetPartition(key) : nullptr;
+      if (UntieredFull(part)) {
+        std::list<std::string>* victims = VictimList(part);
+        if (!victims) continue;
+        EvictUntiered(*victims, false);
+      }
+      std::list<std::string>& lru = (part && m_partitionMode != SHARED) ? part->lru : m_lru;
+      auto it = Emplace(std::move(key), Entry{expiry, {}, size, RAM, 0, part});
+      lru.push_front(it->first);
+      it->second.it = lru.begin();
+      if (part) part->stats.objects++;
+    }
+  }
+
+  m_buckets.clear();
+  uint32_t buckets = r.Get<uint32_t>();
+  for (uint32_t b = 0; b < buckets && r.ok; ++b) {
+    TimeBucket bucket;
+    bucket.startTime = now + NanoSeconds(r.Get<int64_t>());
+    uint32_t services = r.Get<uint32_t>();
+    for (uint32_t s = 0; s < services && r.ok; ++s) {
+      std::string name = r.GetString();
+      bucket.serviceRequests[name] = r.Get<uint32_t>();
+    }
+    m_buckets.push_back(std::move(bucket));
+  }
+  m_penalizedServices.clear();
+  uint32_t penalized = r.Get<uint32_t>();
+  for (uint32_t s = 0; s < penalized && r.ok; ++s) m_penalizedServices.insert(r.GetString());
+
+  uint64_t words = r.Get<uint64_t>();
+  if (r.ok && words > 0 && static_cast<uint64_t>(r.end - r.p) >= words * sizeof(uint64_t)) {
+    std::vector<uint64_t> admission(words);
+    std::memcpy(admission.data(), r.p, words * sizeof(uint64_t));
+    if (!m_admission.RestoreState(admission)) {
+      NS_LOG_WARN("Snapshot admission state does not match the configured filter; starting it empty");
+    }
+  }
+  munmap(map, st.st_size);
+  if (!r.ok) NS_LOG_WARN("Snapshot " << path << " is truncated");
+  if (duplicates > 0) NS_LOG_WARN("Snapshot " << path << " repeats " << duplicates << " keys; kept the first copy of each");
+  NS_LOG_INFO("SNAPSHOT: Loaded " << m_map.size() << " of " << count << " entries from " << path);
+  return static_cast<int64_t>(m_map.size());
+}
+
+} // namespace ns3
@@ -0,0 +1,433 @@
+#pragma once
+#include "http-admission-filter.h"
+#include "http-mrc-estimator.h"
+#include "ns3/nstime.h"
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <ostream>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Network-independent cache state: LRU storage, TTL and dynamic TTL policy
+ *
+ * All methods take the current time explicitly, so the engine can be driven
+ * either by HttpCacheApp from inside a packet-level simulation or directly by
+ * a standalone workload loop (see examples/http-cache-policy-sim.cc). Both
+ * paths share this code, which keeps their hit/miss decisions identical.
+ *
+ * Storage is a single LRU bounded by object count unless tiering is enabled.
+ * Tiered storage has a RAM tier in front of an SSD tier, each bounded in
+ * bytes and with its own access latency and bandwidth:
+ * - new objects go to RAM (or straight to SSD, see SetInsertTier());
+ * - RAM LRU victims are demoted to SSD, or dropped if demotion is disabled;
+ * - an SSD entry is promoted back to RAM on its Nth hit (0 = never);
+ * - every byte written to SSD is multiplied by a write-amplification factor
+ *   derived from the spare-area fraction, to estimate flash wear.
+ *
+ * An optional HttpAdmissionFilter decides whether a missed object is stored
+ * at all, keeping one-hit wonders from pushing popular objects out. An
+ * optional HttpMrcEstimator observes every request and estimates the hit
+ * ratio the cache would reach at other capacities.
+ *
+ * The object-count LRU can also be partitioned by service (see
+ * SetPartitioning()), giving each service its own LRU list and quota.
+ *
+ * Entries remember the origin version they were fetched with, so refills
+ * measure how often each object changes; SetAdaptiveTtl() turns that into a
+ * per-object TTL.
+ *
+ * Objects can be purged by exact key, key prefix or service. An optional
+ * sorted key index (SetPurgeIndexEnabled()) makes prefix and service purges
+ * cost time proportional to the objects they remove instead of the cache size.
+ */
+class HttpCacheEngine {
+public:
+  enum LookupResult { MISS, HIT, EXPIRED };
+  enum Tier : uint8_t { RAM = 0, SSD = 1 };
+
+  struct TierStats {
+    uint64_t hits = 0;
+    uint64_t evictions = 0;       ///< objects dropped from this tier (not demoted)
+    uint64_t bytesUsed = 0;
+    uint64_t objects = 0;
+    double readSeconds = 0.0;     ///< summed ReadTime() over hits served by this tier
+  };
+  /// Capacity split across services; see SetPartitioning()
+  enum PartitionMode { SHARED, STATIC, WEIGHTED, DYNAMIC };
+
+  struct ServiceStats {
+    uint32_t quota = 0;           ///< objects the partition may hold (0 when SHARED)
+    uint32_t objects = 0;
+    uint64_t requests = 0;
+    uint64_t hits = 0;
+    uint64_t evictions = 0;
+    uint64_t ghostHits = 0;       ///< misses on keys the partition evicted recently
+  };
+  struct FreshnessStats {
+    uint64_t refetches = 0;       ///< refills of a stored versioned entry
+    uint64_t unchanged = 0;       ///< refills that fetched the version already stored
+    uint64_t adaptiveTtls = 0;    ///< insertions that used a learned TTL
+    double adaptiveTtlSeconds = 0.0; ///< sum of those TTLs
+  };
+  struct PurgeStats {
+    uint64_t purges = 0;
+    uint64_t objects = 0;         ///< objects removed by purges
+    uint64_t examined = 0;        ///< keys looked at to find them
+  };
+  struct FlashStats {
+    uint64_t promotions = 0;      ///< SSD -> RAM moves
+    uint64_t demotions = 0;       ///< RAM -> SSD moves
+    uint64_t logicalBytesWritten = 0;
+    uint64_t physicalBytesWritten = 0; ///< logical bytes x write amplification
+  };
+
+  void SetTtl(Time t) { m_ttl = t; }
+  void SetCapacity(uint32_t entries) { m_capacity = entries; Rebalance(nullptr); }
+  void SetDynamicTtlEnabled(bool enabled) { m_dynamicTtlEnabled = enabled; }
+  void SetTtlWindow(Time window) { m_ttlWindow = window; }
+  void SetTtlThreshold(double threshold) { m_ttlThreshold = threshold; }
+  void SetTtlReduction(double reduction) { m_ttlReduction = reduction; }
+  void SetTtlEvalInterval(Time interval) { m_ttlEvalInterval = interval; }
+
+  /**
+   * \brief Learn a freshness lifetime per object from its observed change rate
+   *
+   * Each refill compares the fetched version with the stored one, adding the
+   * difference to the object's change count and the copy's age to its
+   * observed time. With rate = (changes + 1/2) / observed, the TTL is the age
+   * at which a Poisson-updated copy is still current with probability
+   * 1 - \p staleTarget: -ln(1 - staleTarget) / rate, clamped to
+   * [\p minTtl, \p maxTtl]. Objects not yet refilled get the configured TTL.
+   * Hits do not extend a learned TTL, so it counts from the fetch. Overrides
+   * the dynamic TTL for objects with observations.
+   */
+  void SetAdaptiveTtl(bool enabled, double staleTarget = 0.1, Time minTtl = Seconds(1), Time maxTtl = Seconds(3600)) {
+    m_adaptiveTtl = enabled;
+    m_staleTarget = std::min(0.99, std::max(1e-6, staleTarget));
+    m_minTtl = minTtl;
+    m_maxTtl = std::max(minTtl, maxTtl);
+  }
+  /**
+   * \brief Keep a sorted index of the stored keys for purges
+   *
+   * Prefix and service purges then walk only the index range of matching
+   * keys; without the index they scan every entry. Costs one ordered-set
+   * insertion and removal per stored object. Can be switched on at any time.
+   */
+  void SetPurgeIndexEnabled(bool enabled);
+  /// Switch from the object-count LRU to byte-bounded RAM + SSD tiers
+  void SetTieredEnabled(bool enabled) { m_tiered = enabled; }
+  /**
+   * \brief Configure one storage tier
+   * \param capacityBytes tier size in bytes
+   * \param latency fixed access latency
+   * \param bytesPerSecond sequential bandwidth; reads and writes share it
+   */
+  void SetTierModel(Tier t, uint64_t capacityBytes, Time latency, double bytesPerSecond);
+  /// Tier that receives newly fetched objects
+  void SetInsertTier(Tier t) { m_insertTier = t; }
+  /// Promote an SSD entry to RAM on its Nth hit there (0 = never promote)
+  void SetPromotionHits(uint32_t n) { m_promotionHits = n; }
+  /// Write RAM victims to SSD instead of dropping them
+  void SetDemotionEnabled(bool enabled) { m_demote = enabled; }
+  /**
+   * \brief Set the SSD spare-area (over-provisioning) fraction
+   *
+   * Write amplification is estimated as (1 + op) / (2 op), the greedy garbage
+   * collection approximation for uniformly random overwrites.
+   */
+  void SetSsdOverProvisioning(double op);
+  /// Gate insertions of new objects; see HttpAdmissionFilter::Configure
+  void SetAdmission(HttpAdmissionFilter::Mode mode, uint64_t expectedItems, uint64_t sampleSize = 0) {
+    m_admission.Configure(mode, expectedItems, sampleSize);
+  }
+  /// Track a miss-ratio curve; see HttpMrcEstimator::Configure
+  void SetMrcEstimation(double rate, uint32_t maxKeys, uint32_t binObjects) {
+    m_mrc.Configure(rate, maxKeys, binObjects);
+  }
+
+  /**
+   * \brief Split the object-count LRU into one partition per service
+   *
+   * - SHARED: one LRU for all services (default);
+   * - STATIC: services given a SetServiceQuota() keep it, the others share
+   *   what is left equally;
+   * - WEIGHTED: capacity in proportion to SetServiceWeight() (default 1);
+   * - DYNAMIC: starts from equal shares; each miss on a key in a partition's
+   *   ghost list (hashes of its recent victims) moves \p step objects of quota
+   *   to it from the partition with the fewest recent ghost hits per object,
+   *   so capacity drifts to where an extra slot gains the most hits.
+   *
+   * A partition below its quota grows by taking the LRU entry of the
+   * partition furthest over its own quota; at its quota it evicts its own
+   * LRU entry. Configure before the first request; not applied to tiered
+   * storage.
+   * \param step DYNAMIC reallocation unit in objects (0 = capacity / 1000, at least 1)
+   */
+  void SetPartitioning(PartitionMode mode, uint32_t step = 0);
+  /// STATIC quota for one service, in objects
+  void SetServiceQuota(const std::string& service, uint32_t objects);
+  /// WEIGHTED share for one service
+  void SetServiceWeight(const std::string& service, double weight);
+  /// Apply "service:value,..." as quotas (STATIC) or weights (WEIGHTED); false if malformed
+  bool SetPartitionShares(const std::string& list);
+  /// Collect per-service statistics without partitioning (for comparison with dynamic TTL)
+  void SetServiceStatsEnabled(bool enabled) { m_serviceStats = enabled; }
+  static bool ParsePartitionMode(const std::string& name, PartitionMode* mode);
+
+  Time GetTtl() const { return m_ttl; }
+  uint32_t GetCapacity() const { return m_capacity; }
+  bool IsDynamicTtlEnabled() const { return m_dynamicTtlEnabled; }
+  Time GetTtlEvalInterval() const { return m_ttlEvalInterval; }
+  bool IsTieredEnabled() const { return m_tiered; }
+  bool IsAdaptiveTtlEnabled() const { return m_adaptiveTtl; }
+  double GetWriteAmplification() const { return m_writeAmplification; }
+
+  /**
+   * \brief Account a client request and look the key up
+   *
+   * Counts the request (and the hit), feeds the dynamic TTL statistics and,
+   * on a hit, refreshes the entry's LRU position and TTL.
+   * \param size if non-null, receives the cached object size on a hit
+   * \param tier if non-null, receives the tier that served a hit (before any promotion)
+   */
+  LookupResult Access(const std::string& key, Time now, uint32_t* size = nullptr, Tier* tier = nullptr);
+  /// Look \p key up without counting a request or touching the LRU; EXPIRED entries are still stored
+  LookupResult Peek(const std::string& key, Time now, uint32_t* size = nullptr) const;
+  /// Version \p key was stored with; 0 if it is not stored or unversioned
+  uint32_t GetVersion(const std::string& key) const;
+  /// Add the hash of every unexpired key to \p filter (a digest for sibling caches)
+  void AddKeysTo(HttpBloomFilter& filter, Time now) const;
+  /**
+   * \brief Time to read \p size bytes from a tier starting at \p now
+   *
+   * Latency plus transfer time, queued behind earlier transfers on the same
+   * tier so that bandwidth saturates under load. Adds to the tier's readSeconds.
+   */
+  Time ReadTime(Tier t, uint32_t size, Time now);
+  /**
+   * \brief Store (or replace) an object, evicting the LRU entry when full
+   * \param version origin version of the object (0 = unversioned)
+   */
+  void Insert(const std::string& key, uint32_t size, Time now, uint32_t version = 0);
+  /**
+   * \brief Remove objects at once, whatever their expiry
+   *
+   * Purged objects are dropped from every tier and partition; they do not
+   * count as evictions.
+   * \return number of objects removed
+   */
+  size_t PurgeKey(const std::string& key);
+  /// Remove every key starting with \p prefix; see PurgeKey()
+  size_t PurgePrefix(const std::string& prefix);
+  /// Remove every key whose ExtractService() is \p service; see PurgeKey()
+  size_t PurgeService(const std::string& service);
+  /// Recompute the set of penalized services from the sliding window
+  void EvaluatePolicy(Time now);
+  /// Zero the request, hit, eviction and flash counters; contents and policy state are kept
+  void ResetStats();
+
+  /**
+   * \brief Write the cache contents to a binary snapshot
+   *
+   * Stores every entry in LRU order per tier with its size, tier, SSD hit
+   * count and expiry relative to \p now, the dynamic TTL buckets and
+   * penalized services, and the admission filter's frequency state.
+   * Counters (requests, hits, evictions, flash writes) and object versions
+   * are not included.
+   * \return false if the file cannot be written
+   */
+  bool SaveSnapshot(const std::string& path, Time now) const;
+  /**
+   * \brief Replace the cache contents with a snapshot taken by SaveSnapshot()
+   *
+   * The file is memory-mapped and entries are linked straight into the LRU
+   * lists, without admission checks or flash accounting. Expiry times and
+   * buckets are shifted so that \p now corresponds to the time of the save.
+   * If the current configuration holds less than the snapshot, the least
+   * recently used entries are dropped. Admission state is restored only if
+   * the filter is configured with the same sizes.
+   * A truncated file loads the entries it holds, and a repeated key keeps
+   * its first copy, each with a warning.
+   * \return number of entries loaded, or -1 if the file is missing or not a snapshot
+   */
+  int64_t LoadSnapshot(const std::string& path, Time now);
+
+  Time GetEffectiveTtl(const std::string& service) const;
+  static std::string ExtractService(const std::string& resource);
+
+  size_t GetSize() const { return m_map.size(); }
+  uint64_t GetTotalRequests() const { return m_totalRequests; }
+  uint64_t GetTotalHits() const { return m_totalHits; }
+  uint64_t GetEvictions() const { return m_evictions; }
+  const TierStats& GetTierStats(Tier t) const { return m_tiers[t].stats; }
+  const FlashStats& GetFlashStats() const { return m_flash; }
+  const FreshnessStats& GetFreshnessStats() const { return m_freshnessStats; }
+  const PurgeStats& GetPurgeStats() const { return m_purgeStats; }
+  const HttpAdmissionFilter& GetAdmissionFilter() const { return m_admission; }
+  /// Fetched objects the admission filter kept out of the cache
+  uint64_t GetAdmissionRejects() const { return m_admissionRejects; }
+  const HttpMrcEstimator& GetMrcEstimator() const { return m_mrc; }
+  PartitionMode GetPartitionMode() const { return m_partitionMode; }
+  /// Per-service counters, busiest service first; empty unless partitioning or service stats are enabled
+  std::vector<std::pair<std::string, ServiceStats>> GetServiceStats() const;
+  /// Print a heading and the \p maxRows busiest services, one line each, every line prefixed by \p indent
+  void PrintServiceStats(std::ostream& os, const std::string& indent, size_t maxRows = 10) const;
+  /// Write every service's counters as CSV, header row first
+  void WriteServiceStats(std::ostream& os) const;
+
+private:
+  struct Partition {
+    ServiceStats stats;
+    std::list<std::string> lru;   ///< unused when SHARED
+    double weight = 1.0;
+    bool fixedQuota = false;      ///< STATIC quota set explicitly
+    double utility = 0.0;         ///< decayed ghost hit count (DYNAMIC)
+    std::list<uint64_t> ghost;    ///< victim key hashes, newest first (DYNAMIC)
+    std::unordered_map<uint64_t, std::list<uint64_t>::iterator> ghostIndex;
+  };
+  /// Version history of an object, carried across refills
+  struct Freshness {
+    uint32_t version = 0;         ///< version stored (0 = unversioned)
+    Time fetched;                 ///< when the stored copy was fetched
+    uint32_t changes = 0;         ///< updates seen across refills
+    Time observed;                ///< time covered by those refills
+  };
+  struct Entry {
+    Time expiry;
+    std::list<std::string>::iterator it;
+    uint32_t size;
+    Tier tier;
+    uint32_t ssdHits; ///< hits while on SSD, for promotion
+    Partition* part = nullptr; ///< owning service, when service stats are tracked
+    Freshness fresh{};
+  };
+  using EntryMap = std::unordered_map<std::string, Entry>;
+  /// Orders pointers to the (address-stable) keys of EntryMap nodes by key, and compares them with strings
+  struct KeyOrder {
+    using is_transparent = void;
+    bool operator()(const std::string* a, const std::string* b) const { return *a < *b; }
+    bool operator()(const std::string* a, const std::string& b) const { return *a < b; }
+    bool operator()(const std::string& a, const std::string* b) const { return a < *b; }
+  };
+  struct TierState {
+    uint64_t capacityBytes = 0;
+    Time latency;
+    double bytesPerSecond = 0.0;
+    Time busyUntil;                ///< end of the last transfer on this tier
+    std::list<std::string> lru;
+    TierStats stats;
+  };
+
+  void Touch(EntryMap::iterator it, Time now);
+  /// Add an entry to m_map (and the purge index)
+  EntryMap::iterator Emplace(std::string key, const Entry& e);
+  /// Erase an entry already unlinked from its LRU list
+  void Erase(EntryMap::iterator it);
+  /// Unlink and erase an entry, as a purge does
+  void Remove(EntryMap::iterator it);
+  /// Purge helpers; each counts what it examines and removes
+  size_t RemoveKey(const std::string& key);
+  size_t RemoveRange(const std::string& prefix);
+  template <typename F>
+  size_t RemoveWhere(F match);
+  void InsertTiered(const std::string& key, uint32_t size, Time expiry, Time now, const Freshness& fresh);
+  /// Account a refill that brought \p version into \p f and make it the stored copy
+  void Observe(Freshness& f, uint32_t version, Time now);
+  /// TTL for a copy of \p key with history \p f
+  Time TtlFor(const std::string& key, const Freshness& f);
+  /// Free bytes in a tier by demoting or evicting its LRU entries; false if \p need can never fit
+  bool MakeRoom(Tier t, uint64_t need, Time now);
+  /// Link an entry at the MRU end of a tier (the tier must have room)
+  void Attach(EntryMap::iterator it, Tier t, Time now);
+  /// Unlink an entry from its tier without erasing it
+  void Detach(EntryMap::iterator it);
+  void WriteSsd(uint32_t size, Time now);
+  /// Drop the LRU entry of a tier without demotion
+  void DropLru(Tier t);
+  void RecordRequest(const std::string& service, Time now);
+
+  bool TracksServices() const { return !m_tiered && (m_serviceStats || m_partitionMode != SHARED); }
+  /// Partition of \p key's service, created on first use
+  Partition* GetPartition(const std::string& key);
+  /// Recompute quotas after the partition set or the configuration changed
+  void Rebalance(Partition* added);
+  /// LRU list an untiered entry lives in
+  std::list<std::string>& ListOf(const Entry& e) { return e.part && m_partitionMode != SHARED ? e.part->lru : m_lru; }
+  /// Whether storing a new untiered entry for \p p requires an eviction first
+  bool UntieredFull(const Partition* p) const;
+  /// List that gives up its LRU entry when \p p needs a slot; nullptr if \p p cannot hold anything
+  std::list<std::string>* VictimList(Partition* p);
+  /// Drop the LRU entry of an untiered list, updating its partition
+  void EvictUntiered(std::list<std::string>& lru, bool count);
+  /// Quota moves towards \p p after a ghost hit (DYNAMIC)
+  void GhostHit(Partition* p);
+
+  Time m_ttl{Seconds(5)};
+  uint32_t m_capacity = 64;
+
+  // LRU structures
+  std::list<std::string> m_lru;
+  EntryMap m_map;
+
+  // Tiered storage
+  bool m_tiered = false;
+  TierState m_tiers[2];
+  Tier m_insertTier = RAM;
+  uint32_t m_promotionHits = 1;
+  bool m_demote = true;
+  double m_writeAmplification = 1.0; ///< 1.0 until SetSsdOverProvisioning()
+  FlashStats m_flash;
+
+  HttpAdmissionFilter m_admission;
+  uint64_t m_admissionRejects = 0;
+  HttpMrcEstimator m_mrc;
+
+  // Per-service partitions
+  bool m_serviceStats = false;
+  PartitionMode m_partitionMode = SHARED;
+  uint32_t m_partitionStep = 0; ///< 0 = capacity / 1000
+  uint64_t m_partitionAge = 0;  ///< requests since the DYNAMIC utilities were last halved
+  std::unordered_map<std::string, Partition> m_partitions;
+
+  // Dynamic TTL policy
+  struct TimeBucket {
+    Time startTime;
+    std::unordered_map<std::string, uint32_t> serviceRequests;
+  };
+  std::list<TimeBucket> m_buckets;
+  std::unordered_set<std::string> m_penalizedServices;
+
+  bool m_dynamicTtlEnabled = false;
+  Time m_ttlWindow{Seconds(300)};
+  double m_ttlThreshold = 0.5;
+  double m_ttlReduction = 0.5;
+  Time m_ttlEvalInterval{Seconds(30)};
+  Time m_bucketDuration{Seconds(10)};
+
+  // Adaptive per-object TTL
+  bool m_adaptiveTtl = false;
+  double m_staleTarget = 0.1;
+  Time m_minTtl{Seconds(1)};
+  Time m_maxTtl{Seconds(3600)};
+  FreshnessStats m_freshnessStats;
+
+  // Purges
+  bool m_purgeIndex = false;
+  std::set<const std::string*, KeyOrder> m_keyIndex;
+  PurgeStats m_purgeStats;
+
+  uint64_t m_totalRequests = 0;
+  uint64_t m_totalHits = 0;
+  uint64_t m_evictions = 0;
+};
+
+} // namespace ns3
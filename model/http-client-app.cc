@@ -1,7 +1,10 @@
+#include <algorithm>
 #include <cmath>
 #include "http-client-app.h"
 #include "http-header.h"
+#include "http-stats-collector.h"
 #include "ns3/log.h"
+#include "ns3/trace-source-accessor.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/uinteger.h"
@@ -14,7 +17,10 @@ NS_LOG_COMPONENT_DEFINE("HttpClientApp");
 TypeId HttpClientApp::GetTypeId() {
   static TypeId tid = TypeId("ns3::HttpClientApp")
     .SetParent<Application>()
-    .AddConstructor<HttpClientApp>();
+    .AddConstructor<HttpClientApp>()
+    .AddTraceSource("Response", "A response was delivered: (latency, cache hit)",
+                    MakeTraceSourceAccessor(&HttpClientApp::m_responseTrace),
+                    "ns3::HttpClientApp::ResponseTracedCallback");
   return tid;
 }
 
@@ -37,8 +43,44 @@ void HttpClientApp::SetSegmentInterval(Time t) { m_segmentInterval = t; }
 void HttpClientApp::SetTotalTime(Time t) { m_totalTime = t; }
 void HttpClientApp::SetStreaming(bool s) { m_streaming = s; }
 
-void HttpClientApp::SetObjectSize(uint32_t size) {
-  m_objectSize = size;
+void HttpClientApp::SetRequestHeaderSize(uint32_t bytes) { m_requestHeaderBytes = bytes; }
+
+void HttpClientApp::SetExternallyDriven(bool driven) { m_externallyDriven = driven; }
+void HttpClientApp::AddResponseCallback(Callback<void, Time, bool> cb) { m_responseTrace.ConnectWithoutContext(cb); }
+
+void HttpClientApp::SetLossTimeout(Time t) { m_lossTimeout = t; }
+void HttpClientApp::SetStatsCollector(Ptr<HttpStatsCollector> collector) { m_collector = collector; }
+
+void HttpClientApp::ContentStats::AddResponse(double latencyMs, bool hit){
+  totalRequests++;
+  if (hit) {
+    cacheHits++;
+    totalHitLatency += latencyMs;
+  } else {
+    cacheMisses++;
+    totalMissLatency += latencyMs;
+  }
+  totalLatency += latencyMs;
+  minLatency = std::min(minLatency, latencyMs);
+  maxLatency = std::max(maxLatency, latencyMs);
+}
+
+void HttpClientApp::ContentStats::Merge(const ContentStats& o){
+  totalRequests += o.totalRequests;
+  cacheHits += o.cacheHits;
+  cacheMisses += o.cacheMisses;
+  totalLatency += o.totalLatency;
+  totalHitLatency += o.totalHitLatency;
+  totalMissLatency += o.totalMissLatency;
+  minLatency = std::min(minLatency, o.minLatency);
+  maxLatency = std::max(maxLatency, o.maxLatency);
+  unavailable += o.unavailable;
+  lost += o.lost;
+}
+
+void HttpClientApp::SetDirectPath(Callback<bool, std::string, uint32_t, uint32_t, uint32_t> direct, Time until) {
+  m_direct = direct;
+  m_directUntil = until;
 }
 
 void HttpClientApp::StartApplication(){
@@ -78,9 +120,10 @@ void HttpClientApp::StartApplication(){
       }
     }
   }
-  ScheduleNext();
+  if (!m_externallyDriven) ScheduleNext();
 }
 void HttpClientApp::StopApplication(){
+  Simulator::Cancel(m_lossEvent);
   if (m_socket) m_socket->Close();
   if (m_csv.is_open()) m_csv.close();
   WriteSummary();
@@ -112,15 +155,7 @@ std::string HttpClientApp::PickResource(){
 
   // Streaming mode: pick or continue a service sequence
   if (!m_inSequence) {
-    // pick a service index
-    uint32_t sidx = 0;
-    if (m_zipf && !m_zipfCum.empty()){
-      double r = m_uni->GetValue(0.0, 1.0);
-      for (uint32_t i=0;i<m_zipfCum.size();++i){ if (m_zipfCum[i] >= r){ sidx = i; break; } }
-    } else {
-      sidx = (uint32_t) m_uni->GetInteger(0, (int64_t)m_numServices-1);
-    }
-    m_currentService = sidx + 1; // services are 1-based in names
+    m_currentService = PickService();
     m_nextSegment = 1;
     m_inSequence = true;
   }
@@ -136,15 +171,66 @@ std::string HttpClientApp::PickResource(){
   return res;
 }
 
-void HttpClientApp::SendOne(){
+uint32_t HttpClientApp::PickService(){
+  uint32_t sidx = 0;
+  if (m_zipf && !m_zipfCum.empty()){
+    double r = m_uni->GetValue(0.0, 1.0);
+    for (uint32_t i=0;i<m_zipfCum.size();++i){ if (m_zipfCum[i] >= r){ sidx = i; break; } }
+  } else {
+    sidx = (uint32_t) m_uni->GetInteger(0, (int64_t)m_numServices-1);
+  }
+  return sidx + 1; // services are 1-based in names
+}
+
+uint32_t HttpClientApp::SendRequest(const std::string& res, uint32_t size, uint32_t rangeStart, uint32_t rangeLength){
+  if (!m_socket) return 0; // not started yet
+  if (!m_direct.IsNull() && Simulator::Now() < m_directUntil) {
+    m_direct(res, size, rangeStart, rangeLength);
+    m_directRequests++;
+    return 0;
+  }
   uint32_t id = m_nextId++;
-  Ptr<Packet> p = Create<Packet>(m_objectSize);
-  std::string res = PickResource();
-  HttpHeader hdr(id, res);
+  Ptr<Packet> p = Create<Packet>(m_requestHeaderBytes);
+  HttpHeader hdr(id, res, size);
+  hdr.SetRange(rangeStart, rangeLength);
   p->AddHeader(hdr);
-  m_sendTimes[id] = std::make_pair(Simulator::Now(), res);
+  m_inFlight.Insert(id, Simulator::Now()) = Intern(res);
   NS_LOG_INFO("Client sending id=" << id << " res=" << res);
   m_socket->Send(p);
+  if (m_lossTimeout.IsStrictlyPositive() && !m_lossEvent.IsPending()) {
+    m_lossEvent = Simulator::Schedule(m_lossTimeout, &HttpClientApp::ExpireRequests, this);
+  }
+  return id;
+}
+
+uint32_t HttpClientApp::Intern(const std::string& res){
+  if (m_collector) return m_collector->Intern(res);
+  auto ins = m_contentIds.emplace(res, static_cast<uint32_t>(m_contentNames.size()));
+  if (ins.second) m_contentNames.push_back(&ins.first->first);
+  return ins.first->second;
+}
+
+const std::string& HttpClientApp::GetContentName(uint32_t id) const {
+  return m_collector ? m_collector->GetName(id) : *m_contentNames[id];
+}
+
+void HttpClientApp::ExpireRequests(){
+  Time now = Simulator::Now();
+  m_inFlight.Expire(now - m_lossTimeout, [this](uint32_t id, uint32_t content) {
+    NS_LOG_INFO("Client request id=" << id << " lost");
+    m_lost++;
+    if (m_collector) m_collector->RecordLost(content);
+    if (KeepsOwnStats()) m_contentStats[GetContentName(content)].lost++;
+  });
+  // Sleep until the next outstanding request is due
+  Time oldest;
+  if (m_inFlight.GetOldest(&oldest)) {
+    m_lossEvent = Simulator::Schedule(oldest + m_lossTimeout - now, &HttpClientApp::ExpireRequests, this);
+  }
+}
+
+void HttpClientApp::SendOne(){
+  SendRequest(PickResource());
   // increment sent counter in non-streaming mode to preserve behavior
   if (!m_streaming) m_sent++;
   ScheduleNext();
@@ -154,35 +240,39 @@ void HttpClientApp::HandleRead(Ptr<Socket> socket){
   Address from; Ptr<Packet> p;
   while ((p = socket->RecvFrom(from))){
     HttpHeader hdr; p->RemoveHeader(hdr);
-    auto it = m_sendTimes.find(hdr.GetRequestId());
-    if (it != m_sendTimes.end()){
-      Time s = it->second.first;
-      std::string content = it->second.second;
-      Time r = Simulator::Now();
-      double lat_ms = (r - s).GetMilliSeconds();
-      bool hit = (!hdr.GetResource().empty() && hdr.GetResource().back()=='H');
-      NS_LOG_INFO("Client recv id=" << hdr.GetRequestId() << " hit=" << (hit?1:0));
-      if (m_csv.is_open()) {
-        m_csv << hdr.GetRequestId() << "," << content << "," << s.GetSeconds() << "," << r.GetSeconds()
-              << "," << lat_ms << "," << (hit?1:0) << "\n";
-      }
+    Time s;
+    const uint32_t* interned = m_inFlight.Find(hdr.GetRequestId(), &s);
+    if (!interned) {
+      // Answer to a request that already timed out
+      m_late++;
+      continue;
+    }
+    uint32_t id = *interned;
+    const std::string& content = GetContentName(id);
+    m_inFlight.Erase(hdr.GetRequestId());
+    if (hdr.GetStatus() != HttpHeader::OK) {
+      // Shed upstream: no object was delivered, so keep it out of the latency statistics
+      NS_LOG_INFO("Client recv id=" << hdr.GetRequestId() << " unavailable");
+      if (m_collector) m_collector->RecordUnavailable(id);
+      if (KeepsOwnStats()) m_contentStats[content].unavailable++;
+      OnUnavailable(content);
+      continue;
+    }
+    Time r = Simulator::Now();
+    double lat_ms = (r - s).GetMilliSeconds();
+    bool hit = (!hdr.GetResource().empty() && hdr.GetResource().back()=='H');
+    NS_LOG_INFO("Client recv id=" << hdr.GetRequestId() << " hit=" << (hit?1:0));
+    if (m_csv.is_open()) {
+      m_csv << hdr.GetRequestId() << "," << content << "," << s.GetSeconds() << "," << r.GetSeconds()
+            << "," << lat_ms << "," << (hit?1:0) << "\n";
+    }
 
-      // Update per-content statistics
-      auto& stats = m_contentStats[content];
-      stats.totalRequests++;
-      if (hit) {
-        stats.cacheHits++;
-        stats.totalHitLatency += lat_ms;
-      } else {
-        stats.cacheMisses++;
-        stats.totalMissLatency += lat_ms;
-      }
-      stats.totalLatency += lat_ms;
-      stats.minLatency = std::min(stats.minLatency, lat_ms);
-      stats.maxLatency = std::max(stats.maxLatency, lat_ms);
+    // Update per-content statistics
+    if (m_collector) m_collector->RecordResponse(id, lat_ms, hit);
+    if (KeepsOwnStats()) m_contentStats[content].AddResponse(lat_ms, hit);
 
-      m_sendTimes.erase(it);
-    }
+    m_responseTrace(r - s, hit);
+    OnResponse(content, r - s, hit, hdr.GetObjectSize());
   }
 }
 
@@ -190,31 +280,37 @@ void HttpClientApp::WriteSummary(){
   if (m_summaryCsvPath.empty()) return;
 
   std::ofstream summary(m_summaryCsvPath, std::ios::out);
-  summary << "content,total_requests,cache_hits,cache_misses,hit_rate_percent,avg_latency_ms,min_latency_ms,max_latency_ms,avg_hit_latency_ms,avg_miss_latency_ms\n";
-
-  for (const auto& pair : m_contentStats){
-    const std::string& content = pair.first;
-    const ContentStats& stats = pair.second;
-
-    double hitRate = (stats.totalRequests > 0) ? (100.0 * stats.cacheHits / stats.totalRequests) : 0.0;
-    double avgLatency = (stats.totalRequests > 0) ? (stats.totalLatency / stats.totalRequests) : 0.0;
-    double avgHitLatency = (stats.cacheHits > 0) ? (stats.totalHitLatency / stats.cacheHits) : 0.0;
-    double avgMissLatency = (stats.cacheMisses > 0) ? (stats.totalMissLatency / stats.cacheMisses) : 0.0;
-
-    summary << content << ","
-            << stats.totalRequests << ","
-            << stats.cacheHits << ","
-            << stats.cacheMisses << ","
-            << hitRate << ","
-            << avgLatency << ","
-            << stats.minLatency << ","
-            << stats.maxLatency << ","
-            << avgHitLatency << ","
-            << avgMissLatency << "\n";
-  }
+  WriteSummaryHeader(summary, "content");
+  for (const auto& pair : m_contentStats) WriteSummaryRow(summary, pair.first, pair.second);
   summary.close();
 }
 
+void HttpClientApp::WriteSummaryHeader(std::ostream& os, const char* firstColumn){
+  os << firstColumn << ",total_requests,cache_hits,cache_misses,hit_rate_percent,avg_latency_ms,min_latency_ms,"
+     << "max_latency_ms,avg_hit_latency_ms,avg_miss_latency_ms,unavailable,lost\n";
+}
+
+void HttpClientApp::WriteSummaryRow(std::ostream& os, const std::string& name, const ContentStats& stats){
+  double hitRate = (stats.totalRequests > 0) ? (100.0 * stats.cacheHits / stats.totalRequests) : 0.0;
+  double avgLatency = (stats.totalRequests > 0) ? (stats.totalLatency / stats.totalRequests) : 0.0;
+  double avgHitLatency = (stats.cacheHits > 0) ? (stats.totalHitLatency / stats.cacheHits) : 0.0;
+  double avgMissLatency = (stats.cacheMisses > 0) ? (stats.totalMissLatency / stats.cacheMisses) : 0.0;
+  // Rows of content that was only shed or lost have no latencies; minLatency still holds its sentinel
+  double minLatency = (stats.totalRequests > 0) ? stats.minLatency : 0.0;
+  os << name << ","
+     << stats.totalRequests << ","
+     << stats.cacheHits << ","
+     << stats.cacheMisses << ","
+     << hitRate << ","
+     << avgLatency << ","
+     << minLatency << ","
+     << stats.maxLatency << ","
+     << avgHitLatency << ","
+     << avgMissLatency << ","
+     << stats.unavailable << ","
+     << stats.lost << "\n";
+}
+
 const std::unordered_map<std::string, HttpClientApp::ContentStats>& HttpClientApp::GetContentStats() const {
   return m_contentStats;
 }
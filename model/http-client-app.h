@@ -3,15 +3,21 @@
 #include "ns3/socket.h"
 #include "ns3/event-id.h"
 #include "ns3/address.h"
+#include "ns3/callback.h"
+#include "ns3/traced-callback.h"
 #include "ns3/nstime.h"
 #include "ns3/random-variable-stream.h"
+#include "http-inflight-table.h"
 #include <unordered_map>
 #include <fstream>
+#include <ostream>
 #include <string>
 #include <vector>
 
 namespace ns3 {
 
+class HttpStatsCollector;
+
 class HttpClientApp : public Application {
 public:
   static TypeId GetTypeId();
@@ -27,7 +33,15 @@ public:
     double totalMissLatency = 0.0;
     double minLatency = 1e9;
     double maxLatency = 0.0;
+    uint32_t unavailable = 0; ///< requests shed by an overloaded server
+    uint32_t lost = 0;        ///< requests with no response within the loss timeout
+
+    void AddResponse(double latencyMs, bool hit);
+    void Merge(const ContentStats& o);
   };
+  /// Summary CSV header; the first column names what a row describes (content, service)
+  static void WriteSummaryHeader(std::ostream& os, const char* firstColumn);
+  static void WriteSummaryRow(std::ostream& os, const std::string& name, const ContentStats& stats);
 
   void SetRemote(Address address, uint16_t port);
   void SetInterval(Time t);
@@ -48,24 +62,92 @@ public:
   void SetTotalTime(Time t);
   void SetStreaming(bool s);
 
+  /// Payload bytes of each request, standing in for the HTTP request line and headers
+  void SetRequestHeaderSize(uint32_t bytes);
+
+  /**
+   * \brief Disable the built-in request generator
+   *
+   * A driven client only sends what it is handed through SendRequest(), e.g.
+   * by an HttpTraceReplayer.
+   */
+  void SetExternallyDriven(bool driven);
   /**
-   * \brief Set the size of objects to request
-   * \param size Object size in bytes
+   * \brief Send a single request immediately
+   * \param res Resource path
+   * \param size Requested object size in bytes (0 = server default)
+   * \param rangeStart, rangeLength Byte range wanted (length 0 = the whole object); see HttpHeader::SetRange
    */
-  void SetObjectSize(uint32_t size);
+  uint32_t SendRequest(const std::string& res, uint32_t size = 0, uint32_t rangeStart = 0, uint32_t rangeLength = 0);
+  /**
+   * \brief Observe every delivered response as (latency, hit); e.g. HttpConvergenceMonitor::Attach()
+   *
+   * Observers accumulate; the same events are exposed as the "Response" trace source.
+   */
+  void AddResponseCallback(Callback<void, Time, bool> cb);
+  /// Signature of the "Response" trace source
+  typedef void (*ResponseTracedCallback)(Time latency, bool hit);
+  /**
+   * \brief Route requests sent before \p until through \p direct instead of the socket
+   *
+   * Fast-forward warm-up: the request generator runs unchanged and draws
+   * from the same random streams, but each request is a function call
+   * (resource, size, rangeStart, rangeLength) into the cache, e.g.
+   * HttpCacheApp::ServeDirect, and no response is recorded.
+   */
+  void SetDirectPath(Callback<bool, std::string, uint32_t, uint32_t, uint32_t> direct, Time until);
+  /// Requests that went through the direct path
+  uint64_t GetDirectRequests() const { return m_directRequests; }
+  /// Count a request as lost once it has been unanswered this long (zero = never)
+  void SetLossTimeout(Time t);
+  /// Requests that timed out without a response
+  uint64_t GetLostRequests() const { return m_lost; }
+  /// Responses that arrived after their request had timed out (ignored)
+  uint64_t GetLateResponses() const { return m_late; }
+  size_t GetOutstandingRequests() const { return m_inFlight.GetSize(); }
 
-  // Get statistics for global aggregation
+  /**
+   * \brief Record responses into a collector shared by many clients
+   *
+   * Content ids then come from the collector, and the client keeps no
+   * statistics of its own unless it writes a summary CSV.
+   */
+  void SetStatsCollector(Ptr<HttpStatsCollector> collector);
+  /// This client's own statistics; empty with a collector and no summary CSV
   const std::unordered_map<std::string, ContentStats>& GetContentStats() const;
 
-private:
-
+protected:
   void StartApplication() override;
   void StopApplication() override;
+  /**
+   * \brief Hook invoked after a response has been matched and recorded
+   * \param content Resource that was requested
+   * \param latency Request-to-response time
+   * \param hit Whether the cache served it
+   * \param size Response object size in bytes
+   */
+  virtual void OnResponse(const std::string& /* content */, Time /* latency */, bool /* hit */, uint32_t /* size */) {}
+  /**
+   * \brief Hook invoked after an UNAVAILABLE answer has been matched and recorded
+   * \param content Resource that was requested and shed upstream
+   */
+  virtual void OnUnavailable(const std::string& /* content */) {}
+  /// Draw a 1-based service index (Zipf or uniform, per configuration)
+  uint32_t PickService();
+  uint32_t GetNumSegments() const { return m_numSegments; }
+  Time GetTotalTime() const { return m_totalTime; }
+
+private:
   void ScheduleNext();
   void SendOne();
   void HandleRead(Ptr<Socket> socket);
   void WriteSummary();
   std::string PickResource();
+  uint32_t Intern(const std::string& res);
+  const std::string& GetContentName(uint32_t id) const;
+  /// Whether per-client statistics are kept (no collector, or a summary CSV to write)
+  bool KeepsOwnStats() const { return !m_collector || !m_summaryCsvPath.empty(); }
+  void ExpireRequests();
 
   Ptr<Socket> m_socket;
   Address m_peer;
@@ -73,11 +155,19 @@ private:
   EventId m_event;
   Time m_interval{Seconds(1)};
   std::string m_resource{"/obj"};
-  std::unordered_map<uint32_t, std::pair<Time, std::string>> m_sendTimes;
+  // Outstanding requests by id; the value is the content's interned id
+  HttpInFlightTable<uint32_t> m_inFlight;
+  std::unordered_map<std::string, uint32_t> m_contentIds;
+  std::vector<const std::string*> m_contentNames; ///< interned id -> key in m_contentIds
+  Time m_lossTimeout{Seconds(60)};
+  EventId m_lossEvent;
+  uint64_t m_lost = 0;
+  uint64_t m_late = 0;
   std::ofstream m_csv;
   std::string m_csvPath{""};
   std::string m_summaryCsvPath{""};
   std::unordered_map<std::string, ContentStats> m_contentStats;
+  Ptr<HttpStatsCollector> m_collector;
   uint32_t m_nextId = 1;
   uint32_t m_total = 10;
   uint32_t m_sent = 0;
@@ -98,7 +188,12 @@ private:
   uint32_t m_currentService = 0;
   uint32_t m_nextSegment = 1;
   bool m_inSequence = false;
-  uint32_t m_objectSize = 1024;  ///< Object size in bytes
+  uint32_t m_requestHeaderBytes = 300;
+  bool m_externallyDriven = false;
+  TracedCallback<Time, bool> m_responseTrace;
+  Callback<bool, std::string, uint32_t, uint32_t, uint32_t> m_direct;
+  Time m_directUntil;
+  uint64_t m_directRequests = 0;
 };
 
 } // namespace ns3
@@ -0,0 +1,205 @@
+#include "http-convergence-monitor.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include <iomanip>
+
+namespace ns3 {
+NS_LOG_COMPONENT_DEFINE("HttpConvergenceMonitor");
+NS_OBJECT_ENSURE_REGISTERED(HttpConvergenceMonitor);
+
+TypeId HttpConvergenceMonitor::GetTypeId(){
+  static TypeId tid = TypeId("ns3::HttpConvergenceMonitor")
+    .SetParent<Object>()
+    .AddConstructor<HttpConvergenceMonitor>();
+  return tid;
+}
+
+HttpConvergenceMonitor::HttpConvergenceMonitor() = default;
+
+void HttpConvergenceMonitor::Observation::Merge(const Observation& o){
+  responses += o.responses;
+  hits += o.hits;
+  latencySum += o.latencySum;
+  for (uint32_t b = 0; b < kBins; ++b) histogram[b] += o.histogram[b];
+}
+
+void HttpConvergenceMonitor::Attach(Ptr<HttpClientApp> client){
+  client->AddResponseCallback(MakeCallback(&HttpConvergenceMonitor::RecordResponse, this));
+}
+
+void HttpConvergenceMonitor::RecordResponse(Time latency, bool hit){
+  if (Simulator::Now() < m_start || m_converged) return;
+  double us = std::max(1.0, latency.GetSeconds() * 1e6);
+  uint32_t bin = std::min<uint32_t>(kBins - 1, static_cast<uint32_t>(kBinsPerOctave * std::log2(us)));
+  m_current.responses++;
+  if (hit) m_current.hits++;
+  m_current.latencySum += us / 1000.0;
+  m_current.histogram[bin]++;
+  m_responses++;
+}
+
+void HttpConvergenceMonitor::Start(Time at){
+  m_start = at;
+  Simulator::Schedule(at - Simulator::Now() + m_interval, &HttpConvergenceMonitor::Close, this);
+}
+
+void HttpConvergenceMonitor::Close(){
+  m_obs.push_back(m_current);
+  m_current = Observation();
+  if (m_obs.size() >= kMaxObservations) Coarsen();
+  Evaluate();
+  if (m_converged) {
+    if (m_stop) Simulator::Stop();
+    return;
+  }
+  Simulator::Schedule(m_interval, &HttpConvergenceMonitor::Close, this);
+}
+
+void HttpConvergenceMonitor::Coarsen(){
+  // Merge neighbours pairwise: half the observations, each twice as long
+  size_t n = m_obs.size() / 2;
+  for (size_t i = 0; i < n; ++i) {
+    m_obs[i] = m_obs[2 * i];
+    m_obs[i].Merge(m_obs[2 * i + 1]);
+  }
+  m_obs.resize(n);
+  m_interval = m_interval * 2;
+  NS_LOG_INFO("Observation interval doubled to " << m_interval.GetSeconds() << "s");
+}
+
+int64_t HttpConvergenceMonitor::Mser5(bool latency) const {
+  // Batch the series in groups of 5 observations
+  size_t n = m_obs.size() / 5;
+  if (n < 10) return -1;
+  std::vector<double> y(n);
+  double last = 0.0;
+  for (size_t j = 0; j < n; ++j) {
+    Observation g;
+    for (size_t i = 5 * j; i < 5 * j + 5; ++i) g.Merge(m_obs[i]);
+    if (g.responses > 0) last = latency ? g.latencySum / g.responses : static_cast<double>(g.hits) / g.responses;
+    y[j] = last;
+  }
+  // MSER(d) = sum_{j>=d} (y_j - mean_d)^2 / (n - d)^2, from suffix sums
+  double sum = 0.0, sumSq = 0.0;
+  double best = 1e300;
+  size_t bestD = 0;
+  // Only the first half is searched: the statistic is unreliable on short tails
+  size_t half = n / 2;
+  for (size_t d = n; d-- > 0;) {
+    sum += y[d];
+    sumSq += y[d] * y[d];
+    if (d > half) continue;
+    double k = static_cast<double>(n - d);
+    double mser = (sumSq - sum * sum / k) / (k * k);
+    if (mser <= best) {
+      best = mser;
+      bestD = d;
+    }
+  }
+  // The minimum sitting on the search limit means the transient is not over yet
+  if (bestD == half) return -1;
+  return static_cast<int64_t>(5 * bestD);
+}
+
+double HttpConvergenceMonitor::P99(const std::array<uint32_t, kBins>& h){
+  uint64_t total = 0;
+  for (uint32_t c : h) total += c;
+  if (total == 0) return 0.0;
+  uint64_t rank = static_cast<uint64_t>(std::ceil(0.99 * total));
+  uint64_t seen = 0;
+  for (uint32_t b = 0; b < kBins; ++b) {
+    if (seen + h[b] >= rank) {
+      // Interpolate within the bin on the log scale; result in ms
+      double frac = static_cast<double>(rank - seen) / h[b];
+      return std::exp2((b + frac) / kBinsPerOctave) / 1000.0;
+    }
+    seen += h[b];
+  }
+  return std::exp2(static_cast<double>(kBins) / kBinsPerOctave) / 1000.0;
+}
+
+double HttpConvergenceMonitor::StudentT(double confidence, uint32_t df){
+  // Two-sided normal quantile by Newton's method, then the Cornish-Fisher expansion for t
+  double p = 0.5 + confidence / 2.0;
+  double z = 0.0;
+  for (int i = 0; i < 50; ++i) {
+    double cdf = 0.5 * std::erfc(-z / std::sqrt(2.0));
+    double pdf = std::exp(-0.5 * z * z) / std::sqrt(2.0 * 3.14159265358979323846);
+    double step = (cdf - p) / pdf;
+    z -= step;
+    if (std::abs(step) < 1e-12) break;
+  }
+  double v = df, z2 = z * z;
+  return z + z * (z2 + 1) / (4 * v)
+           + z * (5 * z2 * z2 + 16 * z2 + 3) / (96 * v * v)
+           + z * (3 * z2 * z2 * z2 + 19 * z2 * z2 + 17 * z2 - 15) / (384 * v * v * v);
+}
+
+void HttpConvergenceMonitor::Evaluate(){
+  m_haveEstimates = false;
+  int64_t warmHit = Mser5(false);
+  int64_t warmLat = Mser5(true);
+  if (warmHit < 0 || warmLat < 0) return;
+  m_warmupObs = static_cast<size_t>(std::max(warmHit, warmLat));
+
+  size_t batchSize = (m_obs.size() - m_warmupObs) / m_batches;
+  if (batchSize < m_minBatchSize) return;
+  // Use the most recent batches x batchSize observations
+  size_t first = m_obs.size() - batchSize * m_batches;
+
+  std::vector<double> hit(m_batches), mean(m_batches), p99(m_batches);
+  for (uint32_t b = 0; b < m_batches; ++b) {
+    Observation batch;
+    for (size_t i = first + b * batchSize; i < first + (b + 1) * batchSize; ++i) batch.Merge(m_obs[i]);
+    if (batch.responses == 0) return;
+    hit[b] = static_cast<double>(batch.hits) / batch.responses;
+    mean[b] = batch.latencySum / batch.responses;
+    p99[b] = P99(batch.histogram);
+  }
+
+  double t = StudentT(m_confidence, m_batches - 1);
+  auto estimate = [t](const std::vector<double>& x) {
+    Estimate e;
+    for (double v : x) e.mean += v;
+    e.mean /= x.size();
+    double ss = 0.0;
+    for (double v : x) ss += (v - e.mean) * (v - e.mean);
+    e.halfWidth = t * std::sqrt(ss / (x.size() - 1) / x.size());
+    return e;
+  };
+  m_hitRatio = estimate(hit);
+  m_meanLatency = estimate(mean);
+  m_p99Latency = estimate(p99);
+  m_haveEstimates = true;
+
+  if (m_hitRatio.RelativePrecision() <= m_precision && m_meanLatency.RelativePrecision() <= m_precision
+      && m_p99Latency.RelativePrecision() <= m_precision) {
+    m_converged = true;
+    m_convergenceTime = Simulator::Now();
+    NS_LOG_INFO("Converged at " << m_convergenceTime.GetSeconds() << "s after warm-up "
+                << GetWarmup().GetSeconds() << "s");
+  }
+}
+
+void HttpConvergenceMonitor::PrintSummary(std::ostream& os) const {
+  os << std::fixed << std::setprecision(1);
+  if (m_converged) {
+    os << "Convergence: reached at " << m_convergenceTime.GetSeconds() << "s";
+  } else {
+    os << "Convergence: not reached";
+  }
+  os << " (" << m_responses << " responses, " << std::setprecision(0) << 100 * m_confidence
+     << "% CI, target +/-" << std::setprecision(1) << 100 * m_precision << "%)" << std::endl;
+  if (!m_haveEstimates) {
+    os << "  No steady state detected yet" << std::endl;
+    return;
+  }
+  os << "  Warm-up: " << GetWarmup().GetSeconds() << "s" << std::endl;
+  os << std::setprecision(2) << "  Hit ratio: " << 100 * m_hitRatio.mean << "% +/- " << 100 * m_hitRatio.halfWidth
+     << "%" << std::endl;
+  os << std::setprecision(3) << "  Mean latency: " << m_meanLatency.mean << " +/- " << m_meanLatency.halfWidth
+     << " ms" << std::endl;
+  os << "  p99 latency: " << m_p99Latency.mean << " +/- " << m_p99Latency.halfWidth << " ms" << std::endl;
+}
+
+} // namespace ns3
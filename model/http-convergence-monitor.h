@@ -0,0 +1,116 @@
+#pragma once
+#include "http-client-app.h"
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Steady-state convergence monitor with early termination
+ *
+ * Client responses are binned into fixed observation intervals (hit count,
+ * latency sum and a log-scale latency histogram per interval). After every
+ * interval the monitor:
+ *
+ * 1. detects the warm-up with MSER-5 on the hit-ratio and mean-latency
+ *    series (the truncation point minimizing the marginal standard error,
+ *    accepted only if it lies in the first half of the data);
+ * 2. splits the remaining observations into a fixed number of batches and
+ *    computes Student-t confidence intervals from the batch means of the hit
+ *    ratio, the mean latency and the per-batch p99 latency;
+ * 3. once every half-width is within the requested fraction of its estimate,
+ *    records the result and stops the simulator.
+ *
+ * Past a fixed number of observations, adjacent intervals are merged and the
+ * interval doubles, so memory stays bounded on long runs.
+ */
+class HttpConvergenceMonitor : public Object {
+public:
+  static TypeId GetTypeId();
+  HttpConvergenceMonitor();
+
+  struct Estimate {
+    double mean = 0.0;
+    double halfWidth = 0.0;
+    double RelativePrecision() const { return mean != 0.0 ? halfWidth / std::abs(mean) : 1e9; }
+  };
+
+  /// Length of one observation (the unit MSER and the batches work on)
+  void SetObservationInterval(Time t) { m_interval = t; }
+  /// Target half-width as a fraction of the estimate, e.g. 0.02 for +/-2%
+  void SetRelativePrecision(double p) { m_precision = p; }
+  void SetConfidence(double c) { m_confidence = c; }
+  void SetBatches(uint32_t b) { m_batches = std::max(2u, b); }
+  /// Observations per batch required before intervals are trusted
+  void SetMinBatchSize(uint32_t n) { m_minBatchSize = std::max(1u, n); }
+  /// Only report convergence instead of stopping the simulator
+  void SetStopOnConvergence(bool stop) { m_stop = stop; }
+
+  /// Feed this client's responses to the monitor
+  void Attach(Ptr<HttpClientApp> client);
+  void RecordResponse(Time latency, bool hit);
+  void Start(Time at);
+
+  bool IsConverged() const { return m_converged; }
+  Time GetConvergenceTime() const { return m_convergenceTime; }
+  /// Warm-up cut-off from the last evaluation
+  Time GetWarmup() const { return m_start + m_interval * static_cast<int64_t>(m_warmupObs); }
+  /// Estimates from the last evaluation (latencies in ms)
+  const Estimate& GetHitRatio() const { return m_hitRatio; }
+  const Estimate& GetMeanLatency() const { return m_meanLatency; }
+  const Estimate& GetP99Latency() const { return m_p99Latency; }
+  /// Whether the last evaluation found a warm-up point and enough data for intervals
+  bool HasEstimates() const { return m_haveEstimates; }
+  uint64_t GetResponses() const { return m_responses; }
+  /// Human-readable outcome and confidence intervals
+  void PrintSummary(std::ostream& os) const;
+
+private:
+  static constexpr uint32_t kBinsPerOctave = 8;
+  static constexpr uint32_t kBins = 24 * kBinsPerOctave; ///< log-scale latency bins from 1 us to 2^24 us
+  static constexpr size_t kMaxObservations = 4096;
+
+  struct Observation {
+    uint32_t responses = 0;
+    uint32_t hits = 0;
+    double latencySum = 0.0; ///< ms
+    std::array<uint32_t, kBins> histogram{};
+    void Merge(const Observation& o);
+  };
+
+  void Close();
+  void Coarsen();
+  void Evaluate();
+  /// MSER-5 truncation point in observations, or -1 if the warm-up is not over
+  int64_t Mser5(bool latency) const;
+  static double P99(const std::array<uint32_t, kBins>& h);
+  static double StudentT(double confidence, uint32_t df);
+
+  Time m_interval{Seconds(1)};
+  double m_precision = 0.02;
+  double m_confidence = 0.95;
+  uint32_t m_batches = 20;
+  uint32_t m_minBatchSize = 2;
+  bool m_stop = true;
+
+  Time m_start;
+  Observation m_current;
+  std::vector<Observation> m_obs;
+  uint64_t m_responses = 0;
+
+  bool m_converged = false;
+  bool m_haveEstimates = false;
+  Time m_convergenceTime;
+  size_t m_warmupObs = 0;
+  Estimate m_hitRatio;
+  Estimate m_meanLatency;
+  Estimate m_p99Latency;
+};
+
+} // namespace ns3
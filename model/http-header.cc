@@ -1,2 +1,3 @@
 #include "http-header.h"
-namespace ns3 { NS_OBJECT_ENSURE_REGISTERED(HttpHeader); }
+namespace ns3 { NS_OBJECT_ENSURE_REGISTERED(HttpHeader); NS_OBJECT_ENSURE_REGISTERED(HttpBatchHeader); NS_OBJECT_ENSURE_REGISTERED(HttpDigestHeader);
+                NS_OBJECT_ENSURE_REGISTERED(HttpPurgeHeader); }
@@ -2,13 +2,21 @@
 #include "ns3/header.h"
 #include "ns3/type-id.h"
 #include <string>
+#include <vector>
 
 namespace ns3 {
 
 class HttpHeader : public Header {
 public:
+  enum Status : uint8_t {
+    OK = 0,
+    UNAVAILABLE = 1, ///< the server shed the request instead of serving it
+    NOT_FOUND = 2    ///< a sibling cache does not hold the object (only-if-cached lookup)
+  };
+
   HttpHeader() = default;
-  HttpHeader(uint32_t id, std::string res) : m_requestId(id), m_resource(std::move(res)) {}
+  HttpHeader(uint32_t id, std::string res, uint32_t size = 0)
+    : m_requestId(id), m_resource(std::move(res)), m_objectSize(size) {}
 
   static TypeId GetTypeId() {
     static TypeId tid = TypeId("ns3::HttpHeader")
@@ -21,28 +29,271 @@ public:
   void Set(uint32_t id, const std::string& res) { m_requestId = id; m_resource = res; }
   uint32_t GetRequestId() const { return m_requestId; }
   const std::string& GetResource() const { return m_resource; }
+  /// Object size in bytes; 0 in a request means "server default"
+  void SetObjectSize(uint32_t size) { m_objectSize = size; }
+  uint32_t GetObjectSize() const { return m_objectSize; }
+  void SetStatus(Status s) { m_status = s; }
+  Status GetStatus() const { return static_cast<Status>(m_status); }
+  /**
+   * \brief Byte range [start, start + length) of the object
+   *
+   * In a request, the bytes wanted (length 0 = the whole object); in a
+   * response from the origin, the bytes carried. The object size field
+   * still holds the size of the whole object.
+   */
+  void SetRange(uint32_t start, uint32_t length) { m_rangeStart = start; m_rangeLength = length; }
+  uint32_t GetRangeStart() const { return m_rangeStart; }
+  uint32_t GetRangeLength() const { return m_rangeLength; }
+  bool HasRange() const { return m_rangeLength > 0; }
+  /// Version of the object carried by a response (0 = unversioned)
+  void SetVersion(uint32_t v) { m_version = v; }
+  uint32_t GetVersion() const { return m_version; }
 
   uint32_t GetSerializedSize() const override {
-    return 4 + 2 + m_resource.size(); // id + length + chars
+    return 4 + 4 + 1 + 4 + 4 + 4 + 2 + m_resource.size(); // id + size + status + range + version + length + chars
   }
   void Serialize(Buffer::Iterator it) const override {
     it.WriteHtonU32(m_requestId);
+    it.WriteHtonU32(m_objectSize);
+    it.WriteU8(m_status);
+    it.WriteHtonU32(m_rangeStart);
+    it.WriteHtonU32(m_rangeLength);
+    it.WriteHtonU32(m_version);
     it.WriteHtonU16(static_cast<uint16_t>(m_resource.size()));
     for (char c : m_resource) it.WriteU8(static_cast<uint8_t>(c));
   }
   uint32_t Deserialize(Buffer::Iterator it) override {
     m_requestId = it.ReadNtohU32();
+    m_objectSize = it.ReadNtohU32();
+    m_status = it.ReadU8();
+    m_rangeStart = it.ReadNtohU32();
+    m_rangeLength = it.ReadNtohU32();
+    m_version = it.ReadNtohU32();
     uint16_t len = it.ReadNtohU16();
     m_resource.resize(len);
     for (uint16_t i=0;i<len;++i) m_resource[i] = static_cast<char>(it.ReadU8());
     return GetSerializedSize();
   }
   void Print(std::ostream& os) const override {
-    os << "HttpHeader{ id=" << m_requestId << ", res='" << m_resource << "' }";
+    os << "HttpHeader{ id=" << m_requestId << ", res='" << m_resource << "', size=" << m_objectSize;
+    if (HasRange()) os << ", range=" << m_rangeStart << "+" << m_rangeLength;
+    if (m_version > 0) os << ", version=" << m_version;
+    os << " }";
   }
 private:
   uint32_t m_requestId = 0;
   std::string m_resource;
+  uint32_t m_objectSize = 0;
+  uint8_t m_status = OK;
+  uint32_t m_rangeStart = 0;
+  uint32_t m_rangeLength = 0; ///< 0 = whole object
+  uint32_t m_version = 0;
+};
+
+/**
+ * \brief Multi-key request sent by the cache to the origin's batch port
+ *
+ * Carries the (forward id, resource, size hint) of every miss accumulated in
+ * one batching window. The origin answers each key with its own HttpHeader
+ * response, so the response path is unchanged.
+ */
+class HttpBatchHeader : public Header {
+public:
+  struct Key {
+    uint32_t requestId;
+    std::string resource;
+    uint32_t objectSize; ///< size hint, 0 = server default
+    uint32_t rangeStart;
+    uint32_t rangeLength; ///< 0 = whole object
+  };
+
+  static TypeId GetTypeId() {
+    static TypeId tid = TypeId("ns3::HttpBatchHeader")
+      .SetParent<Header>()
+      .AddConstructor<HttpBatchHeader>();
+    return tid;
+  }
+  TypeId GetInstanceTypeId() const override { return GetTypeId(); }
+
+  void AddKey(uint32_t id, const std::string& res, uint32_t size, uint32_t rangeStart = 0, uint32_t rangeLength = 0) {
+    m_keys.push_back(Key{id, res, size, rangeStart, rangeLength});
+  }
+  const std::vector<Key>& GetKeys() const { return m_keys; }
+  void Clear() { m_keys.clear(); }
+
+  uint32_t GetSerializedSize() const override {
+    uint32_t n = 2; // key count
+    for (const auto& k : m_keys) n += 4 + 4 + 4 + 4 + 2 + k.resource.size(); // id + size + range + length + chars
+    return n;
+  }
+  void Serialize(Buffer::Iterator it) const override {
+    it.WriteHtonU16(static_cast<uint16_t>(m_keys.size()));
+    for (const auto& k : m_keys) {
+      it.WriteHtonU32(k.requestId);
+      it.WriteHtonU32(k.objectSize);
+      it.WriteHtonU32(k.rangeStart);
+      it.WriteHtonU32(k.rangeLength);
+      it.WriteHtonU16(static_cast<uint16_t>(k.resource.size()));
+      for (char c : k.resource) it.WriteU8(static_cast<uint8_t>(c));
+    }
+  }
+  uint32_t Deserialize(Buffer::Iterator it) override {
+    uint16_t count = it.ReadNtohU16();
+    m_keys.resize(count);
+    for (auto& k : m_keys) {
+      k.requestId = it.ReadNtohU32();
+      k.objectSize = it.ReadNtohU32();
+      k.rangeStart = it.ReadNtohU32();
+      k.rangeLength = it.ReadNtohU32();
+      uint16_t len = it.ReadNtohU16();
+      k.resource.resize(len);
+      for (uint16_t i=0;i<len;++i) k.resource[i] = static_cast<char>(it.ReadU8());
+    }
+    return GetSerializedSize();
+  }
+  void Print(std::ostream& os) const override {
+    os << "HttpBatchHeader{ keys=" << m_keys.size() << " }";
+  }
+private:
+  std::vector<Key> m_keys;
+};
+
+/**
+ * \brief One chunk of a cache digest advertised to sibling caches
+ *
+ * A digest is the word array of an HttpBloomFilter over the sender's keys.
+ * Filters larger than kMaxWords words are split into chunks; the receiver
+ * reassembles the chunks of one generation and uses the filter once every
+ * word has arrived.
+ */
+class HttpDigestHeader : public Header {
+public:
+  static constexpr uint32_t kMaxWords = 1024; ///< 8 KiB of filter per packet
+
+  HttpDigestHeader() = default;
+  HttpDigestHeader(uint32_t sender, uint32_t generation, uint8_t hashes, uint32_t totalWords, uint32_t offset)
+    : m_sender(sender), m_generation(generation), m_hashes(hashes), m_totalWords(totalWords), m_offset(offset) {}
+
+  static TypeId GetTypeId() {
+    static TypeId tid = TypeId("ns3::HttpDigestHeader")
+      .SetParent<Header>()
+      .AddConstructor<HttpDigestHeader>();
+    return tid;
+  }
+  TypeId GetInstanceTypeId() const override { return GetTypeId(); }
+
+  /// Node id of the advertising cache
+  uint32_t GetSender() const { return m_sender; }
+  /// Increases with every digest the sender builds
+  uint32_t GetGeneration() const { return m_generation; }
+  /// Bloom probes per key
+  uint8_t GetHashes() const { return m_hashes; }
+  /// Words in the whole filter (a power of two)
+  uint32_t GetTotalWords() const { return m_totalWords; }
+  /// Index of this chunk's first word in the filter
+  uint32_t GetOffset() const { return m_offset; }
+  void SetWords(const uint64_t* words, uint32_t count) { m_words.assign(words, words + count); }
+  const std::vector<uint64_t>& GetWords() const { return m_words; }
+
+  uint32_t GetSerializedSize() const override {
+    return 4 + 4 + 1 + 4 + 4 + 2 + 8 * m_words.size(); // sender + generation + hashes + total + offset + count + words
+  }
+  void Serialize(Buffer::Iterator it) const override {
+    it.WriteHtonU32(m_sender);
+    it.WriteHtonU32(m_generation);
+    it.WriteU8(m_hashes);
+    it.WriteHtonU32(m_totalWords);
+    it.WriteHtonU32(m_offset);
+    it.WriteHtonU16(static_cast<uint16_t>(m_words.size()));
+    for (uint64_t w : m_words) it.WriteHtonU64(w);
+  }
+  uint32_t Deserialize(Buffer::Iterator it) override {
+    m_sender = it.ReadNtohU32();
+    m_generation = it.ReadNtohU32();
+    m_hashes = it.ReadU8();
+    m_totalWords = it.ReadNtohU32();
+    m_offset = it.ReadNtohU32();
+    uint16_t count = it.ReadNtohU16();
+    m_words.resize(count);
+    for (auto& w : m_words) w = it.ReadNtohU64();
+    return GetSerializedSize();
+  }
+  void Print(std::ostream& os) const override {
+    os << "HttpDigestHeader{ sender=" << m_sender << ", gen=" << m_generation << ", words=" << m_offset << "+"
+       << m_words.size() << "/" << m_totalWords << " }";
+  }
+private:
+  uint32_t m_sender = 0;
+  uint32_t m_generation = 0;
+  uint8_t m_hashes = 4;
+  uint32_t m_totalWords = 0;
+  uint32_t m_offset = 0;
+  std::vector<uint64_t> m_words;
+};
+
+/**
+ * \brief Invalidation pushed by the origin to a cache's purge port
+ *
+ * Names an exact key, a key prefix or a service whose cached objects the
+ * cache drops at once. The send time lets the cache measure how long the
+ * purge took to arrive.
+ */
+class HttpPurgeHeader : public Header {
+public:
+  enum Scope : uint8_t {
+    KEY = 0,     ///< one object (and its chunks)
+    PREFIX = 1,  ///< every key starting with the target
+    SERVICE = 2  ///< every key of the service, as HttpCacheEngine::ExtractService() sees it
+  };
+
+  HttpPurgeHeader() = default;
+  HttpPurgeHeader(uint32_t id, Scope scope, std::string target, int64_t sentNs)
+    : m_id(id), m_scope(scope), m_target(std::move(target)), m_sentNs(sentNs) {}
+
+  static TypeId GetTypeId() {
+    static TypeId tid = TypeId("ns3::HttpPurgeHeader")
+      .SetParent<Header>()
+      .AddConstructor<HttpPurgeHeader>();
+    return tid;
+  }
+  TypeId GetInstanceTypeId() const override { return GetTypeId(); }
+
+  /// Sequence number of the purge at the sender
+  uint32_t GetId() const { return m_id; }
+  Scope GetScope() const { return static_cast<Scope>(m_scope); }
+  const std::string& GetTarget() const { return m_target; }
+  /// Simulation time the purge was sent, in nanoseconds
+  int64_t GetSentNs() const { return m_sentNs; }
+
+  uint32_t GetSerializedSize() const override {
+    return 4 + 1 + 8 + 2 + m_target.size(); // id + scope + sent + length + chars
+  }
+  void Serialize(Buffer::Iterator it) const override {
+    it.WriteHtonU32(m_id);
+    it.WriteU8(m_scope);
+    it.WriteHtonU64(static_cast<uint64_t>(m_sentNs));
+    it.WriteHtonU16(static_cast<uint16_t>(m_target.size()));
+    for (char c : m_target) it.WriteU8(static_cast<uint8_t>(c));
+  }
+  uint32_t Deserialize(Buffer::Iterator it) override {
+    m_id = it.ReadNtohU32();
+    m_scope = it.ReadU8();
+    m_sentNs = static_cast<int64_t>(it.ReadNtohU64());
+    uint16_t len = it.ReadNtohU16();
+    m_target.resize(len);
+    for (uint16_t i=0;i<len;++i) m_target[i] = static_cast<char>(it.ReadU8());
+    return GetSerializedSize();
+  }
+  void Print(std::ostream& os) const override {
+    static const char* names[] = {"key", "prefix", "service"};
+    os << "HttpPurgeHeader{ id=" << m_id << ", " << (m_scope <= SERVICE ? names[m_scope] : "?") << "='" << m_target
+       << "' }";
+  }
+private:
+  uint32_t m_id = 0;
+  uint8_t m_scope = KEY;
+  std::string m_target;
+  int64_t m_sentNs = 0;
 };
 
 } // namespace ns3
@@ -0,0 +1,134 @@
+#pragma once
+#include "ns3/nstime.h"
+#include <cstdint>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Slot table for outstanding requests keyed by sequentially issued ids
+ *
+ * A request with id i lives in slot i mod capacity, so insertion, lookup and
+ * removal are a single array access with no hashing or allocation. The full
+ * id stored in the slot works as a generation counter: a stale id (answered,
+ * expired or overwritten) never matches a newer request in the same slot.
+ *
+ * Ids must be inserted in increasing order. The table doubles when the span
+ * between the oldest outstanding id and a new id reaches its capacity, so its
+ * size is bounded by the largest number of requests in flight at once
+ * (roughly request rate x timeout), not by the length of the run.
+ */
+template <typename T>
+class HttpInFlightTable {
+public:
+  explicit HttpInFlightTable(uint32_t capacity = 64) : m_slots(RoundUp(capacity)), m_mask(m_slots.size() - 1) {}
+
+  /// Start tracking request \p id sent at \p sent; returns its value slot
+  T& Insert(uint32_t id, Time sent) {
+    if (m_active == 0) m_oldest = id;
+    else SkipInactive();
+    while (id - m_oldest >= m_slots.size()) Grow();
+    Slot& s = m_slots[id & m_mask];
+    s.id = id;
+    s.active = true;
+    s.sent = sent;
+    s.value = T();
+    m_next = id + 1;
+    m_active++;
+    return s.value;
+  }
+
+  /// Outstanding request \p id, or nullptr if it was answered, expired or never sent
+  T* Find(uint32_t id, Time* sent = nullptr) {
+    Slot& s = m_slots[id & m_mask];
+    if (!s.active || s.id != id) return nullptr;
+    if (sent) *sent = s.sent;
+    return &s.value;
+  }
+
+  void Erase(uint32_t id) {
+    Slot& s = m_slots[id & m_mask];
+    if (!s.active || s.id != id) return;
+    s.active = false;
+    m_active--;
+  }
+
+  /// Remove every request sent at or before \p cutoff, oldest first, calling f(id, value) for each
+  template <typename F>
+  void Expire(Time cutoff, F f) {
+    SkipInactive();
+    while (m_active > 0) {
+      Slot& s = m_slots[m_oldest & m_mask];
+      if (s.sent > cutoff) break;
+      s.active = false;
+      m_active--;
+      f(s.id, s.value);
+      m_oldest++;
+      SkipInactive();
+    }
+  }
+
+  /// Call f(id, value) for every outstanding request, in no particular order
+  template <typename F>
+  void ForEach(F f) {
+    for (Slot& s : m_slots) {
+      if (s.active) f(s.id, s.value);
+    }
+  }
+
+  /// Send time of the oldest outstanding request; false if none is outstanding
+  bool GetOldest(Time* sent) {
+    SkipInactive();
+    if (m_active == 0) return false;
+    *sent = m_slots[m_oldest & m_mask].sent;
+    return true;
+  }
+
+  size_t GetSize() const { return m_active; }
+  size_t GetCapacity() const { return m_slots.size(); }
+
+private:
+  struct Slot {
+    uint32_t id = 0;
+    bool active = false;
+    Time sent;
+    T value;
+  };
+
+  static size_t RoundUp(uint32_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+  }
+
+  /// Move m_oldest forward over answered slots to the oldest outstanding id
+  void SkipInactive() {
+    if (m_active == 0) {
+      m_oldest = m_next;
+      return;
+    }
+    while (true) {
+      const Slot& s = m_slots[m_oldest & m_mask];
+      if (s.active && s.id == m_oldest) return;
+      m_oldest++;
+    }
+  }
+
+  void Grow() {
+    // Outstanding ids span less than the old capacity, so they stay distinct modulo the new one
+    std::vector<Slot> old(m_slots.size() * 2);
+    old.swap(m_slots);
+    m_mask = m_slots.size() - 1;
+    for (Slot& s : old) {
+      if (s.active) m_slots[s.id & m_mask] = std::move(s);
+    }
+  }
+
+  std::vector<Slot> m_slots;
+  size_t m_mask;
+  uint32_t m_oldest = 0; ///< no outstanding id is older than this
+  uint32_t m_next = 0;   ///< one past the newest id
+  size_t m_active = 0;
+};
+
+} // namespace ns3
@@ -0,0 +1,141 @@
+#include "http-link-monitor.h"
+#include "ns3/data-rate.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+#include "ns3/traffic-control-layer.h"
+#include <algorithm>
+#include <iomanip>
+
+namespace ns3 {
+NS_LOG_COMPONENT_DEFINE("HttpLinkMonitor");
+NS_OBJECT_ENSURE_REGISTERED(HttpLinkMonitor);
+
+TypeId HttpLinkMonitor::GetTypeId(){
+  static TypeId tid = TypeId("ns3::HttpLinkMonitor")
+    .SetParent<Object>()
+    .AddConstructor<HttpLinkMonitor>();
+  return tid;
+}
+
+HttpLinkMonitor::HttpLinkMonitor() = default;
+
+HttpLinkMonitor::~HttpLinkMonitor(){
+  if (m_csv.is_open()) m_csv.close();
+}
+
+void HttpLinkMonitor::AddDevice(const std::string& group, Ptr<NetDevice> dev){
+  size_t g = 0;
+  while (g < m_summaries.size() && m_summaries[g].name != group) ++g;
+  if (g == m_summaries.size()) {
+    m_groups.emplace_back();
+    m_summaries.emplace_back();
+    m_summaries[g].name = group;
+  }
+  Device d;
+  d.dev = dev;
+  m_groups[g].devices.push_back(d);
+  m_summaries[g].devices++;
+}
+
+void HttpLinkMonitor::Start(Time interval, Time until){
+  m_interval = interval;
+  m_until = until;
+  if (!interval.IsStrictlyPositive() || m_groups.empty()) return;
+  // Queue discs are attached when addresses are assigned, so resolve queues once the run starts
+  Simulator::ScheduleNow(&HttpLinkMonitor::Begin, this);
+}
+
+void HttpLinkMonitor::Begin(){
+  for (Group& group : m_groups) {
+    for (Device& d : group.devices) {
+      PointerValue queue;
+      if (d.dev->GetAttributeFailSafe("TxQueue", queue)) d.queue = queue.Get<QueueBase>();
+      DataRateValue rate;
+      if (d.dev->GetAttributeFailSafe("DataRate", rate)) d.bitRate = static_cast<double>(rate.Get().GetBitRate());
+      Ptr<TrafficControlLayer> tc = d.dev->GetNode()->GetObject<TrafficControlLayer>();
+      if (tc) d.qdisc = tc->GetRootQueueDiscOnDevice(d.dev);
+      d.lastTxBytes = TxBytes(d);
+      d.lastDrops = Drops(d);
+    }
+  }
+  if (!m_path.empty()) {
+    m_csv.open(m_path, std::ios::out);
+    m_csv << "time_s,group,devices,tx_mbps,mean_util,max_util,queue_pkts,max_queue_pkts,drops\n";
+  }
+  Simulator::Schedule(m_interval, &HttpLinkMonitor::Sample, this);
+}
+
+uint64_t HttpLinkMonitor::TxBytes(const Device& d){
+  // Everything that entered the device queue and neither was dropped nor is still waiting has been sent
+  if (!d.queue) return 0;
+  return d.queue->GetTotalReceivedBytes() - d.queue->GetTotalDroppedBytes() - d.queue->GetNBytes();
+}
+
+uint64_t HttpLinkMonitor::Drops(const Device& d){
+  uint64_t drops = d.queue ? d.queue->GetTotalDroppedPackets() : 0;
+  if (d.qdisc) drops += d.qdisc->GetStats().nTotalDroppedPackets;
+  return drops;
+}
+
+void HttpLinkMonitor::Sample(){
+  double seconds = m_interval.GetSeconds();
+  double now = Simulator::Now().GetSeconds();
+  for (size_t g = 0; g < m_groups.size(); ++g) {
+    Group& group = m_groups[g];
+    GroupSummary& sum = m_summaries[g];
+    uint64_t txBytes = 0, queued = 0, maxQueued = 0, drops = 0;
+    double utilSum = 0.0, maxUtil = 0.0;
+    for (Device& d : group.devices) {
+      uint64_t tx = TxBytes(d);
+      uint64_t dropped = Drops(d);
+      uint64_t waiting = (d.queue ? d.queue->GetNPackets() : 0) + (d.qdisc ? d.qdisc->GetNPackets() : 0);
+      double util = d.bitRate > 0 ? 8.0 * (tx - d.lastTxBytes) / (d.bitRate * seconds) : 0.0;
+      txBytes += tx - d.lastTxBytes;
+      drops += dropped - d.lastDrops;
+      queued += waiting;
+      maxQueued = std::max(maxQueued, waiting);
+      utilSum += util;
+      maxUtil = std::max(maxUtil, util);
+      d.lastTxBytes = tx;
+      d.lastDrops = dropped;
+    }
+    double meanUtil = group.devices.empty() ? 0.0 : utilSum / group.devices.size();
+    group.samples++;
+    group.utilizationSum += meanUtil;
+    sum.txBytes += txBytes;
+    sum.meanUtilization = group.utilizationSum / group.samples;
+    sum.peakUtilization = std::max(sum.peakUtilization, maxUtil);
+    sum.peakQueuePackets = std::max(sum.peakQueuePackets, maxQueued);
+    sum.drops += drops;
+    if (m_csv.is_open()) {
+      m_csv << now << "," << sum.name << "," << group.devices.size() << "," << 8.0 * txBytes / seconds / 1e6 << ","
+            << meanUtil << "," << maxUtil << "," << queued << "," << maxQueued << "," << drops << "\n";
+    }
+  }
+  if (Simulator::Now() + m_interval <= m_until) {
+    Simulator::Schedule(m_interval, &HttpLinkMonitor::Sample, this);
+  } else if (m_csv.is_open()) {
+    m_csv.close();
+  }
+}
+
+void HttpLinkMonitor::PrintSummary(std::ostream& os) const {
+  const GroupSummary* bottleneck = nullptr;
+  for (const GroupSummary& s : m_summaries) {
+    os << "Link " << s.name << " (" << s.devices << " devices): " << std::fixed << std::setprecision(1)
+       << s.txBytes / (1024.0 * 1024.0) << " MB sent, utilization mean " << 100.0 * s.meanUtilization << "% peak "
+       << 100.0 * s.peakUtilization << "%, peak queue " << s.peakQueuePackets << " packets, " << s.drops << " drops"
+       << std::endl;
+    if (!bottleneck || s.drops > bottleneck->drops
+        || (s.drops == bottleneck->drops && s.peakUtilization > bottleneck->peakUtilization)) {
+      bottleneck = &s;
+    }
+  }
+  if (bottleneck && (bottleneck->drops > 0 || bottleneck->peakUtilization >= 0.9)) {
+    os << "Bottleneck: " << bottleneck->name << std::endl;
+  }
+}
+
+} // namespace ns3
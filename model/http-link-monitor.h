@@ -0,0 +1,88 @@
+#pragma once
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/net-device.h"
+#include "ns3/net-device-container.h"
+#include "ns3/queue.h"
+#include "ns3/queue-disc.h"
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Periodic per-link telemetry: throughput, utilization, queue occupancy and drops
+ *
+ * Devices are registered under a group name (e.g. "client-up" for every
+ * client's device towards the cache) and polled every interval: bytes that
+ * left the device queue, packets waiting in the device queue and the root
+ * queue disc above it, and packets dropped by either. No per-packet traces
+ * are connected, so the cost is one counter read per device and interval.
+ *
+ * Each sample appends one CSV row per group:
+ *
+ *     time_s,group,devices,tx_mbps,mean_util,max_util,queue_pkts,max_queue_pkts,drops
+ *
+ * where utilization is transmitted bits over the device's DataRate for the
+ * interval, mean_util averages it over the group's devices and max_util is
+ * its busiest device; queue_pkts and drops are summed over the group.
+ * PrintSummary() reports the peaks per group and names the bottleneck.
+ */
+class HttpLinkMonitor : public Object {
+public:
+  static TypeId GetTypeId();
+  HttpLinkMonitor();
+  ~HttpLinkMonitor() override;
+
+  struct GroupSummary {
+    std::string name;
+    uint32_t devices = 0;
+    uint64_t txBytes = 0;
+    double meanUtilization = 0.0; ///< over all samples and devices
+    double peakUtilization = 0.0; ///< busiest device in any one interval
+    uint64_t peakQueuePackets = 0; ///< fullest device in any one interval
+    uint64_t drops = 0;
+  };
+
+  /// Add \p dev to \p group; groups are reported in the order they were first named
+  void AddDevice(const std::string& group, Ptr<NetDevice> dev);
+  /// Write one row per group and sample to this CSV (optional)
+  void SetOutput(const std::string& path) { m_path = path; }
+  /// Sample every \p interval until \p until
+  void Start(Time interval, Time until);
+
+  const std::vector<GroupSummary>& GetSummaries() const { return m_summaries; }
+  void PrintSummary(std::ostream& os) const;
+
+private:
+  struct Device {
+    Ptr<NetDevice> dev;
+    Ptr<QueueBase> queue;
+    Ptr<QueueDisc> qdisc;
+    double bitRate = 0.0;
+    uint64_t lastTxBytes = 0;
+    uint64_t lastDrops = 0;
+  };
+  struct Group {
+    std::vector<Device> devices;
+    uint64_t samples = 0;
+    double utilizationSum = 0.0;
+  };
+
+  void Begin();
+  void Sample();
+  static uint64_t TxBytes(const Device& d);
+  static uint64_t Drops(const Device& d);
+
+  std::vector<Group> m_groups;
+  std::vector<GroupSummary> m_summaries;
+  std::string m_path;
+  std::ofstream m_csv;
+  Time m_interval;
+  Time m_until;
+};
+
+} // namespace ns3
@@ -0,0 +1,138 @@
+#include "http-mrc-estimator.h"
+#include "http-admission-filter.h"
+#include "ns3/log.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+NS_LOG_COMPONENT_DEFINE("HttpMrcEstimator");
+
+namespace {
+/// Distances beyond this many bins are treated as misses at every capacity
+constexpr size_t kMaxBins = 1u << 20;
+}
+
+void HttpMrcEstimator::Configure(double rate, uint32_t maxKeys, uint32_t binObjects){
+  rate = std::min(std::max(rate, 0.0), 1.0);
+  m_threshold = rate > 0 ? std::max<uint64_t>(1, static_cast<uint64_t>(std::llround(rate * kModulus))) : 0;
+  m_maxKeys = std::max(16u, maxKeys);
+  m_binObjects = std::max(1u, binObjects);
+  m_last.clear();
+  m_byMod = decltype(m_byMod)();
+  m_tree.assign(m_threshold > 0 ? 4 * static_cast<size_t>(m_maxKeys) + 2 : 0, 0);
+  m_clock = 0;
+  m_histogram.clear();
+  m_coldWeight = m_totalWeight = 0.0;
+  m_references = m_sampled = 0;
+}
+
+void HttpMrcEstimator::FenwickAdd(uint32_t pos, int32_t delta){
+  for (; pos < m_tree.size(); pos += pos & (~pos + 1)) m_tree[pos] += delta;
+}
+
+uint32_t HttpMrcEstimator::FenwickPrefix(uint32_t pos) const {
+  int32_t sum = 0;
+  for (; pos > 0; pos -= pos & (~pos + 1)) sum += m_tree[pos];
+  return static_cast<uint32_t>(sum);
+}
+
+void HttpMrcEstimator::Compact(){
+  std::vector<std::pair<uint32_t, uint64_t>> live;
+  live.reserve(m_last.size());
+  for (const auto& kv : m_last) live.emplace_back(kv.second, kv.first);
+  std::sort(live.begin(), live.end());
+  std::fill(m_tree.begin(), m_tree.end(), 0);
+  uint32_t pos = 0;
+  for (const auto& l : live) {
+    m_last[l.second] = ++pos;
+    FenwickAdd(pos, 1);
+  }
+  m_clock = pos;
+}
+
+void HttpMrcEstimator::Shrink(){
+  // Lower the threshold to the largest tracked hash and drop everything at or above it
+  m_threshold = m_byMod.top().first;
+  while (!m_byMod.empty() && m_byMod.top().first >= m_threshold) {
+    auto it = m_last.find(m_byMod.top().second);
+    if (it != m_last.end()) {
+      FenwickAdd(it->second, -1);
+      m_last.erase(it);
+    }
+    m_byMod.pop();
+  }
+  NS_LOG_INFO("MRC sampling rate lowered to " << GetSamplingRate());
+}
+
+void HttpMrcEstimator::AddDistance(uint64_t scaledDistance, double weight){
+  size_t bin = scaledDistance / m_binObjects;
+  if (bin >= kMaxBins) {
+    m_coldWeight += weight;
+    return;
+  }
+  if (bin >= m_histogram.size()) m_histogram.resize(bin + 1, 0.0);
+  m_histogram[bin] += weight;
+}
+
+void HttpMrcEstimator::Record(const std::string& key){
+  m_references++;
+  if (m_threshold == 0) return;
+  uint64_t h = HttpKeyHash(key);
+  uint64_t mod = h & (kModulus - 1);
+  if (mod >= m_threshold) return;
+
+  m_sampled++;
+  double weight = static_cast<double>(kModulus) / m_threshold;
+  m_totalWeight += weight;
+  if (m_clock + 1 >= m_tree.size()) Compact();
+  uint32_t pos = ++m_clock;
+
+  auto it = m_last.find(h);
+  if (it != m_last.end()) {
+    // Distinct sampled keys referenced since this key's previous reference
+    uint32_t prev = it->second;
+    uint32_t distance = FenwickPrefix(pos - 1) - FenwickPrefix(prev);
+    FenwickAdd(prev, -1);
+    FenwickAdd(pos, 1);
+    it->second = pos;
+    AddDistance(static_cast<uint64_t>(distance * weight), weight);
+  } else {
+    m_last.emplace(h, pos);
+    FenwickAdd(pos, 1);
+    m_byMod.emplace(mod, h);
+    m_coldWeight += weight;
+    if (m_last.size() > m_maxKeys) Shrink();
+  }
+}
+
+double HttpMrcEstimator::HitRatio(uint64_t capacity) const {
+  if (m_references == 0 || m_totalWeight <= 0) return 0.0;
+  double hits = 0.0;
+  for (size_t b = 0; b < m_histogram.size() && static_cast<uint64_t>(b) * m_binObjects < capacity; ++b) {
+    hits += m_histogram[b];
+  }
+  // SHARDS-adj: assign the gap between sampled and actual reference counts to the smallest distances
+  if (capacity > 0) hits += static_cast<double>(m_references) - m_totalWeight;
+  return std::min(1.0, std::max(0.0, hits / m_references));
+}
+
+std::vector<std::pair<uint64_t, double>> HttpMrcEstimator::GetCurve(uint64_t maxCapacity, uint32_t points) const {
+  std::vector<std::pair<uint64_t, double>> curve;
+  points = std::max(1u, points);
+  for (uint32_t i = 1; i <= points; ++i) {
+    uint64_t c = maxCapacity * i / points;
+    curve.emplace_back(c, HitRatio(c));
+  }
+  return curve;
+}
+
+size_t HttpMrcEstimator::GetMemoryBytes() const {
+  // Node-based hash map: key, value and next pointer per entry plus the bucket array
+  return m_last.size() * (sizeof(uint64_t) + sizeof(uint32_t) + 2 * sizeof(void*))
+         + m_last.bucket_count() * sizeof(void*)
+         + m_byMod.size() * sizeof(std::pair<uint64_t, uint64_t>)
+         + m_tree.size() * sizeof(int32_t)
+         + m_histogram.size() * sizeof(double);
+}
+
+} // namespace ns3
@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Online LRU miss-ratio-curve estimator (SHARDS)
+ *
+ * Keys are spatially sampled by hash: a key is tracked iff
+ * hash mod 2^24 < threshold, i.e. with rate R = threshold / 2^24. Every
+ * reference to a sampled key yields its LRU stack distance among sampled
+ * keys, computed with a Fenwick tree over last-access positions. That
+ * distance scaled by 1/R estimates the full stack distance. A histogram of
+ * scaled distances gives the hit ratio of an LRU cache of any size in one
+ * pass.
+ *
+ * The number of tracked keys is bounded (fixed-size SHARDS): when it exceeds
+ * the limit, the threshold drops to the largest tracked hash and the keys at
+ * or above it are forgotten, lowering R. References after that are weighted
+ * by the new 1/R, so memory stays O(maxKeys) regardless of catalog size.
+ *
+ * The curve describes a pure LRU with unbounded TTL; expirations only lower
+ * the real hit ratio below it.
+ */
+class HttpMrcEstimator {
+public:
+  /**
+   * \param rate initial sampling rate in (0, 1]; 0 disables the estimator
+   * \param maxKeys upper bound on tracked keys
+   * \param binObjects histogram resolution, in objects of LRU capacity
+   */
+  void Configure(double rate, uint32_t maxKeys = 8192, uint32_t binObjects = 1);
+  bool IsEnabled() const { return m_threshold > 0; }
+
+  /// Account one reference; cheap rejection for unsampled keys
+  void Record(const std::string& key);
+
+  /// Estimated LRU hit ratio for a cache of \p capacity objects
+  double HitRatio(uint64_t capacity) const;
+  /// (capacity, hit ratio) at \p points evenly spaced capacities up to \p maxCapacity
+  std::vector<std::pair<uint64_t, double>> GetCurve(uint64_t maxCapacity, uint32_t points) const;
+
+  double GetSamplingRate() const { return static_cast<double>(m_threshold) / kModulus; }
+  uint64_t GetReferences() const { return m_references; }
+  uint64_t GetSampledReferences() const { return m_sampled; }
+  size_t GetTrackedKeys() const { return m_last.size(); }
+  size_t GetMemoryBytes() const;
+
+private:
+  static constexpr uint64_t kModulus = 1ULL << 24;
+
+  void FenwickAdd(uint32_t pos, int32_t delta);
+  uint32_t FenwickPrefix(uint32_t pos) const;
+  /// Renumber live positions to 1..n once the position space is exhausted
+  void Compact();
+  void Shrink();
+  void AddDistance(uint64_t scaledDistance, double weight);
+
+  uint64_t m_threshold = 0;
+  uint32_t m_maxKeys = 8192;
+  uint32_t m_binObjects = 1;
+
+  // sampled key hash -> position of its last reference
+  std::unordered_map<uint64_t, uint32_t> m_last;
+  // (hash mod 2^24, hash) of tracked keys, largest first, for threshold lowering
+  std::priority_queue<std::pair<uint64_t, uint64_t>> m_byMod;
+  std::vector<int32_t> m_tree; ///< Fenwick tree over positions 1..size-1
+  uint32_t m_clock = 0;        ///< last position handed out
+
+  std::vector<double> m_histogram; ///< weight per distance bin
+  double m_coldWeight = 0.0;       ///< first references (infinite distance)
+  double m_totalWeight = 0.0;
+  uint64_t m_references = 0;
+  uint64_t m_sampled = 0;
+};
+
+} // namespace ns3
@@ -1,10 +1,15 @@
 #include "http-origin-app.h"
 #include "http-header.h"
+#include "http-cache-engine.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/udp-socket-factory.h"
 #include "ns3/ipv4-address.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
 
 namespace ns3 {
 NS_LOG_COMPONENT_DEFINE("HttpOriginApp");
@@ -13,31 +18,191 @@ TypeId HttpOriginApp::GetTypeId(){
   static TypeId tid = TypeId("ns3::HttpOriginApp").SetParent<Application>().AddConstructor<HttpOriginApp>();
   return tid;
 }
-HttpOriginApp::HttpOriginApp() = default;
+HttpOriginApp::HttpOriginApp() : m_updateRng(CreateObject<UniformRandomVariable>()) {}
 void HttpOriginApp::SetListenPort(uint16_t p){ m_port = p; }
-void HttpOriginApp::SetServiceDelay(Time t){ m_delay = t; }
+void HttpOriginApp::SetBatchPort(uint16_t p){ m_batchPort = p; }
+void HttpOriginApp::SetServiceDelay(Time t){ m_queue.SetServiceTime(t); }
 void HttpOriginApp::SetObjectSize(uint32_t size) {
   m_objectSize = size;
 }
 
+void HttpOriginApp::SetResponseHeaderSize(uint32_t bytes){ m_responseHeaderBytes = bytes; }
+
+void HttpOriginApp::SetUpdateRate(double perSecond){
+  m_updateRate = std::max(0.0, perSecond);
+  m_versioned = true;
+}
+
+void HttpOriginApp::SetServiceUpdateRate(const std::string& service, double perSecond){
+  m_serviceUpdateRates[service] = std::max(0.0, perSecond);
+  m_versioned = true;
+}
+
+bool HttpOriginApp::SetServiceUpdateRates(const std::string& list){
+  std::stringstream ss(list);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (item.empty()) continue;
+    size_t colon = item.rfind(':');
+    if (colon == 0 || colon == std::string::npos) return false;
+    char* end = nullptr;
+    double rate = std::strtod(item.c_str() + colon + 1, &end);
+    if (end == item.c_str() + colon + 1 || *end != '\0' || rate < 0) return false;
+    SetServiceUpdateRate(item.substr(0, colon), rate);
+  }
+  return true;
+}
+
+double HttpOriginApp::UpdateRate(const std::string& resource) const {
+  auto it = m_serviceUpdateRates.find(HttpCacheEngine::ExtractService(resource));
+  return it != m_serviceUpdateRates.end() ? it->second : m_updateRate;
+}
+
+Time HttpOriginApp::UpdateGap(uint64_t hash, uint32_t version, double rate) const {
+  // splitmix64 of (seed, object, version): a reproducible uniform draw, whatever the lookup order
+  uint64_t x = m_updateSeed ^ hash;
+  x += 0x9e3779b97f4a7c15ULL * (static_cast<uint64_t>(version) + 1);
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  double u = ((x >> 11) + 0.5) / 9007199254740992.0; // (0, 1)
+  return Seconds(-std::log(u) / rate);
+}
+
+HttpOriginApp::ObjectVersion HttpOriginApp::FirstVersion(const std::string& resource, double rate) const {
+  ObjectVersion v;
+  v.hash = HttpKeyHash(resource);
+  v.nextUpdate = UpdateGap(v.hash, 1, rate);
+  return v;
+}
+
+void HttpOriginApp::Advance(ObjectVersion& v, double rate, Time now) const {
+  while (v.nextUpdate <= now) {
+    v.version++;
+    v.nextUpdate += UpdateGap(v.hash, v.version, rate);
+  }
+}
+
+uint32_t HttpOriginApp::GetVersion(const std::string& resource){
+  if (!m_versioned) return 0;
+  double rate = UpdateRate(resource);
+  if (rate <= 0) return 1;
+  auto it = m_versions.find(resource);
+  if (it == m_versions.end()) it = m_versions.emplace(resource, FirstVersion(resource, rate)).first;
+  ObjectVersion& v = it->second;
+  uint32_t before = v.version;
+  Advance(v, rate, Simulator::Now());
+  m_updates += v.version - before;
+  return v.version;
+}
+
+uint32_t HttpOriginApp::PeekVersion(const std::string& resource) const {
+  if (!m_versioned) return 0;
+  double rate = UpdateRate(resource);
+  if (rate <= 0) return 1;
+  auto it = m_versions.find(resource);
+  ObjectVersion v = it != m_versions.end() ? it->second : FirstVersion(resource, rate);
+  Advance(v, rate, Simulator::Now());
+  return v.version;
+}
+
+void HttpOriginApp::AddPurgeSubscriber(Address cache, uint16_t port){ m_purgeSubscribers.emplace_back(cache, port); }
+
+void HttpOriginApp::SchedulePurge(Time at, HttpPurgeHeader::Scope scope, const std::string& target){
+  m_purgeSchedule.push_back(ScheduledPurge{at, scope, target});
+}
+
+void HttpOriginApp::SendPurge(HttpPurgeHeader::Scope scope, std::string target){
+  HttpPurgeHeader hdr(m_purgesSent++, scope, target, Simulator::Now().GetNanoSeconds());
+  NS_LOG_INFO("PURGE: pushing " << target << " to " << m_purgeSubscribers.size() << " caches");
+  for (const auto& sub : m_purgeSubscribers) {
+    Ptr<Packet> p = Create<Packet>(0);
+    p->AddHeader(hdr);
+    m_sock->SendTo(p, 0, InetSocketAddress(Ipv4Address::ConvertFrom(sub.first), sub.second));
+  }
+}
+
 void HttpOriginApp::StartApplication(){
+  m_updateSeed = (static_cast<uint64_t>(m_updateRng->GetInteger(0, UINT32_MAX)) << 32) | m_updateRng->GetInteger(0, UINT32_MAX);
   m_sock = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
   m_sock->Bind(InetSocketAddress(Ipv4Address::GetAny(), m_port));
   m_sock->SetRecvCallback(MakeCallback(&HttpOriginApp::HandleRead, this));
+  if (m_batchPort != 0) {
+    m_batchSock = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+    m_batchSock->Bind(InetSocketAddress(Ipv4Address::GetAny(), m_batchPort));
+    m_batchSock->SetRecvCallback(MakeCallback(&HttpOriginApp::HandleBatchRead, this));
+  }
+  for (const ScheduledPurge& sp : m_purgeSchedule) {
+    Time delay = std::max(Time(0), sp.at - Simulator::Now());
+    Simulator::Schedule(delay, &HttpOriginApp::SendPurge, this, sp.scope, sp.target);
+  }
 }
-void HttpOriginApp::StopApplication(){ if (m_sock) m_sock->Close(); }
+void HttpOriginApp::StopApplication(){ if (m_sock) m_sock->Close(); if (m_batchSock) m_batchSock->Close(); }
 
 void HttpOriginApp::HandleRead(Ptr<Socket> sock){
   Address from; Ptr<Packet> p;
   while ((p = sock->RecvFrom(from))){
     HttpHeader hdr; p->RemoveHeader(hdr);
-    Simulator::Schedule(m_delay, &HttpOriginApp::Respond, this, hdr.GetRequestId(), from, hdr.GetResource());
+    // A size hint in the request (e.g. from a replayed trace) overrides the default object size
+    uint32_t size = hdr.GetObjectSize() > 0 ? hdr.GetObjectSize() : m_objectSize;
+    uint32_t reqId = hdr.GetRequestId();
+    std::string resource = hdr.GetResource();
+    uint32_t start = hdr.GetRangeStart();
+    uint32_t length = hdr.HasRange() ? RangeBytes(size, start, hdr.GetRangeLength()) : 0;
+    bool admitted = m_queue.Submit(length > 0 ? length : size, [this, reqId, from, resource, size, start, length]() {
+      Respond(reqId, from, resource, size, start, length);
+    });
+    if (!admitted) Reject(reqId, from, resource, start, length);
+  }
+}
+
+void HttpOriginApp::HandleBatchRead(Ptr<Socket> sock){
+  Address from; Ptr<Packet> p;
+  while ((p = sock->RecvFrom(from))){
+    HttpBatchHeader batch; p->RemoveHeader(batch);
+    // One job for the whole batch: the base service time (per-request overhead) is paid
+    // once, the per-KiB part for every key. Each key is still answered separately, from
+    // the main port, which is the peer the cache's connected origin socket accepts.
+    std::vector<HttpBatchHeader::Key> keys = batch.GetKeys();
+    uint32_t total = 0;
+    for (auto& k : keys) {
+      if (k.objectSize == 0) k.objectSize = m_objectSize;
+      if (k.rangeLength > 0) k.rangeLength = RangeBytes(k.objectSize, k.rangeStart, k.rangeLength);
+      total += k.rangeLength > 0 ? k.rangeLength : k.objectSize;
+    }
+    NS_LOG_INFO("BATCH: " << keys.size() << " keys, " << total << " bytes");
+    bool admitted = m_queue.Submit(total, [this, keys, from]() {
+      for (const auto& k : keys) Respond(k.requestId, from, k.resource, k.objectSize, k.rangeStart, k.rangeLength);
+    });
+    if (!admitted) {
+      for (const auto& k : keys) Reject(k.requestId, from, k.resource, k.rangeStart, k.rangeLength);
+    }
   }
 }
 
-void HttpOriginApp::Respond(uint32_t reqId, const Address& to, const std::string& resource){
-  Ptr<Packet> resp = Create<Packet>(m_objectSize);
-  HttpHeader hdr(reqId, resource);
+uint32_t HttpOriginApp::RangeBytes(uint32_t size, uint32_t start, uint32_t length){
+  // A range running past the end is clipped; one starting beyond it is ignored (whole object)
+  if (start >= size) return 0;
+  return std::min(length, size - start);
+}
+
+void HttpOriginApp::Respond(uint32_t reqId, const Address& to, const std::string& resource, uint32_t size,
+                            uint32_t rangeStart, uint32_t rangeLength){
+  Ptr<Packet> resp = Create<Packet>((rangeLength > 0 ? rangeLength : size) + m_responseHeaderBytes);
+  HttpHeader hdr(reqId, resource, size);
+  if (rangeLength > 0) hdr.SetRange(rangeStart, rangeLength);
+  hdr.SetVersion(GetVersion(resource));
+  resp->AddHeader(hdr);
+  m_sock->SendTo(resp, 0, to);
+}
+
+void HttpOriginApp::Reject(uint32_t reqId, const Address& to, const std::string& resource, uint32_t rangeStart,
+                           uint32_t rangeLength){
+  // Shed requests get an immediate empty reply so the cache can release its pending state
+  Ptr<Packet> resp = Create<Packet>(m_responseHeaderBytes);
+  HttpHeader hdr(reqId, resource, 0);
+  hdr.SetStatus(HttpHeader::UNAVAILABLE);
+  hdr.SetRange(rangeStart, rangeLength);
   resp->AddHeader(hdr);
   m_sock->SendTo(resp, 0, to);
 }
@@ -1,8 +1,14 @@
 #pragma once
+#include "http-header.h"
+#include "http-server-queue.h"
 #include "ns3/application.h"
 #include "ns3/socket.h"
 #include "ns3/address.h"
 #include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace ns3 {
 class HttpOriginApp : public Application {
@@ -10,19 +16,102 @@ public:
   static TypeId GetTypeId();
   HttpOriginApp();
   void SetListenPort(uint16_t p);
+  /// Port for HttpBatchHeader multi-key requests; 0 disables it
+  void SetBatchPort(uint16_t p);
   void SetServiceDelay(Time t);
   /**
    * \brief Set the size of objects to serve
    * \param size Object size in bytes
    */
   void SetObjectSize(uint32_t size);
+  /// Bytes added to every response for its status line and headers
+  void SetResponseHeaderSize(uint32_t bytes);
+
+  /**
+   * \brief Origin capacity model; see HttpServerQueue
+   *
+   * The default (zero workers, fixed service time = service delay) serves
+   * every request in parallel after the service delay.
+   */
+  HttpServerQueue& GetServerQueue() { return m_queue; }
+  const HttpServerQueue& GetServerQueue() const { return m_queue; }
+
+  /**
+   * \brief Model content updates as an independent Poisson process per object
+   *
+   * Once any rate is set, every object starts at version 1 and each update
+   * increments its version; responses carry the version current when they
+   * are sent. Each object's update times are a fixed function of its name
+   * and one draw from the origin's random stream at start, so they do not
+   * depend on when or how often versions are looked up. Objects are tracked
+   * from their first request. A rate of 0 keeps objects at version 1.
+   * \param perSecond mean updates per second of each object
+   */
+  void SetUpdateRate(double perSecond);
+  /// Update rate of the objects of one service, overriding SetUpdateRate()
+  void SetServiceUpdateRate(const std::string& service, double perSecond);
+  /// Apply "service:rate,..." with SetServiceUpdateRate(); false if malformed
+  bool SetServiceUpdateRates(const std::string& list);
+  /// Current version of \p resource, 0 when updates are not modelled; starts tracking it
+  uint32_t GetVersion(const std::string& resource);
+  /// GetVersion() without tracking or counting anything, for oracles such as HttpCacheApp::SetVersionOracle
+  uint32_t PeekVersion(const std::string& resource) const;
+  /// Updates applied so far to objects that have been requested
+  uint64_t GetUpdates() const { return m_updates; }
+
+  /// Push purges to this cache's purge port (see HttpCacheApp::SetPurgePort)
+  void AddPurgeSubscriber(Address cache, uint16_t port = 8085);
+  /// Send a purge to every subscriber at simulation time \p at
+  void SchedulePurge(Time at, HttpPurgeHeader::Scope scope, const std::string& target);
+  uint32_t GetPurgesSent() const { return m_purgesSent; }
+
 private:
   void StartApplication() override;
   void StopApplication() override;
   void HandleRead(Ptr<Socket> sock);
-  void Respond(uint32_t reqId, const Address& to, const std::string& resource);
+  void HandleBatchRead(Ptr<Socket> sock);
+  /// Answer with the whole object, or with bytes [rangeStart, rangeStart + rangeLength) of it
+  void Respond(uint32_t reqId, const Address& to, const std::string& resource, uint32_t size,
+               uint32_t rangeStart = 0, uint32_t rangeLength = 0);
+  /// Bytes of a \p length byte range at \p start that an object of \p size holds (0 = unsatisfiable)
+  static uint32_t RangeBytes(uint32_t size, uint32_t start, uint32_t length);
+  void Reject(uint32_t reqId, const Address& to, const std::string& resource, uint32_t rangeStart = 0,
+              uint32_t rangeLength = 0);
 
-  Ptr<Socket> m_sock; uint16_t m_port = 8081; Time m_delay{MilliSeconds(2)};
+  Ptr<Socket> m_sock; uint16_t m_port = 8081;
+  Ptr<Socket> m_batchSock; uint16_t m_batchPort = 8082;
   uint32_t m_objectSize = 1024;  ///< Object size in bytes
+  uint32_t m_responseHeaderBytes = 0;
+  HttpServerQueue m_queue;      ///< service delay and capacity model
+
+  struct ScheduledPurge {
+    Time at;
+    HttpPurgeHeader::Scope scope;
+    std::string target;
+  };
+  void SendPurge(HttpPurgeHeader::Scope scope, std::string target);
+  std::vector<std::pair<Address, uint16_t>> m_purgeSubscribers;
+  std::vector<ScheduledPurge> m_purgeSchedule;
+  uint32_t m_purgesSent = 0;
+
+  struct ObjectVersion {
+    uint32_t version = 1;
+    uint64_t hash = 0;  ///< HttpKeyHash of the resource
+    Time nextUpdate;
+  };
+  double UpdateRate(const std::string& resource) const;
+  /// \p resource at version 1, with its first update time
+  ObjectVersion FirstVersion(const std::string& resource, double rate) const;
+  /// Gap between the update to version \p version and the next one
+  Time UpdateGap(uint64_t hash, uint32_t version, double rate) const;
+  /// Apply the updates of \p v due by \p now
+  void Advance(ObjectVersion& v, double rate, Time now) const;
+  bool m_versioned = false;     ///< an update rate was configured
+  double m_updateRate = 0.0;
+  std::unordered_map<std::string, double> m_serviceUpdateRates;
+  std::unordered_map<std::string, ObjectVersion> m_versions;
+  uint64_t m_updates = 0;
+  uint64_t m_updateSeed = 0;    ///< drawn from m_updateRng at start
+  Ptr<UniformRandomVariable> m_updateRng;
 };
 }
@@ -0,0 +1,114 @@
+#include "http-progress-monitor.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+
+namespace ns3 {
+NS_LOG_COMPONENT_DEFINE("HttpProgressMonitor");
+NS_OBJECT_ENSURE_REGISTERED(HttpProgressMonitor);
+
+TypeId HttpProgressMonitor::GetTypeId(){
+  static TypeId tid = TypeId("ns3::HttpProgressMonitor")
+    .SetParent<Object>()
+    .AddConstructor<HttpProgressMonitor>();
+  return tid;
+}
+
+HttpProgressMonitor::HttpProgressMonitor() = default;
+
+double HttpProgressMonitor::GetPeakRssMb(){
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0.0;
+#ifdef __APPLE__
+  return usage.ru_maxrss / (1024.0 * 1024.0); // bytes
+#else
+  return usage.ru_maxrss / 1024.0; // KiB
+#endif
+}
+
+void HttpProgressMonitor::Start(Time interval, Time until){
+  m_interval = interval;
+  m_until = until;
+  if (!interval.IsStrictlyPositive()) return;
+  // Take the wall-clock baseline once the simulation is actually running
+  Simulator::ScheduleNow(&HttpProgressMonitor::Begin, this);
+}
+
+void HttpProgressMonitor::Begin(){
+  m_wallStart = m_lastWall = std::chrono::steady_clock::now();
+  m_simStart = m_lastSim = Simulator::Now();
+  m_lastEvents = Simulator::GetEventCount();
+  Simulator::Schedule(m_interval, &HttpProgressMonitor::Report, this);
+}
+
+namespace {
+
+std::string FormatDuration(double seconds) {
+  uint64_t s = static_cast<uint64_t>(std::max(0.0, seconds) + 0.5);
+  std::ostringstream os;
+  if (s >= 3600) os << s / 3600 << "h" << std::setw(2) << std::setfill('0') << (s % 3600) / 60 << "m";
+  else if (s >= 60) os << s / 60 << "m" << std::setw(2) << std::setfill('0') << s % 60 << "s";
+  else os << s << "s";
+  return os.str();
+}
+
+} // namespace
+
+void HttpProgressMonitor::Report(){
+  auto wallNow = std::chrono::steady_clock::now();
+  Time now = Simulator::Now();
+  uint64_t events = Simulator::GetEventCount();
+
+  double wallStep = std::chrono::duration<double>(wallNow - m_lastWall).count();
+  double wallTotal = std::chrono::duration<double>(wallNow - m_wallStart).count();
+  double simStep = (now - m_lastSim).GetSeconds();
+  double simTotal = (now - m_simStart).GetSeconds();
+  double eventsPerSec = wallStep > 0 ? (events - m_lastEvents) / wallStep : 0.0;
+  double simPerWall = wallStep > 0 ? simStep / wallStep : 0.0;
+  double avgSimPerWall = wallTotal > 0 ? simTotal / wallTotal : 0.0;
+  double eta = avgSimPerWall > 0 ? (m_until - now).GetSeconds() / avgSimPerWall : 0.0;
+  double pct = m_until.IsStrictlyPositive() ? 100.0 * now.GetSeconds() / m_until.GetSeconds() : 0.0;
+  double rss = GetPeakRssMb();
+  uint64_t queue = m_probe ? m_probe->GetPendingEvents() : 0;
+  uint64_t reqs = m_cache ? m_cache->GetTotalRequests() : 0;
+  uint64_t hits = m_cache ? m_cache->GetTotalHits() : 0;
+  uint64_t inFlight = m_cache ? m_cache->GetOriginFetchesInFlight() : 0;
+  double hitRate = reqs > 0 ? 100.0 * hits / reqs : 0.0;
+
+  std::cout << "[" << std::fixed << std::setprecision(0) << pct << "%] "
+            << std::setprecision(1) << now.GetSeconds() << "s/" << m_until.GetSeconds() << "s | ";
+  if (m_cache) {
+    std::cout << reqs << " requests | " << hitRate << "% hit rate | ";
+  }
+  std::cout << std::setprecision(2) << eventsPerSec / 1e6 << "M events/s | "
+            << simPerWall << " sim-s/s | ETA " << FormatDuration(eta) << " | RSS "
+            << std::setprecision(0) << rss << " MB";
+  if (m_probe) std::cout << " | queue " << queue;
+  if (m_cache) std::cout << " | " << inFlight << " fetches in flight";
+  std::cout << std::endl;
+
+  if (m_machineReadable) {
+    std::cout << std::setprecision(6) << "PROGRESS {\"sim_s\":" << now.GetSeconds()
+              << ",\"wall_s\":" << wallTotal << ",\"pct\":" << pct
+              << ",\"requests\":" << reqs << ",\"hits\":" << hits
+              << ",\"events\":" << events << ",\"events_per_s\":" << eventsPerSec
+              << ",\"sim_per_wall\":" << simPerWall << ",\"eta_s\":" << eta
+              << ",\"peak_rss_mb\":" << rss
+              << ",\"queue\":" << (m_probe ? std::to_string(queue) : std::string("null"))
+              << ",\"origin_in_flight\":" << inFlight << "}" << std::endl;
+  }
+
+  m_lastWall = wallNow;
+  m_lastSim = now;
+  m_lastEvents = events;
+  if (now + m_interval <= m_until) {
+    Simulator::Schedule(m_interval, &HttpProgressMonitor::Report, this);
+  }
+}
+
+} // namespace ns3
@@ -0,0 +1,60 @@
+#pragma once
+#include "http-cache-app.h"
+#include "timing-wheel-scheduler.h"
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include <chrono>
+#include <cstdint>
+
+namespace ns3 {
+
+/**
+ * \brief Periodic progress report with wall-clock performance telemetry
+ *
+ * Every interval of simulated time prints one line with simulated progress,
+ * the cache's request count and hit rate, events executed per wall-clock
+ * second and simulated seconds per wall-clock second (both over the last
+ * interval), an ETA from the average speed so far, peak RSS, the number of
+ * origin fetches in flight and, given the probe of a CountingScheduler, the
+ * event-queue length. Optionally each report is repeated as a
+ * single "PROGRESS {json}" line for scripts.
+ *
+ * One event per interval and a few counter reads, so the overhead is
+ * negligible at any sensible interval.
+ */
+class HttpProgressMonitor : public Object {
+public:
+  static TypeId GetTypeId();
+  HttpProgressMonitor();
+
+  /// Cache whose request, hit and in-flight counters are reported (optional)
+  void SetCache(Ptr<HttpCacheApp> cache) { m_cache = cache; }
+  /// Event-queue length source, as returned by SetCountingScheduler() (optional)
+  void SetQueueProbe(Ptr<EventQueueProbe> probe) { m_probe = probe; }
+  /// Also print each report as a "PROGRESS {json}" line
+  void SetMachineReadable(bool enabled) { m_machineReadable = enabled; }
+
+  /// Report every \p interval until \p until, which is also the 100% mark for progress and ETA
+  void Start(Time interval, Time until);
+
+  /// Peak resident set size of this process in MiB
+  static double GetPeakRssMb();
+
+private:
+  void Begin();
+  void Report();
+
+  Ptr<HttpCacheApp> m_cache;
+  Ptr<EventQueueProbe> m_probe;
+  bool m_machineReadable = false;
+  Time m_interval;
+  Time m_until;
+
+  std::chrono::steady_clock::time_point m_wallStart;
+  std::chrono::steady_clock::time_point m_lastWall;
+  Time m_simStart;
+  Time m_lastSim;
+  uint64_t m_lastEvents = 0;
+};
+
+} // namespace ns3
@@ -0,0 +1,43 @@
+#include "http-rate-limiter.h"
+#include <algorithm>
+
+namespace ns3 {
+
+void HttpRateLimiter::Configure(double rate, double burst) {
+  m_rate = std::max(0.0, rate);
+  m_burst = std::max(1.0, burst > 0 ? burst : m_rate);
+  m_buckets.clear();
+}
+
+bool HttpRateLimiter::Acquire(uint64_t key, Time now, Time maxWait, Time* wait) {
+  *wait = Time(0);
+  if (m_rate <= 0) return true;
+  Bucket& b = m_buckets.emplace(key, Bucket{m_burst, now}).first->second;
+  // Refill; a bucket in debt from deferred requests climbs back from below zero
+  b.tokens = std::min(m_burst, b.tokens + (now - b.last).GetSeconds() * m_rate);
+  b.last = now;
+  if (b.tokens >= 1.0) {
+    b.tokens -= 1.0;
+    m_allowed++;
+    return true;
+  }
+  double seconds = (1.0 - b.tokens) / m_rate;
+  if (seconds > maxWait.GetSeconds()) {
+    m_refused++;
+    return false;
+  }
+  b.tokens -= 1.0;
+  *wait = Seconds(seconds);
+  m_deferred++;
+  return true;
+}
+
+void HttpRateLimiter::Refund(uint64_t key, Time wait) {
+  auto it = m_buckets.find(key);
+  if (m_rate <= 0 || it == m_buckets.end()) return;
+  it->second.tokens += 1.0;
+  if (wait.IsStrictlyPositive()) m_deferred--;
+  else m_allowed--;
+}
+
+} // namespace ns3
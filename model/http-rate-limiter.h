@@ -0,0 +1,61 @@
+#pragma once
+#include "ns3/nstime.h"
+#include <cstdint>
+#include <unordered_map>
+
+namespace ns3 {
+
+/**
+ * \brief Token buckets keyed by a 64-bit id (a service name hash, a client address)
+ *
+ * Every key gets its own bucket, created full on the key's first request and
+ * refilled at the configured rate up to the burst size. A request takes one
+ * token. When the bucket is empty, a request may instead reserve a future
+ * token if the caller can hold it long enough: the bucket goes into debt and
+ * the caller learns how long to wait. Deferred requests therefore leave at
+ * exactly the configured rate.
+ */
+class HttpRateLimiter {
+public:
+  /**
+   * \param rate tokens per second (0 = unlimited)
+   * \param burst bucket depth in tokens (0 = one second's worth, at least 1)
+   */
+  void Configure(double rate, double burst = 0.0);
+  bool IsEnabled() const { return m_rate > 0; }
+
+  /**
+   * \brief Take a token from \p key's bucket
+   * \param maxWait longest the caller is willing to hold the request
+   * \param wait receives how long to hold it (zero if a token was available)
+   * \return false if no token is available within \p maxWait; nothing is taken then
+   */
+  bool Acquire(uint64_t key, Time now, Time maxWait, Time* wait);
+  /**
+   * \brief Give back the token taken by an Acquire() of \p key that reported \p wait
+   *
+   * For a request that another limit refused after this one let it through;
+   * the request is then not counted as allowed or deferred here.
+   */
+  void Refund(uint64_t key, Time wait);
+
+  uint64_t GetAllowed() const { return m_allowed; }
+  uint64_t GetDeferred() const { return m_deferred; }
+  uint64_t GetRefused() const { return m_refused; }
+  size_t GetBuckets() const { return m_buckets.size(); }
+
+private:
+  struct Bucket {
+    double tokens;
+    Time last; ///< time of the last refill
+  };
+
+  double m_rate = 0.0;
+  double m_burst = 1.0;
+  std::unordered_map<uint64_t, Bucket> m_buckets;
+  uint64_t m_allowed = 0;
+  uint64_t m_deferred = 0;
+  uint64_t m_refused = 0;
+};
+
+} // namespace ns3
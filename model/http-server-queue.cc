@@ -0,0 +1,119 @@
+#include "http-server-queue.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+NS_LOG_COMPONENT_DEFINE("HttpServerQueue");
+
+HttpServerQueue::HttpServerQueue()
+  : m_exp(CreateObject<ExponentialRandomVariable>()),
+    m_logNormal(CreateObject<LogNormalRandomVariable>()) {}
+
+void HttpServerQueue::SetServiceModel(ServiceModel m, double cv){
+  m_model = m;
+  m_cv = cv > 0 ? cv : 1.0;
+}
+
+int64_t HttpServerQueue::AssignStreams(int64_t stream){
+  m_exp->SetStream(stream);
+  m_logNormal->SetStream(stream + 1);
+  return 2;
+}
+
+bool HttpServerQueue::ParseDiscipline(const std::string& name, Discipline* d){
+  if (name == "fifo") { *d = FIFO; return true; }
+  if (name == "sjf" || name == "smallest") { *d = SMALLEST_FIRST; return true; }
+  return false;
+}
+
+bool HttpServerQueue::ParseServiceModel(const std::string& name, ServiceModel* m){
+  if (name == "fixed") { *m = FIXED; return true; }
+  if (name == "exp" || name == "exponential") { *m = EXPONENTIAL; return true; }
+  if (name == "lognormal") { *m = LOGNORMAL; return true; }
+  return false;
+}
+
+Time HttpServerQueue::SampleServiceTime(uint32_t size, Time base){
+  double mean = base.GetSeconds() + m_perKiB.GetSeconds() * (size / 1024.0);
+  if (mean <= 0.0) return Time(0);
+  switch (m_model) {
+    case EXPONENTIAL:
+      return Seconds(m_exp->GetValue(mean, 0));
+    case LOGNORMAL: {
+      double sigma2 = std::log(1.0 + m_cv * m_cv);
+      return Seconds(m_logNormal->GetValue(std::log(mean) - 0.5 * sigma2, std::sqrt(sigma2)));
+    }
+    case FIXED:
+    default:
+      return Seconds(mean);
+  }
+}
+
+void HttpServerQueue::Account(){
+  Time now = Simulator::Now();
+  double dt = (now - m_lastChange).GetSeconds();
+  m_queueArea += dt * m_queue.size();
+  m_busyArea += dt * m_busy;
+  m_lastChange = now;
+}
+
+bool HttpServerQueue::Submit(uint32_t size, Job done){
+  return Submit(size, m_base, std::move(done));
+}
+
+bool HttpServerQueue::Submit(uint32_t size, Time base, Job done){
+  Account();
+  m_stats.arrivals++;
+  if (m_workers == 0 || m_busy < m_workers) {
+    StartService(size, base, Simulator::Now(), std::move(done));
+    return true;
+  }
+  if (m_queueLimit > 0 && m_queue.size() >= m_queueLimit) {
+    m_stats.shed++;
+    NS_LOG_INFO("Shedding request (" << m_queue.size() << " queued, " << m_busy << " busy)");
+    return false;
+  }
+  uint64_t priority = m_discipline == SMALLEST_FIRST ? size : 0;
+  m_queue.push_back(Waiting{priority, m_seq++, size, base, Simulator::Now(), std::move(done)});
+  std::push_heap(m_queue.begin(), m_queue.end(), Later());
+  m_stats.maxQueueDepth = std::max(m_stats.maxQueueDepth, GetQueueDepth());
+  return true;
+}
+
+void HttpServerQueue::StartService(uint32_t size, Time base, Time arrival, Job done){
+  Time service = SampleServiceTime(size, base);
+  m_busy++;
+  m_stats.waitSeconds += (Simulator::Now() - arrival).GetSeconds();
+  m_stats.serviceSeconds += service.GetSeconds();
+  Simulator::Schedule(service, &HttpServerQueue::Complete, this, std::move(done));
+}
+
+void HttpServerQueue::Complete(Job done){
+  Account();
+  m_busy--;
+  m_stats.served++;
+  if (!m_queue.empty()) {
+    std::pop_heap(m_queue.begin(), m_queue.end(), Later());
+    Waiting next = std::move(m_queue.back());
+    m_queue.pop_back();
+    StartService(next.size, next.base, next.arrival, std::move(next.done));
+  }
+  done();
+}
+
+double HttpServerQueue::GetMeanQueueDepth() const {
+  double now = Simulator::Now().GetSeconds();
+  if (now <= 0.0) return 0.0;
+  return (m_queueArea + (now - m_lastChange.GetSeconds()) * m_queue.size()) / now;
+}
+
+double HttpServerQueue::GetUtilization() const {
+  double now = Simulator::Now().GetSeconds();
+  if (now <= 0.0) return 0.0;
+  double busy = (m_busyArea + (now - m_lastChange.GetSeconds()) * m_busy) / now;
+  return m_workers > 0 ? busy / m_workers : busy;
+}
+
+} // namespace ns3
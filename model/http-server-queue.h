@@ -0,0 +1,127 @@
+#pragma once
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/random-variable-stream.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Worker-pool service model for a server
+ *
+ * Requests occupy one of N worker slots for a service time of
+ * base + perKiB x size (in KiB), optionally drawn from an exponential or
+ * log-normal distribution with that mean. Requests that find all workers busy
+ * wait in a FIFO or smallest-object-first queue; once the queue holds
+ * queueLimit requests, further arrivals are shed.
+ *
+ * With zero workers (the default) every request is served immediately, i.e.
+ * the server has unlimited parallelism and only the service time applies.
+ *
+ * Queue depth and worker occupancy are integrated over time so the mean queue
+ * depth and utilization can be reported at the end of a run.
+ */
+class HttpServerQueue {
+public:
+  enum Discipline {
+    FIFO,          ///< serve in arrival order
+    SMALLEST_FIRST ///< serve the smallest queued object next (FIFO among equal sizes)
+  };
+  enum ServiceModel {
+    FIXED,       ///< service time is exactly the mean
+    EXPONENTIAL, ///< exponential with the size-dependent mean
+    LOGNORMAL    ///< log-normal with the size-dependent mean and the configured CV
+  };
+  /// Invoked when a request completes service
+  using Job = std::function<void()>;
+
+  struct Stats {
+    uint64_t arrivals = 0;
+    uint64_t served = 0;
+    uint64_t shed = 0;
+    uint32_t maxQueueDepth = 0;
+    double waitSeconds = 0.0;    ///< summed queueing delay of requests that started service
+    double serviceSeconds = 0.0; ///< summed service time of requests that started service
+  };
+
+  HttpServerQueue();
+
+  /// Number of concurrent worker slots (0 = unlimited)
+  void SetWorkers(uint32_t n) { m_workers = n; }
+  /// Maximum number of waiting requests before shedding (0 = unbounded)
+  void SetQueueLimit(uint32_t n) { m_queueLimit = n; }
+  void SetDiscipline(Discipline d) { m_discipline = d; }
+  /// Mean service time = base + perKiB x (size / 1024)
+  void SetServiceTime(Time base) { m_base = base; }
+  void SetServiceTimePerKiB(Time perKiB) { m_perKiB = perKiB; }
+  /// \param cv coefficient of variation, used by LOGNORMAL only
+  void SetServiceModel(ServiceModel m, double cv = 1.0);
+  int64_t AssignStreams(int64_t stream);
+
+  uint32_t GetWorkers() const { return m_workers; }
+
+  /**
+   * \brief Admit a request of \p size bytes
+   * \return false if the request was shed; \p done is then not invoked
+   */
+  bool Submit(uint32_t size, Job done);
+  /// As Submit(size, done), with \p base replacing the configured base service time for this request
+  bool Submit(uint32_t size, Time base, Job done);
+
+  uint32_t GetQueueDepth() const { return static_cast<uint32_t>(m_queue.size()); }
+  uint32_t GetBusyWorkers() const { return m_busy; }
+  const Stats& GetStats() const { return m_stats; }
+  /// Time-averaged number of waiting requests since construction
+  double GetMeanQueueDepth() const;
+  /// Time-averaged busy workers divided by N (mean concurrency when unlimited)
+  double GetUtilization() const;
+
+  static bool ParseDiscipline(const std::string& name, Discipline* d);
+  static bool ParseServiceModel(const std::string& name, ServiceModel* m);
+
+private:
+  struct Waiting {
+    uint64_t priority; ///< 0 for FIFO, object size for SMALLEST_FIRST
+    uint64_t seq;
+    uint32_t size;
+    Time base;
+    Time arrival;
+    Job done;
+  };
+  /// Min-heap order on (priority, seq)
+  struct Later {
+    bool operator()(const Waiting& a, const Waiting& b) const {
+      return a.priority != b.priority ? a.priority > b.priority : a.seq > b.seq;
+    }
+  };
+
+  void StartService(uint32_t size, Time base, Time arrival, Job done);
+  void Complete(Job done);
+  Time SampleServiceTime(uint32_t size, Time base);
+  void Account();
+
+  uint32_t m_workers = 0;
+  uint32_t m_queueLimit = 0;
+  Discipline m_discipline = FIFO;
+  ServiceModel m_model = FIXED;
+  double m_cv = 1.0;
+  Time m_base{MilliSeconds(2)};
+  Time m_perKiB{0};
+
+  uint32_t m_busy = 0;
+  uint64_t m_seq = 0;
+  std::vector<Waiting> m_queue; ///< heap ordered by Later
+
+  Time m_lastChange;
+  double m_queueArea = 0.0; ///< integral of queue depth over time (s)
+  double m_busyArea = 0.0;  ///< integral of busy workers over time (s)
+  Stats m_stats;
+
+  Ptr<ExponentialRandomVariable> m_exp;
+  Ptr<LogNormalRandomVariable> m_logNormal;
+};
+
+} // namespace ns3
@@ -0,0 +1,96 @@
+#include "http-stats-collector.h"
+#include "http-cache-engine.h"
+#include "ns3/log.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace ns3 {
+NS_LOG_COMPONENT_DEFINE("HttpStatsCollector");
+NS_OBJECT_ENSURE_REGISTERED(HttpStatsCollector);
+
+TypeId HttpStatsCollector::GetTypeId(){
+  static TypeId tid = TypeId("ns3::HttpStatsCollector")
+    .SetParent<Object>()
+    .AddConstructor<HttpStatsCollector>();
+  return tid;
+}
+
+HttpStatsCollector::HttpStatsCollector() = default;
+
+uint32_t HttpStatsCollector::Intern(const std::string& content){
+  auto ins = m_ids.emplace(content, static_cast<uint32_t>(m_names.size()));
+  if (!ins.second) return ins.first->second;
+  m_names.push_back(&ins.first->first);
+  auto svc = m_serviceIds.emplace(HttpCacheEngine::ExtractService(content), static_cast<uint32_t>(m_serviceNames.size()));
+  if (svc.second) m_serviceNames.push_back(svc.first->first);
+  m_service.push_back(svc.first->second);
+  m_stats.emplace_back();
+  return ins.first->second;
+}
+
+uint32_t HttpStatsCollector::ThreadsFor(size_t items) const {
+  // Below a few thousand rows per thread, starting the threads costs more than it saves
+  static constexpr size_t kMinItemsPerThread = 4096;
+  uint32_t threads = m_threads > 0 ? m_threads : std::max(1u, std::thread::hardware_concurrency());
+  size_t useful = std::max<size_t>(1, items / kMinItemsPerThread);
+  return static_cast<uint32_t>(std::min<size_t>(threads, useful));
+}
+
+template <typename F>
+void HttpStatsCollector::ParallelFor(size_t items, uint32_t threads, F f){
+  size_t step = (items + threads - 1) / threads;
+  std::vector<std::thread> pool;
+  for (uint32_t t = 1; t < threads; ++t) {
+    size_t begin = std::min(items, t * step);
+    pool.emplace_back(f, t, begin, std::min(items, begin + step));
+  }
+  f(0u, size_t(0), std::min(items, step));
+  for (std::thread& th : pool) th.join();
+}
+
+std::vector<HttpStatsCollector::ContentStats> HttpStatsCollector::RollupServices() const {
+  uint32_t threads = ThreadsFor(m_stats.size());
+  std::vector<std::vector<ContentStats>> partial(threads, std::vector<ContentStats>(m_serviceNames.size()));
+  ParallelFor(m_stats.size(), threads, [this, &partial](uint32_t t, size_t begin, size_t end) {
+    std::vector<ContentStats>& services = partial[t];
+    for (size_t id = begin; id < end; ++id) services[m_service[id]].Merge(m_stats[id]);
+  });
+  for (uint32_t t = 1; t < threads; ++t) {
+    for (size_t s = 0; s < m_serviceNames.size(); ++s) partial[0][s].Merge(partial[t][s]);
+  }
+  return std::move(partial[0]);
+}
+
+void HttpStatsCollector::WriteRows(const std::string& path, const char* firstColumn,
+                                   const std::vector<std::string>& chunks){
+  std::ofstream out(path, std::ios::out);
+  HttpClientApp::WriteSummaryHeader(out, firstColumn);
+  for (const std::string& chunk : chunks) out << chunk;
+}
+
+void HttpStatsCollector::WriteContentCsv(const std::string& path) const {
+  uint32_t threads = ThreadsFor(m_stats.size());
+  std::vector<std::string> chunks(threads);
+  ParallelFor(m_stats.size(), threads, [this, &chunks](uint32_t t, size_t begin, size_t end) {
+    std::ostringstream os;
+    for (size_t id = begin; id < end; ++id) {
+      const ContentStats& s = m_stats[id];
+      // Contents whose only requests were still in flight at the end have nothing to report
+      if (s.totalRequests == 0 && s.unavailable == 0 && s.lost == 0) continue;
+      HttpClientApp::WriteSummaryRow(os, *m_names[id], s);
+    }
+    chunks[t] = os.str();
+  });
+  WriteRows(path, "content", chunks);
+}
+
+void HttpStatsCollector::WriteServiceCsv(const std::string& path) const {
+  std::vector<ContentStats> services = RollupServices();
+  std::ostringstream os;
+  for (size_t s = 0; s < services.size(); ++s) HttpClientApp::WriteSummaryRow(os, m_serviceNames[s], services[s]);
+  WriteRows(path, "service", {os.str()});
+}
+
+} // namespace ns3
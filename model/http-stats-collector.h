@@ -0,0 +1,73 @@
+#pragma once
+#include "http-client-app.h"
+#include "ns3/object.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Run-wide per-content response statistics shared by all clients
+ *
+ * Clients attached with HttpClientApp::SetStatsCollector() intern each
+ * resource here once and record every response, shed request and loss by
+ * its dense content id, so there is one ContentStats row per distinct
+ * content for the whole run instead of one string-keyed map per client.
+ * Each content's service (HttpCacheEngine::ExtractService) is resolved when
+ * the content is first interned, so service rollups are an index walk.
+ *
+ * The post-run work, service rollups and CSV formatting, is split across
+ * threads by content id range; each thread reduces or formats its range
+ * and the partial results are merged in id order, so rows come out in the
+ * same order whatever the thread count.
+ */
+class HttpStatsCollector : public Object {
+public:
+  static TypeId GetTypeId();
+  HttpStatsCollector();
+
+  using ContentStats = HttpClientApp::ContentStats;
+
+  /// Threads used for rollups and CSV output (0 = one per hardware thread)
+  void SetThreads(uint32_t threads) { m_threads = threads; }
+
+  /// Dense id of \p content, assigned on first use
+  uint32_t Intern(const std::string& content);
+  const std::string& GetName(uint32_t id) const { return *m_names[id]; }
+  uint32_t GetService(uint32_t id) const { return m_service[id]; }
+  const std::string& GetServiceName(uint32_t service) const { return m_serviceNames[service]; }
+  size_t GetNumContent() const { return m_stats.size(); }
+  size_t GetNumServices() const { return m_serviceNames.size(); }
+
+  void RecordResponse(uint32_t id, double latencyMs, bool hit) { m_stats[id].AddResponse(latencyMs, hit); }
+  void RecordUnavailable(uint32_t id) { m_stats[id].unavailable++; }
+  void RecordLost(uint32_t id) { m_stats[id].lost++; }
+
+  const ContentStats& GetStats(uint32_t id) const { return m_stats[id]; }
+  /// Totals per service, indexed by service id
+  std::vector<ContentStats> RollupServices() const;
+
+  /// One row per requested content, in the order contents were first requested
+  void WriteContentCsv(const std::string& path) const;
+  /// One row per service, in the order services were first requested
+  void WriteServiceCsv(const std::string& path) const;
+
+private:
+  uint32_t ThreadsFor(size_t items) const;
+  /// Call f(thread, begin, end) for \p threads contiguous slices of [0, items)
+  template <typename F>
+  static void ParallelFor(size_t items, uint32_t threads, F f);
+  static void WriteRows(const std::string& path, const char* firstColumn, const std::vector<std::string>& chunks);
+
+  uint32_t m_threads = 0;
+  std::unordered_map<std::string, uint32_t> m_ids;
+  std::vector<const std::string*> m_names; ///< id -> key in m_ids
+  std::vector<uint32_t> m_service;         ///< id -> service id
+  std::vector<ContentStats> m_stats;       ///< id -> statistics
+  std::unordered_map<std::string, uint32_t> m_serviceIds;
+  std::vector<std::string> m_serviceNames;
+};
+
+} // namespace ns3
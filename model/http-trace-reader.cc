@@ -0,0 +1,88 @@
+#include "http-trace-reader.h"
+#include "ns3/log.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace ns3 {
+NS_LOG_COMPONENT_DEFINE("HttpTraceReader");
+
+HttpTraceReader::HttpTraceReader(size_t chunkBytes) : m_buf(std::max<size_t>(chunkBytes, 4096)) {}
+
+bool HttpTraceReader::Open(const std::string& path){
+  Close();
+  m_lines = m_malformed = 0;
+  m_file.open(path, std::ios::in | std::ios::binary);
+  if (!m_file.is_open()) {
+    NS_LOG_WARN("Cannot open trace " << path);
+    return false;
+  }
+  return true;
+}
+
+void HttpTraceReader::Close(){
+  if (m_file.is_open()) m_file.close();
+  m_pos = m_len = 0;
+}
+
+bool HttpTraceReader::NextLine(std::string& line){
+  line.clear();
+  while (true) {
+    if (m_pos == m_len) {
+      if (!m_file.is_open() || !m_file) return !line.empty();
+      m_file.read(m_buf.data(), m_buf.size());
+      m_len = static_cast<size_t>(m_file.gcount());
+      m_pos = 0;
+      if (m_len == 0) return !line.empty();
+    }
+    // Scan the current chunk for the end of line; a line may straddle chunks
+    const char* start = m_buf.data() + m_pos;
+    const char* nl = static_cast<const char*>(memchr(start, '\n', m_len - m_pos));
+    if (nl) {
+      line.append(start, nl - start);
+      m_pos += (nl - start) + 1;
+      if (!line.empty() && line.back() == '\r') line.pop_back();
+      return true;
+    }
+    line.append(start, m_len - m_pos);
+    m_pos = m_len;
+  }
+}
+
+bool HttpTraceReader::Parse(const std::string& line, HttpTraceRecord& rec){
+  size_t c1 = line.find(',');
+  if (c1 == std::string::npos) return false;
+  size_t c2 = line.find(',', c1 + 1);
+  if (c2 == std::string::npos) return false;
+  size_t c3 = line.find(',', c2 + 1);
+
+  char* end = nullptr;
+  rec.timestamp = std::strtod(line.c_str(), &end);
+  if (end != line.c_str() + c1) return false;
+  rec.clientId.assign(line, c1 + 1, c2 - c1 - 1);
+  if (c3 == std::string::npos) {
+    rec.resource.assign(line, c2 + 1, std::string::npos);
+    rec.size = 0;
+  } else {
+    rec.resource.assign(line, c2 + 1, c3 - c2 - 1);
+    rec.size = static_cast<uint32_t>(std::strtoul(line.c_str() + c3 + 1, nullptr, 10));
+  }
+  return !rec.resource.empty();
+}
+
+bool HttpTraceReader::Next(HttpTraceRecord& rec){
+  std::string line;
+  while (NextLine(line)) {
+    m_lines++;
+    if (line.empty() || line[0] == '#') continue;
+    if (Parse(line, rec)) return true;
+    // Tolerate a CSV header as the first line, count anything else
+    if (m_lines > 1) {
+      m_malformed++;
+      NS_LOG_WARN("Skipping malformed trace line " << m_lines << ": " << line);
+    }
+  }
+  return false;
+}
+
+} // namespace ns3
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/// One line of an access log: "timestamp_s,client_id,resource,size_bytes"
+struct HttpTraceRecord {
+  double timestamp = 0.0;   ///< seconds, as recorded in the log
+  std::string clientId;
+  std::string resource;
+  uint32_t size = 0;        ///< object size in bytes (0 = server default)
+};
+
+/**
+ * \brief Streaming reader for access-log traces
+ *
+ * Reads the file in fixed-size chunks and parses one record at a time, so
+ * memory use is bounded by the chunk size no matter how long the trace is.
+ * Blank lines, lines starting with '#' and a non-numeric header line are
+ * skipped; malformed lines are counted and skipped.
+ */
+class HttpTraceReader {
+public:
+  explicit HttpTraceReader(size_t chunkBytes = 1 << 20);
+
+  /// Open \p path and reset the line counters
+  bool Open(const std::string& path);
+  /// Close the file; the counters keep their values until the next Open()
+  void Close();
+  bool IsOpen() const { return m_file.is_open(); }
+
+  /// Parse the next record; returns false at end of trace
+  bool Next(HttpTraceRecord& rec);
+
+  uint64_t GetLinesRead() const { return m_lines; }
+  uint64_t GetMalformedLines() const { return m_malformed; }
+
+private:
+  bool NextLine(std::string& line);
+  bool Parse(const std::string& line, HttpTraceRecord& rec);
+
+  std::ifstream m_file;
+  std::vector<char> m_buf;
+  size_t m_pos = 0;   ///< next unread byte in m_buf
+  size_t m_len = 0;   ///< valid bytes in m_buf
+  uint64_t m_lines = 0;
+  uint64_t m_malformed = 0;
+};
+
+} // namespace ns3
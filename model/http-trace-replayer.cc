@@ -0,0 +1,85 @@
+#include "http-trace-replayer.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include <cstdlib>
+#include <functional>
+
+namespace ns3 {
+NS_LOG_COMPONENT_DEFINE("HttpTraceReplayer");
+
+TypeId HttpTraceReplayer::GetTypeId(){
+  static TypeId tid = TypeId("ns3::HttpTraceReplayer")
+    .SetParent<Object>()
+    .AddConstructor<HttpTraceReplayer>();
+  return tid;
+}
+
+HttpTraceReplayer::HttpTraceReplayer() = default;
+void HttpTraceReplayer::SetTracePath(const std::string& path){ m_path = path; }
+void HttpTraceReplayer::SetSpeedup(double speedup){ m_speedup = speedup > 0 ? speedup : 1.0; }
+void HttpTraceReplayer::SetMaxDuration(Time d){ m_maxDuration = d; }
+void HttpTraceReplayer::AddClient(Ptr<HttpClientApp> client){ m_clients.push_back(client); }
+
+bool HttpTraceReplayer::Start(Time at){
+  if (m_clients.empty() || !m_reader.Open(m_path)) return false;
+  m_haveNext = m_reader.Next(m_next);
+  if (!m_haveNext) {
+    NS_LOG_WARN("Trace " << m_path << " has no records");
+    return false;
+  }
+  m_traceStart = m_next.timestamp;
+  m_simStart = at;
+  ScheduleNext();
+  return true;
+}
+
+void HttpTraceReplayer::Stop(){
+  m_event.Cancel();
+  m_haveNext = false;
+  m_reader.Close();
+}
+
+uint32_t HttpTraceReplayer::PickClient(const std::string& clientId) const {
+  char* end = nullptr;
+  unsigned long long n = std::strtoull(clientId.c_str(), &end, 10);
+  if (clientId.empty() || *end != '\0') {
+    n = std::hash<std::string>{}(clientId);
+  }
+  return static_cast<uint32_t>(n % m_clients.size());
+}
+
+Time HttpTraceReplayer::TraceOffset(double timestamp) const {
+  return Seconds((timestamp - m_traceStart) / m_speedup);
+}
+
+void HttpTraceReplayer::ScheduleNext(){
+  if (!m_haveNext) return;
+  Time offset = TraceOffset(m_next.timestamp);
+  if (offset > m_maxDuration) {
+    NS_LOG_INFO("Trace replay reached max duration after " << m_dispatched << " requests");
+    Stop();
+    return;
+  }
+  // Out-of-order records are sent immediately rather than in the past
+  Time when = m_simStart + offset;
+  Time now = Simulator::Now();
+  m_event = Simulator::Schedule(when > now ? when - now : Time(0), &HttpTraceReplayer::Dispatch, this);
+}
+
+void HttpTraceReplayer::Dispatch(){
+  // Dispatch every record due now before touching the event queue again
+  Time now = Simulator::Now();
+  do {
+    m_clients[PickClient(m_next.clientId)]->SendRequest(m_next.resource, m_next.size);
+    m_dispatched++;
+    m_haveNext = m_reader.Next(m_next);
+  } while (m_haveNext && m_simStart + TraceOffset(m_next.timestamp) <= now
+           && TraceOffset(m_next.timestamp) <= m_maxDuration);
+  if (!m_haveNext) {
+    NS_LOG_INFO("Trace replay finished: " << m_dispatched << " requests, "
+                << m_reader.GetMalformedLines() << " malformed lines");
+  }
+  ScheduleNext();
+}
+
+} // namespace ns3
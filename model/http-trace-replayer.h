@@ -0,0 +1,62 @@
+#pragma once
+#include "http-client-app.h"
+#include "http-trace-reader.h"
+#include "ns3/object.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Replays an access-log trace through a pool of HttpClientApps
+ *
+ * Records are streamed from disk one at a time and each is dispatched at its
+ * recorded time (relative to the first record) to the client selected by its
+ * client id. Only the next pending record is held in memory, so traces with
+ * hundreds of millions of lines replay in constant space.
+ *
+ * Numeric client ids map to clients by id modulo pool size; other ids are
+ * hashed. Clients should be configured with SetExternallyDriven(true).
+ */
+class HttpTraceReplayer : public Object {
+public:
+  static TypeId GetTypeId();
+  HttpTraceReplayer();
+
+  void SetTracePath(const std::string& path);
+  /// Scale the inter-arrival times of the trace (2.0 = replay twice as fast)
+  void SetSpeedup(double speedup);
+  /// Stop dispatching once this much trace time (after the first record) has been replayed
+  void SetMaxDuration(Time d);
+  void AddClient(Ptr<HttpClientApp> client);
+
+  /// Begin replay; the first record is sent at simulation time \p at
+  bool Start(Time at);
+  void Stop();
+
+  uint64_t GetDispatched() const { return m_dispatched; }
+  uint64_t GetMalformedLines() const { return m_reader.GetMalformedLines(); }
+
+private:
+  void Dispatch();
+  void ScheduleNext();
+  Time TraceOffset(double timestamp) const;
+  uint32_t PickClient(const std::string& clientId) const;
+
+  std::string m_path;
+  double m_speedup = 1.0;
+  Time m_maxDuration{Time::Max()};
+  std::vector<Ptr<HttpClientApp>> m_clients;
+
+  HttpTraceReader m_reader;
+  HttpTraceRecord m_next;
+  bool m_haveNext = false;
+  double m_traceStart = 0.0; ///< timestamp of the first record
+  Time m_simStart;           ///< simulation time mapped to m_traceStart
+  EventId m_event;
+  uint64_t m_dispatched = 0;
+};
+
+} // namespace ns3
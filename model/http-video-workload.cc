@@ -0,0 +1,253 @@
+#include "http-video-workload.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+
+namespace ns3 {
+NS_LOG_COMPONENT_DEFINE("HttpVideoWorkload");
+
+TypeId HttpVideoWorkload::GetTypeId(){
+  static TypeId tid = TypeId("ns3::HttpVideoWorkload")
+    .SetParent<Object>()
+    .AddConstructor<HttpVideoWorkload>();
+  return tid;
+}
+
+HttpVideoWorkload::HttpVideoWorkload()
+  : m_uni(CreateObject<UniformRandomVariable>()),
+    m_exp(CreateObject<ExponentialRandomVariable>()),
+    m_logNormal(CreateObject<LogNormalRandomVariable>()) {}
+
+void HttpVideoWorkload::AddClient(Ptr<HttpClientApp> client){ m_clients.push_back(client); }
+void HttpVideoWorkload::SetNumServices(uint32_t n){ m_numServices = std::max(1u, n); }
+void HttpVideoWorkload::SetNumLiveServices(uint32_t n){ m_numLiveServices = n; }
+void HttpVideoWorkload::SetZipf(bool z, double s){ m_zipf = z; m_zipfS = s > 0 ? s : 1.0; }
+void HttpVideoWorkload::SetSegmentDuration(Time d){ m_segmentDuration = d; }
+void HttpVideoWorkload::SetVodSegments(uint32_t n){ m_vodSegments = std::max(1u, n); }
+void HttpVideoWorkload::SetSessionRate(double perSecond){ m_sessionRate = std::max(0.0, perSecond); }
+void HttpVideoWorkload::SetDiurnal(double amplitude, Time period, Time peak){
+  m_diurnalAmplitude = std::min(std::max(amplitude, 0.0), 0.99);
+  m_diurnalPeriod = period;
+  m_diurnalPeak = peak;
+}
+void HttpVideoWorkload::AddFlashCrowd(Time start, Time duration, double multiplier, uint32_t service){
+  m_flashCrowds.push_back(FlashCrowd{start, duration, std::max(1.0, multiplier), std::max(1u, service)});
+}
+bool HttpVideoWorkload::AddFlashCrowd(const std::string& spec){
+  std::stringstream ss(spec);
+  double start, duration, multiplier; uint32_t service; char c1, c2, c3;
+  if (!(ss >> start >> c1 >> duration >> c2 >> multiplier >> c3 >> service) || c1 != ':' || c2 != ':' || c3 != ':') {
+    return false;
+  }
+  AddFlashCrowd(Seconds(start), Seconds(duration), multiplier, service);
+  return true;
+}
+void HttpVideoWorkload::SetLiveWatchMean(Time t){ m_liveWatchMean = t; }
+void HttpVideoWorkload::SetLiveDelaySegments(uint32_t n){ m_liveDelaySegments = n; }
+void HttpVideoWorkload::SetLiveJitter(Time t){ m_liveJitter = t; }
+void HttpVideoWorkload::SetVodWatchTime(Time mean, double sigma){ m_vodWatchMean = mean; m_vodWatchSigma = std::max(0.0, sigma); }
+void HttpVideoWorkload::SetSeekProbability(double p){ m_seekProbability = p; }
+void HttpVideoWorkload::SetAbandonProbability(double p){ m_abandonProbability = p; }
+bool HttpVideoWorkload::SetVodByteRanges(uint32_t bytesPerSegment){
+  // Object sizes and range offsets are 32-bit on the wire
+  if (static_cast<uint64_t>(m_vodSegments) * bytesPerSegment > UINT32_MAX) {
+    m_vodRangeBytes = 0;
+    return false;
+  }
+  m_vodRangeBytes = bytesPerSegment;
+  return true;
+}
+
+int64_t HttpVideoWorkload::AssignStreams(int64_t stream){
+  m_uni->SetStream(stream);
+  m_exp->SetStream(stream + 1);
+  m_logNormal->SetStream(stream + 2);
+  return 3;
+}
+
+void HttpVideoWorkload::Start(Time at, Time until){
+  if (m_clients.empty()) return;
+  m_start = at;
+  m_until = until;
+  uint32_t n = m_numServices;
+  if (m_zipf && n > 1) {
+    m_zipfCum.resize(n);
+    double sum = 0.0;
+    for (uint32_t k=1; k<=n; ++k) sum += 1.0 / std::pow((double)k, m_zipfS);
+    double run = 0.0;
+    for (uint32_t k=1; k<=n; ++k){
+      run += (1.0 / std::pow((double)k, m_zipfS)) / sum;
+      m_zipfCum[k-1] = run;
+    }
+  }
+  double maxRate = MaxRate();
+  if (maxRate <= 0.0) return;
+  Time delay = at > Simulator::Now() ? at - Simulator::Now() : Time(0);
+  delay += Seconds(m_exp->GetValue(1.0 / maxRate, 0));
+  m_arrivalEvent = Simulator::Schedule(delay, &HttpVideoWorkload::NextArrival, this);
+}
+
+double HttpVideoWorkload::BaseRate(Time t) const {
+  if (m_diurnalAmplitude <= 0.0) return m_sessionRate;
+  double phase = 2.0 * M_PI * (t - m_diurnalPeak).GetSeconds() / m_diurnalPeriod.GetSeconds();
+  return m_sessionRate * (1.0 + m_diurnalAmplitude * std::cos(phase));
+}
+
+double HttpVideoWorkload::FlashRate(Time t) const {
+  double extra = 0.0;
+  for (const auto& f : m_flashCrowds) {
+    if (t >= f.start && t < f.start + f.duration) extra += (f.multiplier - 1.0) * m_sessionRate;
+  }
+  return extra;
+}
+
+uint32_t HttpVideoWorkload::FlashService(Time t, double u) const {
+  // Overlapping crowds split the flash arrivals in proportion to their extra rates
+  uint32_t service = 0;
+  double run = 0.0;
+  for (const auto& f : m_flashCrowds) {
+    if (t < f.start || t >= f.start + f.duration) continue;
+    run += (f.multiplier - 1.0) * m_sessionRate;
+    service = f.service;
+    if (u < run) break;
+  }
+  return service;
+}
+
+double HttpVideoWorkload::MaxRate() const {
+  double max = m_sessionRate * (1.0 + m_diurnalAmplitude);
+  for (const auto& f : m_flashCrowds) max += (f.multiplier - 1.0) * m_sessionRate;
+  return max;
+}
+
+void HttpVideoWorkload::NextArrival(){
+  // Thinning: candidate arrivals at the peak rate, kept with probability rate(t)/peak
+  Time now = Simulator::Now();
+  double maxRate = MaxRate();
+  if (maxRate <= 0.0 || now >= m_until) return;
+
+  double base = BaseRate(now);
+  double flash = FlashRate(now);
+  double u = m_uni->GetValue(0.0, maxRate);
+  if (u < flash) {
+    m_stats.flashSessions++;
+    StartSession(FlashService(now, u), true);
+  } else if (u < flash + base) {
+    StartSession(PickService(), false);
+  }
+  m_arrivalEvent = Simulator::Schedule(Seconds(m_exp->GetValue(1.0 / maxRate, 0)), &HttpVideoWorkload::NextArrival, this);
+}
+
+uint32_t HttpVideoWorkload::PickService(){
+  if (!m_zipfCum.empty()) {
+    double r = m_uni->GetValue(0.0, 1.0);
+    return static_cast<uint32_t>(std::lower_bound(m_zipfCum.begin(), m_zipfCum.end(), r) - m_zipfCum.begin()) + 1;
+  }
+  return m_uni->GetInteger(1, m_numServices);
+}
+
+uint32_t HttpVideoWorkload::LiveEdge(Time t) const {
+  double elapsed = std::max(0.0, (t - m_start).GetSeconds());
+  return m_liveBaseSegment + static_cast<uint32_t>(elapsed / m_segmentDuration.GetSeconds());
+}
+
+Time HttpVideoWorkload::Published(uint32_t segment) const {
+  if (segment <= m_liveBaseSegment) return m_start;
+  return m_start + m_segmentDuration * static_cast<int64_t>(segment - m_liveBaseSegment);
+}
+
+void HttpVideoWorkload::StartSession(uint32_t service, bool flash){
+  Time now = Simulator::Now();
+  uint32_t idx;
+  if (!m_freeSessions.empty()) {
+    idx = m_freeSessions.back();
+    m_freeSessions.pop_back();
+  } else {
+    idx = static_cast<uint32_t>(m_sessions.size());
+    m_sessions.emplace_back();
+  }
+  Session& s = m_sessions[idx];
+  s.service = std::min(service, m_numServices);
+  s.client = m_nextClient++ % m_clients.size();
+  s.live = s.service <= m_numLiveServices;
+  s.active = true;
+  if (s.live) {
+    uint32_t edge = LiveEdge(now);
+    s.nextSegment = edge > m_liveDelaySegments ? edge - m_liveDelaySegments : 1;
+    s.jitter = Seconds(m_uni->GetValue(0.0, m_liveJitter.GetSeconds()));
+    s.end = now + Seconds(m_exp->GetValue(m_liveWatchMean.GetSeconds(), 0));
+    m_stats.liveSessions++;
+  } else {
+    s.nextSegment = 1;
+    s.jitter = Time(0);
+    double watch;
+    if (m_abandonProbability > 0 && m_uni->GetValue(0.0, 1.0) < m_abandonProbability) {
+      watch = m_uni->GetValue(0.0, 30.0);
+      m_stats.abandons++;
+    } else {
+      double mu = std::log(m_vodWatchMean.GetSeconds()) - 0.5 * m_vodWatchSigma * m_vodWatchSigma;
+      watch = m_logNormal->GetValue(mu, m_vodWatchSigma);
+    }
+    s.end = now + Seconds(watch);
+    m_stats.vodSessions++;
+  }
+  m_activeSessions++;
+  m_stats.peakConcurrent = std::max(m_stats.peakConcurrent, m_activeSessions);
+  NS_LOG_INFO("Session " << idx << (s.live ? " live" : " vod") << (flash ? " (flash)" : "")
+              << " service-" << s.service << " from seg-" << s.nextSegment
+              << " until " << s.end.GetSeconds() << "s");
+  Step(idx);
+}
+
+void HttpVideoWorkload::Step(uint32_t idx){
+  Session& s = m_sessions[idx];
+  Time now = Simulator::Now();
+  if (now >= s.end || now >= m_until) {
+    EndSession(idx);
+    return;
+  }
+
+  if (!s.live && m_seekProbability > 0 && s.nextSegment > 1
+      && m_uni->GetValue(0.0, 1.0) < m_seekProbability) {
+    s.nextSegment = m_uni->GetInteger(1, m_vodSegments);
+    m_stats.seeks++;
+  }
+
+  if (!s.live && m_vodRangeBytes > 0) {
+    std::string res = "/service-" + std::to_string(s.service) + "/vod";
+    uint64_t fileBytes = static_cast<uint64_t>(m_vodSegments) * m_vodRangeBytes;
+    uint64_t offset = static_cast<uint64_t>(s.nextSegment - 1) * m_vodRangeBytes;
+    m_clients[s.client]->SendRequest(res, static_cast<uint32_t>(fileBytes), static_cast<uint32_t>(offset),
+                                     m_vodRangeBytes);
+  } else {
+    std::string res = "/service-" + std::to_string(s.service) + "/seg-" + std::to_string(s.nextSegment);
+    m_clients[s.client]->SendRequest(res);
+  }
+  m_stats.requests++;
+  s.nextSegment++;
+
+  Time next;
+  if (s.live) {
+    // Catch up quickly while behind the edge, then follow the publishing cadence
+    Time avail = Published(s.nextSegment) + s.jitter;
+    next = std::max(now + MilliSeconds(100), avail);
+  } else {
+    if (s.nextSegment > m_vodSegments) {
+      EndSession(idx);
+      return;
+    }
+    next = now + m_segmentDuration;
+  }
+  Simulator::Schedule(next - now, &HttpVideoWorkload::Step, this, idx);
+}
+
+void HttpVideoWorkload::EndSession(uint32_t idx){
+  m_sessions[idx].active = false;
+  m_freeSessions.push_back(idx);
+  m_activeSessions--;
+}
+
+} // namespace ns3
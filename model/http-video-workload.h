@@ -0,0 +1,158 @@
+#pragma once
+#include "http-client-app.h"
+#include "ns3/object.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Session-level video workload with live channels and time-shifted VoD
+ *
+ * Viewer sessions arrive as a non-homogeneous Poisson process (generated by
+ * thinning) whose rate follows an optional diurnal sinusoid plus flash crowds
+ * aimed at single services. Each session picks a service (Zipf or uniform).
+ *
+ * - Services 1..numLiveServices are live channels with a moving live edge.
+ *   Viewers join a few segments behind the edge and then request each new
+ *   segment shortly after it is published, so all viewers of a channel hit
+ *   the same key within a small jitter window.
+ * - The remaining services are VoD assets. Viewers start at the beginning,
+ *   watch for a log-normally distributed time, may seek to a random position
+ *   and may abandon early.
+ *
+ * Requests are sent through a pool of HttpClientApps configured with
+ * SetExternallyDriven(true); sessions are spread over the pool round-robin.
+ */
+class HttpVideoWorkload : public Object {
+public:
+  static TypeId GetTypeId();
+  HttpVideoWorkload();
+
+  void AddClient(Ptr<HttpClientApp> client);
+
+  void SetNumServices(uint32_t n);
+  void SetNumLiveServices(uint32_t n);
+  void SetZipf(bool z, double s);
+  void SetSegmentDuration(Time d);
+  /// Length of each VoD asset in segments
+  void SetVodSegments(uint32_t n);
+
+  /// Mean session arrival rate (sessions per second) before modulation
+  void SetSessionRate(double perSecond);
+  /**
+   * \brief Modulate the arrival rate by 1 + amplitude * cos(2*pi*(t - peak)/period)
+   * \param amplitude in [0, 1)
+   */
+  void SetDiurnal(double amplitude, Time period, Time peak);
+  /// Add (multiplier - 1) x base rate of extra sessions for \p service during [start, start+duration)
+  void AddFlashCrowd(Time start, Time duration, double multiplier, uint32_t service);
+  /// Parse "start:duration:multiplier:service" (seconds), as used on the command line
+  bool AddFlashCrowd(const std::string& spec);
+
+  void SetLiveWatchMean(Time t);
+  /// How many segments behind the live edge viewers start
+  void SetLiveDelaySegments(uint32_t n);
+  /// Viewers fetch a new live segment within [0, jitter) after it is published
+  void SetLiveJitter(Time t);
+  /// Log-normal VoD watch time with the given mean and shape sigma
+  void SetVodWatchTime(Time mean, double sigma);
+  /// Per-segment probability of a VoD viewer seeking to a random position
+  void SetSeekProbability(double p);
+  /// Probability that a VoD viewer abandons within the first 30 seconds
+  void SetAbandonProbability(double p);
+  /**
+   * \brief Fetch VoD assets as byte ranges of one file instead of segment objects
+   *
+   * Each VoD asset becomes "/service-N/vod", a file of vodSegments x
+   * \p bytesPerSegment bytes, and segment k is the byte range starting at
+   * (k - 1) x bytesPerSegment (0 = separate segment objects, the default).
+   * Live channels are unchanged. Call after SetVodSegments().
+   * \return false, leaving ranges off, if the file would not fit in 4 GiB
+   */
+  bool SetVodByteRanges(uint32_t bytesPerSegment);
+
+  void Start(Time at, Time until);
+  int64_t AssignStreams(int64_t stream);
+
+  struct Stats {
+    uint64_t liveSessions = 0;
+    uint64_t vodSessions = 0;
+    uint64_t flashSessions = 0;
+    uint64_t requests = 0;
+    uint64_t seeks = 0;
+    uint64_t abandons = 0;
+    uint32_t peakConcurrent = 0;
+  };
+  const Stats& GetStats() const { return m_stats; }
+
+private:
+  struct Session {
+    uint32_t service = 0;
+    uint32_t client = 0;
+    uint32_t nextSegment = 1;
+    bool live = false;
+    bool active = false;
+    Time end;
+    Time jitter;
+  };
+  struct FlashCrowd { Time start; Time duration; double multiplier; uint32_t service; };
+
+  void NextArrival();
+  void StartSession(uint32_t service, bool flash);
+  void Step(uint32_t idx);
+  void EndSession(uint32_t idx);
+  double BaseRate(Time t) const;
+  /// Extra arrival rate of all flash crowds active at \p t
+  double FlashRate(Time t) const;
+  /// Service of the active crowd whose share of FlashRate(t) contains \p u (0 <= u < FlashRate(t))
+  uint32_t FlashService(Time t, double u) const;
+  double MaxRate() const;
+  uint32_t PickService();
+  uint32_t LiveEdge(Time t) const;
+  Time Published(uint32_t segment) const;
+
+  std::vector<Ptr<HttpClientApp>> m_clients;
+  uint32_t m_nextClient = 0;
+
+  uint32_t m_numServices = 1;
+  uint32_t m_numLiveServices = 0;
+  bool m_zipf = false;
+  double m_zipfS = 1.0;
+  std::vector<double> m_zipfCum;
+  Time m_segmentDuration{Seconds(2)};
+  uint32_t m_vodSegments = 1800;
+
+  double m_sessionRate = 1.0;
+  double m_diurnalAmplitude = 0.0;
+  Time m_diurnalPeriod{Seconds(86400)};
+  Time m_diurnalPeak{Seconds(0)};
+  std::vector<FlashCrowd> m_flashCrowds;
+
+  Time m_liveWatchMean{Seconds(600)};
+  uint32_t m_liveDelaySegments = 3;
+  Time m_liveJitter{MilliSeconds(500)};
+  uint32_t m_liveBaseSegment = 1000; ///< edge segment number when the workload starts
+  Time m_vodWatchMean{Seconds(900)};
+  double m_vodWatchSigma = 1.0;
+  double m_seekProbability = 0.0;
+  double m_abandonProbability = 0.0;
+  uint32_t m_vodRangeBytes = 0;
+
+  Time m_start;
+  Time m_until;
+  EventId m_arrivalEvent;
+  std::vector<Session> m_sessions;
+  std::vector<uint32_t> m_freeSessions;
+  uint32_t m_activeSessions = 0;
+
+  Ptr<UniformRandomVariable> m_uni;
+  Ptr<ExponentialRandomVariable> m_exp;
+  Ptr<LogNormalRandomVariable> m_logNormal;
+  Stats m_stats;
+};
+
+} // namespace ns3
@@ -0,0 +1,259 @@
+#include "timing-wheel-scheduler.h"
+#include "ns3/log.h"
+#include "ns3/object-factory.h"
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include <algorithm>
+
+namespace ns3 {
+NS_LOG_COMPONENT_DEFINE("TimingWheelScheduler");
+NS_OBJECT_ENSURE_REGISTERED(TimingWheelScheduler);
+NS_OBJECT_ENSURE_REGISTERED(EventQueueProbe);
+NS_OBJECT_ENSURE_REGISTERED(CountingScheduler);
+
+TypeId TimingWheelScheduler::GetTypeId(){
+  static TypeId tid = TypeId("ns3::TimingWheelScheduler")
+    .SetParent<Scheduler>()
+    .AddConstructor<TimingWheelScheduler>()
+    .AddAttribute("BucketWidth", "Time span covered by one wheel bucket",
+                  TimeValue(MilliSeconds(1)),
+                  MakeTimeAccessor(&TimingWheelScheduler::SetBucketWidth),
+                  MakeTimeChecker())
+    .AddAttribute("Buckets", "Number of buckets in the wheel",
+                  UintegerValue(4096),
+                  MakeUintegerAccessor(&TimingWheelScheduler::SetBuckets),
+                  MakeUintegerChecker<uint32_t>());
+  return tid;
+}
+
+TimingWheelScheduler::TimingWheelScheduler(){
+  SetBucketWidth(MilliSeconds(1));
+}
+
+TimingWheelScheduler::~TimingWheelScheduler() = default;
+
+void TimingWheelScheduler::SetBucketWidth(Time width){
+  m_width = std::max<int64_t>(1, width.GetTimeStep());
+  Resize();
+}
+
+void TimingWheelScheduler::SetBuckets(uint32_t n){
+  m_buckets = std::max(1u, n);
+  Resize();
+}
+
+void TimingWheelScheduler::Resize(){
+  // Reconfiguration (attribute construction) re-files any pending events
+  std::vector<Event> pending;
+  for (auto& b : m_wheel) pending.insert(pending.end(), b.begin(), b.end());
+  pending.insert(pending.end(), m_overflow.begin(), m_overflow.end());
+  m_wheel.assign(m_buckets, {});
+  m_overflow.clear();
+  m_wheelCount = 0;
+  m_cursor = 0;
+  for (const auto& ev : pending) Insert(ev);
+}
+
+void TimingWheelScheduler::InsertWheel(const Event& ev) const {
+  auto& bucket = m_wheel[BucketOf(ev.key.m_ts) % m_buckets];
+  bucket.push_back(ev);
+  std::push_heap(bucket.begin(), bucket.end(), Later());
+  m_wheelCount++;
+}
+
+void TimingWheelScheduler::Insert(const Event& ev){
+  uint64_t b = BucketOf(ev.key.m_ts);
+  if (b < m_cursor) Rewind(b);
+  if (b < m_cursor + m_buckets) {
+    InsertWheel(ev);
+  } else {
+    m_overflow.push_back(ev);
+    std::push_heap(m_overflow.begin(), m_overflow.end(), Later());
+  }
+}
+
+bool TimingWheelScheduler::IsEmpty() const {
+  return m_wheelCount == 0 && m_overflow.empty();
+}
+
+void TimingWheelScheduler::Rewind(uint64_t b){
+  // Events are never scheduled before the last removed one, but PeekNext() may
+  // have jumped the cursor ahead to a far overflow event
+  m_cursor = b;
+  for (auto& bucket : m_wheel) {
+    bool changed = false;
+    for (size_t i = 0; i < bucket.size();) {
+      if (BucketOf(bucket[i].key.m_ts) >= m_cursor + m_buckets) {
+        m_overflow.push_back(bucket[i]);
+        std::push_heap(m_overflow.begin(), m_overflow.end(), Later());
+        bucket[i] = bucket.back();
+        bucket.pop_back();
+        m_wheelCount--;
+        changed = true;
+      } else {
+        ++i;
+      }
+    }
+    if (changed) std::make_heap(bucket.begin(), bucket.end(), Later());
+  }
+}
+
+void TimingWheelScheduler::Migrate() const {
+  while (!m_overflow.empty() && BucketOf(m_overflow.front().key.m_ts) < m_cursor + m_buckets) {
+    std::pop_heap(m_overflow.begin(), m_overflow.end(), Later());
+    Event ev = m_overflow.back();
+    m_overflow.pop_back();
+    InsertWheel(ev);
+  }
+}
+
+void TimingWheelScheduler::Advance() const {
+  if (m_wheelCount == 0) {
+    if (m_overflow.empty()) return;
+    // Nothing within the horizon: jump straight to the next overflow event
+    m_cursor = BucketOf(m_overflow.front().key.m_ts);
+    Migrate();
+  }
+  while (m_wheel[m_cursor % m_buckets].empty()) {
+    m_cursor++;
+    Migrate();
+  }
+}
+
+Scheduler::Event TimingWheelScheduler::PeekNext() const {
+  NS_ASSERT(!IsEmpty());
+  Advance();
+  return m_wheel[m_cursor % m_buckets].front();
+}
+
+Scheduler::Event TimingWheelScheduler::RemoveNext(){
+  NS_ASSERT(!IsEmpty());
+  Advance();
+  auto& bucket = m_wheel[m_cursor % m_buckets];
+  std::pop_heap(bucket.begin(), bucket.end(), Later());
+  Event ev = bucket.back();
+  bucket.pop_back();
+  m_wheelCount--;
+  return ev;
+}
+
+void TimingWheelScheduler::Remove(const Event& ev){
+  auto erase = [&ev](std::vector<Event>& heap) {
+    for (size_t i = 0; i < heap.size(); ++i) {
+      if (heap[i].key.m_uid == ev.key.m_uid) {
+        heap[i] = heap.back();
+        heap.pop_back();
+        std::make_heap(heap.begin(), heap.end(), Later());
+        return true;
+      }
+    }
+    return false;
+  };
+  uint64_t b = BucketOf(ev.key.m_ts);
+  if (b < m_cursor + m_buckets && erase(m_wheel[b % m_buckets])) {
+    m_wheelCount--;
+    return;
+  }
+  erase(m_overflow);
+}
+
+TypeId EventQueueProbe::GetTypeId(){
+  static TypeId tid = TypeId("ns3::EventQueueProbe")
+    .SetParent<Object>()
+    .AddConstructor<EventQueueProbe>();
+  return tid;
+}
+
+TypeId CountingScheduler::GetTypeId(){
+  static TypeId tid = TypeId("ns3::CountingScheduler")
+    .SetParent<Scheduler>()
+    .AddConstructor<CountingScheduler>()
+    .AddAttribute("Scheduler", "TypeId name of the scheduler that holds the events",
+                  StringValue("ns3::MapScheduler"),
+                  MakeStringAccessor(&CountingScheduler::SetScheduler),
+                  MakeStringChecker())
+    .AddAttribute("Probe", "Probe updated with the number of pending events",
+                  PointerValue(),
+                  MakePointerAccessor(&CountingScheduler::m_probe),
+                  MakePointerChecker<EventQueueProbe>());
+  return tid;
+}
+
+CountingScheduler::CountingScheduler(){
+  SetScheduler("ns3::MapScheduler");
+}
+
+void CountingScheduler::SetScheduler(std::string typeName){
+  NS_ASSERT_MSG(!m_inner || m_inner->IsEmpty(), "Inner scheduler replaced while holding events");
+  ObjectFactory factory;
+  factory.SetTypeId(typeName);
+  m_inner = factory.Create<Scheduler>();
+}
+
+void CountingScheduler::Insert(const Event& ev){
+  m_inner->Insert(ev);
+  if (m_probe) m_probe->m_pending++;
+}
+
+bool CountingScheduler::IsEmpty() const {
+  return m_inner->IsEmpty();
+}
+
+Scheduler::Event CountingScheduler::PeekNext() const {
+  return m_inner->PeekNext();
+}
+
+Scheduler::Event CountingScheduler::RemoveNext(){
+  if (m_probe) m_probe->m_pending--;
+  return m_inner->RemoveNext();
+}
+
+void CountingScheduler::Remove(const Event& ev){
+  m_inner->Remove(ev);
+  if (m_probe) m_probe->m_pending--;
+}
+
+namespace {
+
+/// TypeId name for a short scheduler name, or nullptr
+const char* SchedulerTypeName(const std::string& name) {
+  static const std::pair<const char*, const char*> kSchedulers[] = {
+    {"heap", "ns3::HeapScheduler"},
+    {"map", "ns3::MapScheduler"},
+    {"list", "ns3::ListScheduler"},
+    {"calendar", "ns3::CalendarScheduler"},
+    {"wheel", "ns3::TimingWheelScheduler"},
+  };
+  for (const auto& s : kSchedulers) {
+    if (name == s.first) return s.second;
+  }
+  return nullptr;
+}
+
+} // namespace
+
+bool SetSimulatorScheduler(const std::string& name){
+  const char* type = SchedulerTypeName(name);
+  if (!type) return false;
+  ObjectFactory factory;
+  factory.SetTypeId(type);
+  Simulator::SetScheduler(factory);
+  return true;
+}
+
+Ptr<EventQueueProbe> SetCountingScheduler(const std::string& name){
+  const char* type = SchedulerTypeName(name.empty() ? "map" : name);
+  if (!type) return nullptr;
+  // Events already scheduled move into the new scheduler through Insert() and are counted
+  Ptr<EventQueueProbe> probe = CreateObject<EventQueueProbe>();
+  ObjectFactory factory;
+  factory.SetTypeId("ns3::CountingScheduler");
+  factory.Set("Scheduler", StringValue(type));
+  factory.Set("Probe", PointerValue(probe));
+  Simulator::SetScheduler(factory);
+  return probe;
+}
+
+} // namespace ns3
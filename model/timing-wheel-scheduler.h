@@ -0,0 +1,128 @@
+#pragma once
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/scheduler.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Event scheduler based on a single-level timing wheel
+ *
+ * Time is cut into buckets of BucketWidth; a ring of Buckets slots holds
+ * every event due within the wheel's horizon (Buckets x BucketWidth from the
+ * current bucket), and each slot is a small binary heap so that events in a
+ * bucket still leave in (timestamp, uid) order. Events beyond the horizon
+ * wait in an overflow heap and migrate into the wheel as it turns.
+ *
+ * Inserting an event due within the horizon costs O(log k) for k events in
+ * its bucket, independent of the total number of pending events. This suits
+ * the HTTP cache scenarios, where almost every pending event is a client
+ * request timer or reply a few milliseconds to seconds ahead.
+ */
+class TimingWheelScheduler : public Scheduler {
+public:
+  static TypeId GetTypeId();
+  TimingWheelScheduler();
+  ~TimingWheelScheduler() override;
+
+  /// Events held by this scheduler
+  uint64_t GetPendingEvents() const { return m_wheelCount + m_overflow.size(); }
+
+  void SetBucketWidth(Time width);
+  void SetBuckets(uint32_t n);
+
+  void Insert(const Event& ev) override;
+  bool IsEmpty() const override;
+  Event PeekNext() const override;
+  Event RemoveNext() override;
+  void Remove(const Event& ev) override;
+
+private:
+  /// Min-heap order on (timestamp, uid)
+  struct Later {
+    bool operator()(const Event& a, const Event& b) const {
+      return a.key.m_ts != b.key.m_ts ? a.key.m_ts > b.key.m_ts : a.key.m_uid > b.key.m_uid;
+    }
+  };
+
+  uint64_t BucketOf(uint64_t ts) const { return ts / m_width; }
+  void InsertWheel(const Event& ev) const;
+  /// Move the cursor back to bucket \p b, spilling events beyond the new horizon
+  void Rewind(uint64_t b);
+  /// Move the cursor to the earliest non-empty bucket, pulling in overflow events
+  void Advance() const;
+  void Migrate() const;
+  void Resize();
+
+  uint64_t m_width = 1;    ///< bucket width in simulator ticks
+  uint32_t m_buckets = 4096;
+
+  // Advance() only moves events between internal containers, so PeekNext() can stay const
+  mutable std::vector<std::vector<Event>> m_wheel;
+  mutable std::vector<Event> m_overflow; ///< heap of events beyond the horizon
+  mutable uint64_t m_cursor = 0;         ///< absolute index of the current bucket
+  mutable uint64_t m_wheelCount = 0;
+};
+
+/**
+ * \brief Event-queue length of one simulator, shared with its CountingScheduler
+ *
+ * ns-3 offers no way to query the simulator's event-queue length. The
+ * counting wrapper updates a probe on every insert and removal, and whoever
+ * reports the length (e.g. HttpProgressMonitor) holds the same probe.
+ */
+class EventQueueProbe : public Object {
+public:
+  static TypeId GetTypeId();
+  uint64_t GetPendingEvents() const { return m_pending; }
+
+private:
+  friend class CountingScheduler;
+  uint64_t m_pending = 0;
+};
+
+/**
+ * \brief Scheduler wrapper that counts pending events into an EventQueueProbe
+ *
+ * Delegates to the scheduler named by the "Scheduler" attribute, so any ns-3
+ * scheduler can report its queue length. The cost is one extra virtual call
+ * per operation.
+ */
+class CountingScheduler : public Scheduler {
+public:
+  static TypeId GetTypeId();
+  CountingScheduler();
+
+  void Insert(const Event& ev) override;
+  bool IsEmpty() const override;
+  Event PeekNext() const override;
+  Event RemoveNext() override;
+  void Remove(const Event& ev) override;
+
+private:
+  void SetScheduler(std::string typeName);
+
+  Ptr<Scheduler> m_inner;
+  Ptr<EventQueueProbe> m_probe;
+};
+
+/**
+ * \brief Select the simulator's scheduler by short name
+ * \param name heap, map, list, calendar or wheel
+ * \return false for an unknown name
+ *
+ * Must be called before any event is scheduled.
+ */
+bool SetSimulatorScheduler(const std::string& name);
+
+/**
+ * \brief Like SetSimulatorScheduler(), wrapped in a CountingScheduler
+ * \param name as for SetSimulatorScheduler(); empty selects the ns-3 default (map)
+ * \return the probe reporting this simulator's queue length, or null for an unknown name
+ */
+Ptr<EventQueueProbe> SetCountingScheduler(const std::string& name);
+
+} // namespace ns3
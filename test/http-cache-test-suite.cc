@@ -0,0 +1,51 @@
+#include "ns3/http-cache-app.h"
+#include "ns3/http-cache-engine.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * \brief ServeDirect() with chunked storage stores only the chunks a range covers
+ *
+ * A 10000-byte object in 1000-byte chunks: bytes [2500, 4500) lie in chunks
+ * 2 to 4, and a warm-up request for them must leave the other chunks out.
+ */
+class HttpCacheServeDirectRangeTestCase : public TestCase {
+public:
+  HttpCacheServeDirectRangeTestCase() : TestCase("ServeDirect stores only the chunks a byte range covers") {}
+
+private:
+  void DoRun() override {
+    Ptr<HttpCacheApp> cache = CreateObject<HttpCacheApp>();
+    cache->SetCapacity(100);
+    cache->SetChunkSize(1000);
+    const HttpCacheEngine& engine = cache->GetEngine();
+    const std::string key = "/service-1/seg-1";
+    Time now = Simulator::Now();
+
+    NS_TEST_ASSERT_MSG_EQ(cache->ServeDirect(key, 10000, 2500, 2000), false, "first request should miss");
+    NS_TEST_ASSERT_MSG_EQ(engine.GetSize(), 3u, "only chunks 2 to 4 should be stored");
+    for (uint32_t c = 0; c < 10; ++c) {
+      bool covered = c >= 2 && c <= 4;
+      NS_TEST_ASSERT_MSG_EQ(engine.Peek(key + "#" + std::to_string(c), now) == HttpCacheEngine::HIT, covered,
+                            "unexpected cache state for chunk " << c);
+    }
+    NS_TEST_ASSERT_MSG_EQ(cache->ServeDirect(key, 10000, 3000, 1000), true, "a range within stored chunks should hit");
+    NS_TEST_ASSERT_MSG_EQ(engine.GetSize(), 3u, "a hit should store nothing");
+
+    // A range past the end is ignored, so the whole object is requested
+    NS_TEST_ASSERT_MSG_EQ(cache->ServeDirect(key, 10000, 20000, 100), false, "whole object should miss");
+    NS_TEST_ASSERT_MSG_EQ(engine.GetSize(), 10u, "every chunk should be stored");
+    Simulator::Destroy();
+  }
+};
+
+class HttpCacheTestSuite : public TestSuite {
+public:
+  HttpCacheTestSuite() : TestSuite("http-cache", Type::UNIT) {
+    AddTestCase(new HttpCacheServeDirectRangeTestCase, TestCase::Duration::QUICK);
+  }
+};
+
+static HttpCacheTestSuite g_httpCacheTestSuite;